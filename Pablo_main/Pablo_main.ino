@@ -1,5 +1,28 @@
 #include "auto_routines.h"
 #include "line_tracker.h"
+#include "scheduler.h"
+#include "schedule.h"
+#include "estop.h"
+
+#define LINE_HOLD_MS 10000          // Stop at the line this long before taking commands
+#define PROFILE_SCHEDULER false     // Print task stats every SCHED_STATS_PERIOD_US
+#define SCHED_STATS_PERIOD_US 5000000
+
+// ESTOP hooks, run on the ESTOP task (see estop.h)
+bool irRead(uint32_t *code)
+{
+  if (!IrReceiver.decode()) return false;
+  *code = IrReceiver.decodedIRData.decodedRawData;
+  IrReceiver.resume();
+  return true;
+}
+
+void estopDrives()
+{
+  leftDrive.detach();
+  rightDrive.detach();
+  driveHalt();
+}
 
 void setup()
 {
@@ -19,6 +42,7 @@ void setup()
   }
   else{
   delay(2000); // Give camera time to stabilize
+  if (!eyes_start_async()) Serial.println("Vision task failed, using eyes_snap()");
   Serial.println("Camera ready!");
   setRing(0,255,0,0);
   delay(1000);
@@ -28,11 +52,22 @@ void setup()
   rightDrive.attach(5);
   pinMode(lineID,INPUT);
   IrReceiver.begin(IRpin, ENABLE_LED_FEEDBACK);
+  if (estop_begin(ESTOP, irRead, estopDrives)) IrReceiver.registerReceiveCompleteCallback(estop_notify_from_isr);
+  else Serial.println("ESTOP TASK FAILED!");
   driveControl(0,0);
 
    ledIdle();
   delay(1000);
- 
+
+  // Most urgent first: ties go to the earlier task
+  sched_add("ir", irTask, IR_PERIOD_US, IR_BUDGET_US);
+  sched_add("line", lineTask, LINE_PERIOD_US, LINE_BUDGET_US);
+  sched_add("drive", driveUpdate, DRIVE_PERIOD_US, DRIVE_BUDGET_US);
+  sched_add("control", controlTask, CONTROL_PERIOD_US, CONTROL_BUDGET_US);
+  sched_add("vision", visionTask, VISION_PERIOD_US, VISION_BUDGET_US);
+  #if PROFILE_SCHEDULER
+  sched_add("stats", statsTask, SCHED_STATS_PERIOD_US, 50000);
+  #endif
 }
 
 //takes picture every second and changes LED based on detection
@@ -61,28 +96,58 @@ void testDetection()
 
 bool state = 0;
 bool test = 1;
+bool capturing = false;     // Capture Start received: capture mode on the vision and control ticks
+bool estopReported = false;
+uint32_t holdUntil = 0;     // millis() the stop at the line ends (0 = not holding)
 
-void loop()
+void visionTask()
 {
-  //setRing(255,255,255,0);
-  if(test)
-  {
-    captureMode();
-    //captureDebug(); 
+  if (estop_triggered()) return;
+  if (test || capturing) captureVision();
+  //testDetection();
+  //findPillar();
+  //Serial.println(eyes_get_yellow_offset_x());
+}
+
+void controlTask()
+{
+  track_turn(micros(), driveTurnSpeed());
+  if (estop_triggered()) return;
+  if (test || capturing) captureMode();
+}
+
+void lineTask()
+{
+  if (holdUntil != 0 && (int32_t)(millis() - holdUntil) >= 0) holdUntil = 0;
 
-  }
-  
   if(lineVal() == 1 && state == 0 && !test) //TODO: replace with 1
   {
     driveControl(0,0);
-    delay(10000);
+    holdUntil = millis() + LINE_HOLD_MS;
     state = 1;
     //driveControl(15,15);
   }
+  //lineSearch(lineVal());
+}
+
+void irTask()
+{
+  // ESTOP itself is handled on the ESTOP task; the drives are already off
+  if (estop_triggered() && !estopReported)
+  {
+    Serial.printf("ESTOP (%u us, max %u us)\n", (unsigned)estop_get_latency_us(), (unsigned)estop_get_max_latency_us());
+    capturing = false;
+    estopReported = true;
+  }
 
-  if(IrReceiver.decode() && !test)
+  uint32_t code;
+  if(estop_poll_code(&code) && !test)
   {
-    if(IrReceiver.decodedIRData.decodedRawData == delivery)
+    if(holdUntil != 0)
+    {
+      // Still stopped at the line
+    }
+    else if(code == delivery)
     {
       if(state == 0)
       {
@@ -93,22 +158,14 @@ void loop()
       if(state == 1)
       {
         Serial.println("Capture Start");
-        captureMode();
+        capturing = true;
       }
-      IrReceiver.resume();
-    }
-    else if(IrReceiver.decodedIRData.decodedRawData == ESTOP)
-    {
-      Serial.println("ESTOP");
-      leftDrive.detach();
-      rightDrive.detach();
-      IrReceiver.resume();
     }
     else
     {
+      capturing = false;
       driveControl(0,0);
       ledIdle();
-      IrReceiver.resume();
     }
 
     //Serial.println(state);
@@ -135,10 +192,17 @@ void loop()
     }
     */
   }
-  //testDetection();
-  //lineSearch(lineVal());
+}
 
-  //findPillar();
+#if PROFILE_SCHEDULER
+void statsTask()
+{
+  sched_print_stats();
+  sched_reset_stats();
+}
+#endif
 
-  //Serial.println(eyes_get_yellow_offset_x());
+void loop()
+{
+  sched_run();
 }
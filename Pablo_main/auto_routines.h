@@ -3,8 +3,11 @@
 #include "pid.h"
 #include "eyes.h"
 #include "led_ring.h"
+#include "tracker.h"
 
 
+// Runs on the IR task: only sets targets and returns (driveUpdate() ramps
+// the stop), never waits
 void lineSearch(bool sensorIn)
 {
   if(sensorIn == 0)
@@ -15,38 +18,41 @@ void lineSearch(bool sensorIn)
   else if(sensorIn == 1)
   {
     driveControl(0,0);
-    delay(100);
     Serial.println("On line");
-    IrReceiver.resume();
   }
 }
 
+static uint32_t pillarLastFrame = 0; // Frame findPillar() last acted on (0 = none)
+
 void findPillar()
 {
-  eyes_snap(); // Capture frame to check for yellow
+  eyes_snap(); // One frame feeds both the search and the alignment step
   bool found = eyes_get_yellow_found();
-  eyes_release(); // Release immediately; pillarPID will take its own picture if needed
+  int16_t offset = eyes_get_yellow_offset_x();
+  uint32_t frame = eyes_get_frame_number();
+  uint32_t captureUs = eyes_get_frame_timestamp_us();
+  eyes_release();
+
+  // No new frame (async timeout): the PID already has this measurement
+  if(frame == pillarLastFrame) return;
+  pillarLastFrame = frame;
 
   if(found)
   {
     pixels.setPixelColor(1,pixels.Color(255,255,0));
     //setRing(255,255,0,0); // Yellow
-    if(pillarPID(0))
+    if(pillarPID(offset, captureUs)) // dt from the sensor's clock, not when we got here
     {
       Serial.println("Pillar not centered.");
     }
     else
     {
       Serial.println("Pillar centered");
-      driveControl(0,0);
-     // delay(10);
-     // driveControl(20,20); // Drive forward towards it
-     rampUp(0,40,2);
+      driveControl(40,40); // Drive forward towards it (driveUpdate() ramps it)
     }
   }
   else
   {
-    rampUp(0,0,0);
     setRing(255,255,255,0); // White
     driveControl(-20,20); // Spin to find it
   }
@@ -54,8 +60,7 @@ void findPillar()
 
 void captureRoutine()
 {
-  IrReceiver.resume();
-  if(!rampUp(0,50,10)) driveControl(50,50);
+  driveControl(50,50);
 }
 
 // Tuning constants for capture mode
@@ -69,9 +74,14 @@ void captureRoutine()
 // Track previous state for scan-to-yellow transition
 static bool wasScanning = false;
 
+// Pink from the latest frame that could see it, kept until the next one
+static uint8_t seenPinkCount = 0;
+static int16_t seenPinkOffset = 0;
+
 // =============================================
 // PROFILING TOGGLE - set to true to see FPS and timing stats in Serial
-// Prints: FPS | Frame time (total in ms) | Capture time (camera in ms) | Decision time (logicin ms)
+// Prints: FPS (vision frames) | Capture time (result pick-up in ms) | Decision time (control step in ms)
+// followed by eyes_profile_dump(): per-stage vision timings in us
 // =============================================
 #define PROFILE_CAPTURE_MODE false
 
@@ -80,6 +90,7 @@ static float avgFrameTime = 0;
 static float avgCaptureTime = 0;
 static float avgDecisionTime = 0;
 static float avgFps = 0;
+static uint32_t lastFrameTime = 0;
 static uint32_t lastPrintTime = 0;
 
 void printProfileStats()
@@ -87,50 +98,73 @@ void printProfileStats()
   if (millis() - lastPrintTime >= 1000)
   {
     Serial.print("FPS: "); Serial.print(avgFps, 1);
-    Serial.print(" | Frame: "); Serial.print(avgFrameTime, 1); Serial.print("ms");
     Serial.print(" | Capture: "); Serial.print(avgCaptureTime, 1); Serial.print("ms");
     Serial.print(" | Decision: "); Serial.print(avgDecisionTime, 1); Serial.println("ms");
+    eyes_profile_dump();
     lastPrintTime = millis();
   }
 }
 #endif
 
-void captureMode()
+// Vision tick: fold a finished frame into the tracker. Steering happens in
+// captureMode() on the control tick, so it keeps going between frames.
+void captureVision()
 {
   #if PROFILE_CAPTURE_MODE
-  uint32_t frameStart = millis();
   uint32_t captureStart = millis();
   #endif
 
-  eyes_snap();
+  if (!eyes_latest()) return;
   bool yellowFound = eyes_get_yellow_found();
   int16_t yellowOffset = eyes_get_yellow_offset_x();
+  uint32_t captureUs = eyes_get_frame_timestamp_us();
+  // A tracking window only covers the columns around yellow: pink it finds
+  // is real, but only a full frame can say there is none
   uint8_t pinkCount = eyes_get_pink_count();
-  int16_t pinkOffset = eyes_get_pink_offset_x(0);
+  if (pinkCount > 0 || eyes_get_full_frame())
+  {
+    seenPinkCount = pinkCount;
+    seenPinkOffset = eyes_get_pink_offset_x(0);
+  }
   eyes_release();
 
+  if (yellowFound) track_measure(yellowOffset, captureUs);
+
+  #if PROFILE_CAPTURE_MODE
+  float weight = 0.2;
+  avgCaptureTime = avgCaptureTime * (1 - weight) + (millis() - captureStart) * weight;
+  avgFrameTime = avgFrameTime * (1 - weight) + (millis() - lastFrameTime) * weight;
+  avgFps = (avgFrameTime > 0) ? 1000.0 / avgFrameTime : 0;
+  lastFrameTime = millis();
+  #endif
+}
+
+void captureMode()
+{
   #if PROFILE_CAPTURE_MODE
-  uint32_t captureTime = millis() - captureStart;
   uint32_t decisionStart = millis();
   #endif
 
+  uint32_t now = micros();
   int fwd = 0;
   int turn = 0;
 
   // 1. PINK - highest priority, avoid
-  if (pinkCount > 0)
+  if (seenPinkCount > 0)
   {
     fwd = PINK_FORWARD_SPEED * CAPTURE_PINK_GAIN;
     // Turn away: polarity based on pink position
-    turn = (pinkOffset > 0) ? -PINK_FORWARD_SPEED : PINK_FORWARD_SPEED;
+    turn = (seenPinkOffset > 0) ? -PINK_FORWARD_SPEED : PINK_FORWARD_SPEED;
     pixels.setPixelColor(1, pixels.Color(255, 0, 255)); // magenta
     pixels.show();
     wasScanning = false;
   }
-  // 2. YELLOW - drive toward it
-  else if (yellowFound)
+  // 2. YELLOW - drive toward where the tracker puts it now, through missed frames
+  else if (track_valid(now))
   {
+    float yellowOffset = track_predict(now);
     fwd = YELLOW_FORWARD_SPEED;
+    eyes_set_tracking(true); // Process only a window around the pillar while approaching
 
     // Just transitioned from scan? Counter-rotate slightly to kill spin momentum
     if (wasScanning)
@@ -138,7 +172,7 @@ void captureMode()
       turn = -CAPTURE_SCAN_HEADING * 0.5; // Brief counter-turn (opposite of scan direction)
       wasScanning = false;
     }
-    else if (abs(yellowOffset) > DEADZONE)
+    else if (fabsf(yellowOffset) > DEADZONE)
     {
       // Bang-bang: fixed turn magnitude, direction from offset sign
       turn = (yellowOffset > 0) ? YELLOW_FORWARD_SPEED * CAPTURE_YELLOW_GAIN
@@ -161,15 +195,10 @@ void captureMode()
   }
 
   #if PROFILE_CAPTURE_MODE
-  uint32_t decisionTime = millis() - decisionStart;
-  uint32_t frameTime = millis() - frameStart;
   float weight = 0.2;
-  avgCaptureTime = avgCaptureTime * (1 - weight) + captureTime * weight;
-  avgDecisionTime = avgDecisionTime * (1 - weight) + decisionTime * weight;
-  avgFrameTime = avgFrameTime * (1 - weight) + frameTime * weight;
-  avgFps = (avgFrameTime > 0) ? 1000.0 / avgFrameTime : 0;
+  avgDecisionTime = avgDecisionTime * (1 - weight) + (millis() - decisionStart) * weight;
   printProfileStats();
   #endif
 
   driveControl(fwd + turn, fwd - turn);
-}
\ No newline at end of file
+}
@@ -0,0 +1,129 @@
+/* ESTOP.H - IR emergency stop on its own high-priority task
+ *
+ * estop_begin(code, read, stop) to start the task
+ * estop_notify_from_isr() from the IR receiver's frame-complete interrupt
+ * estop_poll_code(&code) in loop() for every other IR code
+ * estop_triggered() / estop_clear()
+ * estop_get_latency_us() / estop_get_max_latency_us() / estop_get_count()
+ *
+ * The interrupt only timestamps the frame and wakes the ESTOP task, which
+ * outranks loop() and the vision task: it decodes the frame and, on the
+ * stop code, calls stop() right away, whatever loop() is in the middle of
+ * (a camera wait, a delay(), test mode). Other codes are queued for
+ * loop(), so the task is the receiver's only reader; nothing else may
+ * call decode() or resume() on it.
+ *
+ * Latency is measured from the interrupt to stop() returning and should
+ * stay under ESTOP_BOUND_US. A stop is latched until estop_clear().
+ */
+
+#ifndef ESTOP_H
+#define ESTOP_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define ESTOP_TASK_CORE 1           // loop()'s core; the vision task has core 0
+#define ESTOP_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#define ESTOP_TASK_STACK 4096       // Bytes
+#define ESTOP_BOUND_US 1000         // Interrupt -> drives stopped
+#define ESTOP_QUEUE 4               // Other codes waiting for loop() (power of 2)
+
+typedef bool (*EstopReadFn)(uint32_t* code);  // Decode the pending frame, false if none
+typedef void (*EstopStopFn)();                 // Cut the drives
+
+static SemaphoreHandle_t estop_wake = NULL;
+static uint32_t estop_code = 0;
+static EstopReadFn estop_read = NULL;
+static EstopStopFn estop_stop = NULL;
+
+static volatile uint32_t estop_isr_us = 0;     // Time of the last frame-complete interrupt
+static volatile bool estop_latched = false;
+static volatile uint32_t estop_last_us = 0;
+static volatile uint32_t estop_max_us = 0;
+static volatile uint32_t estop_count = 0;
+
+// Codes for loop(), written by the task only, read by loop() only
+static uint32_t estop_queue[ESTOP_QUEUE];
+static volatile uint32_t estop_queue_head = 0;
+static volatile uint32_t estop_queue_tail = 0;
+
+void IRAM_ATTR estop_notify_from_isr() {
+    estop_isr_us = micros();
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(estop_wake, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+void estop_task(void* arg) {
+    while (true) {
+        xSemaphoreTake(estop_wake, portMAX_DELAY);
+        uint32_t code;
+        while (estop_read(&code)) {
+            if (code == estop_code) {
+                estop_stop();
+                uint32_t us = micros() - estop_isr_us;
+                estop_latched = true;
+                estop_last_us = us;
+                if (us > estop_max_us) estop_max_us = us;
+                estop_count++;
+            } else if (estop_queue_head - estop_queue_tail < ESTOP_QUEUE) {
+                estop_queue[estop_queue_head % ESTOP_QUEUE] = code;
+                estop_queue_head++;
+            }
+        }
+    }
+}
+
+// Starts the task; hook the IR receiver's frame-complete interrupt to
+// estop_notify_from_isr() after this
+bool estop_begin(uint32_t code, EstopReadFn read, EstopStopFn stop) {
+    if (estop_wake) return true;
+    estop_wake = xSemaphoreCreateBinary();
+    if (!estop_wake) {
+        Serial.println("Estop: ERROR - Failed to create semaphore!");
+        return false;
+    }
+    estop_code = code;
+    estop_read = read;
+    estop_stop = stop;
+    if (xTaskCreatePinnedToCore(estop_task, "estop", ESTOP_TASK_STACK, NULL, ESTOP_TASK_PRIORITY, NULL,
+                                ESTOP_TASK_CORE) != pdPASS) {
+        Serial.println("Estop: ERROR - Failed to start task!");
+        return false;
+    }
+    return true;
+}
+
+// Next IR code that was not the stop code, false if none waiting
+bool estop_poll_code(uint32_t* code) {
+    if (estop_queue_tail == estop_queue_head) return false;
+    *code = estop_queue[estop_queue_tail % ESTOP_QUEUE];
+    estop_queue_tail++;
+    return true;
+}
+
+bool estop_triggered() {
+    return estop_latched;
+}
+
+// Call once the drives are attached again
+void estop_clear() {
+    estop_latched = false;
+}
+
+uint32_t estop_get_latency_us() {
+    return estop_last_us;
+}
+
+uint32_t estop_get_max_latency_us() {
+    return estop_max_us;
+}
+
+uint32_t estop_get_count() {
+    return estop_count;
+}
+
+#endif // ESTOP_H
@@ -4,6 +4,22 @@
  * eyes_init() to initalize
  * eyes_snap() to capture frame and detect blobs
  * eyes_release() to free the frame buffer
+ * eyes_start_async() to capture and process on a vision task on the other core
+ * eyes_latest() to pick up the newest result without waiting (async mode)
+ * eyes_set_tracking(true) to process only a window around the pillar once found
+ * eyes_set_coarse_to_fine(false) to classify every pixel (coarse pass is on by default)
+ * EYES_YUV422 1 (define before including) to take YUV422 from the sensor and
+ *   classify on U/V boxes instead of HSV ranges (see SENSOR FORMAT)
+ * EYES_FRAMESIZE EYES_QVGA / EYES_VGA (define before including) for a larger
+ *   frame than the default QQVGA (see FRAME SIZE)
+ * EyesPipeline for more detectors than the default one, e.g. one per thread
+ *   on a host (see PIPELINE)
+ *
+ * Host build: host/ compiles this header on Linux against shim Arduino.h /
+ * esp_camera.h and a mock camera (see host/CMakeLists.txt). Pablo_main/eyes.h
+ * must stay an identical copy of this file; the host build checks it.
+ * Every function and global is inline (C++17), so any number of .cpp files
+ * may include it and they share one pipeline, LUT and async task.
  *
  * Getters:
  * eyes_get_yellow_found()
@@ -12,6 +28,12 @@
  * eyes_get_pink_count()
  * eyes_get_pink_offset_x(index)
  * eyes_get_pink_area(index)
+ * eyes_get_count(target) / eyes_get_detection(target, index) for any entry of EYES_TARGETS
+ * eyes_get_frame_timestamp_us()
+ * eyes_get_stage_us(EYES_STAGE_...)
+ * eyes_get_profile(EYES_PROF_...) / eyes_get_profile_percentile(stage, pct)
+ *   per-stage timing history; eyes_profile_dump() prints it,
+ *   eyes_profile_reset() clears it (EYES_PROFILE 0 compiles it out)
  *
  * Example:
  *   eyes_init();
@@ -28,6 +50,16 @@
 
 #include <Arduino.h>
 #include "esp_camera.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+// EYES_NAMESPACE - when defined, everything below is declared in that
+// namespace (the macros aside). A host program linking several eyes.h
+// builds, e.g. host/res_bench with one per frame size, names one for each.
+#ifdef EYES_NAMESPACE
+namespace EYES_NAMESPACE {
+#endif
 
 // CAMERA PINS - XIAO ESP32S3 Sense
 #define EYES_PWDN_GPIO_NUM     -1
@@ -47,10 +79,52 @@
 #define EYES_HREF_GPIO_NUM     47
 #define EYES_PCLK_GPIO_NUM     13
 
-// CONFIGURATION
+// FRAME SIZE - picked at compile time (define EYES_FRAMESIZE before
+// including). Every buffer, table and loop bound below follows from
+// EYES_IMG_WIDTH / EYES_IMG_HEIGHT, so each size is its own build with
+// constant trip counts and a static working set; the static_asserts catch
+// a size that would not fit. Offsets, areas and boxes are in pixels of
+// this size; separations, margins and the minimum area scale with
+// EYES_PX_SCALE.
+#define EYES_QQVGA 0  // 160x120
+#define EYES_QVGA  1  // 320x240
+#define EYES_VGA   2  // 640x480
+
+#ifndef EYES_FRAMESIZE
+#define EYES_FRAMESIZE EYES_QQVGA
+#endif
+
+#if EYES_FRAMESIZE == EYES_QQVGA
 #define EYES_IMG_WIDTH  160
 #define EYES_IMG_HEIGHT 120
-#define EYES_MIN_BLOB_AREA 4  // Minimum pixels for valid blob
+#define EYES_CAMERA_FRAMESIZE FRAMESIZE_QQVGA
+#elif EYES_FRAMESIZE == EYES_QVGA
+#define EYES_IMG_WIDTH  320
+#define EYES_IMG_HEIGHT 240
+#define EYES_CAMERA_FRAMESIZE FRAMESIZE_QVGA
+#elif EYES_FRAMESIZE == EYES_VGA
+#define EYES_IMG_WIDTH  640
+#define EYES_IMG_HEIGHT 480
+#define EYES_CAMERA_FRAMESIZE FRAMESIZE_VGA
+#else
+#error "EYES_FRAMESIZE must be EYES_QQVGA, EYES_QVGA or EYES_VGA"
+#endif
+#define EYES_PX_SCALE (EYES_IMG_WIDTH / 160)  // Pixels per QQVGA pixel
+
+// CONFIGURATION
+#define EYES_MIN_BLOB_AREA (4 * EYES_PX_SCALE)  // Minimum pixels for valid blob (linear in width: speckle out, reach kept)
+#define EYES_CLOSE_KERNEL 3   // Morphological close size (odd, up to EYES_MAX_KERNEL)
+
+// SENSOR FORMAT - 0: RGB565 frames, each target an HSV range. 1: YUV422
+// frames (Y0 U Y1 V per pixel pair), each target a rectangle in U/V with
+// a Y (brightness) gate, classified through three 256-byte tables instead
+// of the 64 KB RGB565 one. The UV boxes below are the best IoU fit to the
+// HSV ranges over every RGB565 color (BT.601 full range): IoU 0.77 for
+// yellow, 0.73 for pink; host/format_bench measures the agreement on frames. laptop.ino
+// streams frames to viewer.py as RGB565 and needs 0.
+#ifndef EYES_YUV422
+#define EYES_YUV422 0
+#endif
 
 // HSV RANGE STRUCTURE
 typedef struct {
@@ -58,32 +132,98 @@ typedef struct {
     uint8_t s_min, s_max;
     uint8_t v_min, v_max;
 
-    bool wraps_around() const {
+    constexpr bool wraps_around() const {
         return h_min > h_max;  // Hue wraps around 179->0
     }
 } EyesHSVRange;
 
 // Yellow blob
-const EyesHSVRange EYES_YELLOW_RANGE = {15, 40, 80, 255, 80, 255};
+inline constexpr EyesHSVRange EYES_YELLOW_RANGE = {15, 40, 80, 255, 80, 255};
 
 // Pink blobs
-const EyesHSVRange EYES_PINK_RANGE = {145, 175, 140, 255, 50, 255};
+inline constexpr EyesHSVRange EYES_PINK_RANGE = {145, 175, 140, 255, 50, 255};
 
-// Internal result structure
+// YUV RANGE STRUCTURE - inclusive box in chroma, gated on brightness
+typedef struct {
+    uint8_t y_min, y_max;
+    uint8_t u_min, u_max;
+    uint8_t v_min, v_max;
+} EyesUVRange;
+
+// Same colors as EYES_YELLOW_RANGE / EYES_PINK_RANGE, for EYES_YUV422
+inline constexpr EyesUVRange EYES_YELLOW_UV = {67, 243, 0, 97, 117, 178};
+inline constexpr EyesUVRange EYES_PINK_UV = {32, 160, 115, 203, 172, 255};
+
+// TARGETS - every color the detector looks for. Each entry becomes one
+// class: one bit in the class LUT, one mask plane, one set of labeler
+// tables, all filled by the same single pass over the frame. Adding a
+// color is one more row here (up to 8) plus its EYES_PLANE_ index.
 typedef struct {
-    // Yellow blob (0 = not found, 1 = found)
-    uint8_t yellow_found;
-    int16_t yellow_offset_x;  // Pixels from center (negative=left, positive=right)
-    uint16_t yellow_area;
+    const char* name;
+    EyesHSVRange range;
+    EyesUVRange uv;          // Used instead of range when EYES_YUV422
+    uint8_t max_blobs;       // Detections reported per frame
+    uint16_t min_area;       // Pixels
+    uint8_t min_separation;  // Centroid x distance between reported blobs (0 = any)
+} EyesTarget;
+
+inline constexpr EyesTarget EYES_TARGETS[] = {
+    {"Yellow", EYES_YELLOW_RANGE, EYES_YELLOW_UV, 1, EYES_MIN_BLOB_AREA, 0},
+    {"Pink", EYES_PINK_RANGE, EYES_PINK_UV, 2, EYES_MIN_BLOB_AREA, 20 * EYES_PX_SCALE},
+};
+
+// Index into EYES_TARGETS (and class plane) of each target
+#define EYES_PLANE_YELLOW 0
+#define EYES_PLANE_PINK   1
+
+// PACKED MASKS - one bit per pixel per class, bit (x % 32) of word (x / 32).
+// Rows are stored class-interleaved: [y][class][word], so a single row loop
+// touches every class.
+#define EYES_NUM_CLASSES ((int)(sizeof(EYES_TARGETS) / sizeof(EYES_TARGETS[0])))
+#define EYES_MASK_WORDS ((EYES_IMG_WIDTH + 31) / 32)                  // Words per row per class
+#define EYES_MASK_ROW_WORDS (EYES_NUM_CLASSES * EYES_MASK_WORDS)      // Words per row, all classes
+#define EYES_MASK_TOTAL_WORDS (EYES_IMG_HEIGHT * EYES_MASK_ROW_WORDS)
+
+static_assert(EYES_NUM_CLASSES >= 1 && EYES_NUM_CLASSES <= 8, "The class LUT holds up to 8 targets");
+static_assert(!EYES_YUV422 || EYES_IMG_WIDTH % 2 == 0, "YUV422 rows are whole pixel pairs");
+
+constexpr int eyes_max_detections() {
+    int n = 0;
+    for (const EyesTarget& t : EYES_TARGETS) n = t.max_blobs > n ? t.max_blobs : n;
+    return n;
+}
+#define EYES_MAX_DETECTIONS eyes_max_detections()  // Largest max_blobs in EYES_TARGETS
+
+// One reported blob
+typedef struct {
+    int16_t offset_x;      // Centroid pixels from center (negative=left, positive=right)
+    int16_t centroid_y;
+    uint32_t area;         // Pixels; a VGA frame has more than 65535
+    int16_t x_min, x_max;  // Bounding box
+    int16_t y_min, y_max;
+} EyesDetection;
+
+// STAGE TIMINGS - microseconds spent in each part of a frame
+enum {
+    EYES_STAGE_CAPTURE,  // Waiting in esp_camera_fb_get()
+    EYES_STAGE_COARSE,   // Coarse pass
+    EYES_STAGE_DETECT,   // Classify, close and label (fused, row by row)
+    EYES_STAGE_REPORT,   // Picking detections out of the blob tables
+    EYES_NUM_STAGES
+};
 
-    // Pink blobs (0, 1, or 2 blobs found)
-    uint8_t pink_count;
-    int16_t pink_offset_x[2];  // Offsets for up to 2 pink blobs
-    uint16_t pink_area[2];
+// Internal result structure
+typedef struct {
+    // Per target, largest first (count 0 = not found)
+    uint8_t count[EYES_NUM_CLASSES];
+    EyesDetection blobs[EYES_NUM_CLASSES][EYES_MAX_DETECTIONS];
 
     // Processing info
     uint32_t frame_number;
     uint32_t process_time_ms;
+    uint32_t capture_us;  // Sensor timestamp of the frame, on the micros() clock
+    int16_t roi_x_min, roi_x_max;  // Columns processed (whole width unless tracking)
+    uint16_t stage_us[EYES_NUM_STAGES];  // Saturates at 65535
 
     // Frame buffer (for sending to laptop if needed)
     camera_fb_t* framebuffer;
@@ -93,51 +233,159 @@ typedef struct {
 typedef struct {
     int32_t x_sum;
     int32_t y_sum;
-    uint16_t pixel_count;
+    uint32_t pixel_count;
     int16_t x_min, x_max;
     int16_t y_min, y_max;
 } EyesBlobInfo;
 
-static EyesResult eyes_result = {0}; // Internal storage
+// PROFILING - per-stage timings of every frame: the last EYES_PROF_RING
+// samples of each stage (for percentiles) plus a log2 histogram, count,
+// total and max over all frames since eyes_profile_reset() (or init()).
+// Finer than stage_us: the fused row loop is timed as a whole and split
+// into classify, morph and label in the proportions laps measure on every
+// EYES_PROF_ROW_STRIDE-th row (offset by the frame number, so every row
+// gets sampled in turn). Lapping every row would cost ~10% of a frame.
+// Whole-frame stages reuse the cycle counter reads stage_us is computed
+// from, so the only reads the profiler adds are the sampled rows' laps.
+// Each EyesPipeline keeps its own profile. Build with EYES_PROFILE 0 and
+// every probe compiles to nothing.
+#ifndef EYES_PROFILE
+#define EYES_PROFILE 1
+#endif
+#define EYES_PROF_RING 64     // Samples kept per stage
+#define EYES_PROF_ROW_STRIDE 64
+#define EYES_PROF_BUCKETS 17  // Bucket b counts [2^(b-1), 2^b) us; 0: under 1 us, 16: 32768+
+
+enum {
+    EYES_PROF_CAPTURE,   // Waiting in esp_camera_fb_get()
+    EYES_PROF_CLASSIFY,  // Coarse pass and color classification
+    EYES_PROF_MORPH,     // Close (dilate + erode, both directions)
+    EYES_PROF_LABEL,     // Union-find labeling
+    EYES_PROF_FILTER,    // Top-N, separation filter and tracking update
+    EYES_PROF_STAGES
+};
+
+inline const char* const EYES_PROF_NAMES[EYES_PROF_STAGES] = {"capture", "classify", "morph", "label", "filter"};
 
-// --- GETTER FUNCTIONS ---
-
-bool eyes_get_yellow_found() {
-    return eyes_result.yellow_found != 0;
-}
-
-int16_t eyes_get_yellow_offset_x() {
-    return eyes_result.yellow_offset_x;
-}
-
-uint16_t eyes_get_yellow_area() {
-    return eyes_result.yellow_area;
-}
-
-uint8_t eyes_get_pink_count() {
-    return eyes_result.pink_count;
-}
+typedef struct {
+    uint32_t count;                  // Frames recorded
+    uint64_t total_us;
+    uint32_t max_us;
+    uint16_t ring[EYES_PROF_RING];   // Newest at (count - 1) % EYES_PROF_RING, saturates at 65535
+    uint32_t hist[EYES_PROF_BUCKETS];
+} EyesProfStage;
 
-int16_t eyes_get_pink_offset_x(uint8_t index) {
-    if (index >= 2) return 0;
-    return eyes_result.pink_offset_x[index];
+typedef struct {
+    EyesProfStage stages[EYES_PROF_STAGES];
+    uint32_t cycles[EYES_PROF_STAGES];  // This frame so far
+    uint32_t rows[EYES_PROF_STAGES];    // Sampled rows of the row loop
+    uint32_t phase;                     // First sampled row
+    uint32_t rows_lapped;               // Sampled rows since reset (4 counter reads each)
+} EyesProfiler;
+
+#if EYES_PROFILE
+inline void eyes_prof_record(EyesProfiler* prof, int stage, uint32_t us) {
+    EyesProfStage* p = &prof->stages[stage];
+    p->ring[p->count % EYES_PROF_RING] = us > 0xFFFF ? 0xFFFF : us;
+    p->count++;
+    p->total_us += us;
+    if (us > p->max_us) p->max_us = us;
+    int b = us ? 32 - __builtin_clz(us) : 0;
+    p->hist[min(b, EYES_PROF_BUCKETS - 1)]++;
 }
 
-uint16_t eyes_get_pink_area(uint8_t index) {
-    if (index >= 2) return 0;
-    return eyes_result.pink_area[index];
+// Shares out the row loop's cycles in the proportions of the sampled rows
+inline void eyes_prof_rows_end(EyesProfiler* prof, uint32_t total) {
+    uint64_t sampled = 0;
+    for (int s = 0; s < EYES_PROF_STAGES; s++) sampled += prof->rows[s];
+    for (int s = 0; s < EYES_PROF_STAGES; s++) {
+        if (sampled) prof->cycles[s] += (uint32_t)((uint64_t)total * prof->rows[s] / sampled);
+        prof->rows[s] = 0;
+    }
+    if (!sampled) prof->cycles[EYES_PROF_CLASSIFY] += total;
+    prof->phase = (prof->phase + 1) % EYES_PROF_ROW_STRIDE;
 }
 
-camera_fb_t* eyes_get_framebuffer() {
-    return eyes_result.framebuffer;
+// Turns the laps of the frame just processed into samples. One division
+// per frame: each stage is scaled by a 2^24 fixed-point us-per-cycle.
+inline void eyes_prof_commit(EyesProfiler* prof) {
+    uint64_t us_per_cycle = ((uint64_t)1 << 24) / ESP.getCpuFreqMHz();
+    for (int s = EYES_PROF_CLASSIFY; s < EYES_PROF_STAGES; s++) {
+        eyes_prof_record(prof, s, (uint32_t)((prof->cycles[s] * us_per_cycle + ((uint64_t)1 << 23)) >> 24));
+        prof->cycles[s] = 0;
+    }
 }
 
-uint32_t eyes_get_frame_number() {
-    return eyes_result.frame_number;
+// Every probe names the profiler it feeds (an EyesProfiler*). ADD charges
+// n cycles the caller measured anyway to a stage.
+#define EYES_PROF_ADD(prof, stage, n) ((prof)->cycles[stage] += (n))
+#define EYES_PROF_SAMPLE(prof, stage, us) eyes_prof_record(prof, stage, us)
+#define EYES_PROF_COMMIT(prof) eyes_prof_commit(prof)
+
+// Row loop: ROWS_START before it, ROW(y) at the top of each row, ROW_LAP
+// after each stage in it. prof may be NULL (no samples). ROWS_END(prof,
+// total) hands over the whole loop's cycles, from the caller's reads.
+#define EYES_PROF_ROWS_START(prof) \
+    uint32_t prof_row_t_ = 0; \
+    bool prof_row_ = false
+#define EYES_PROF_ROW(prof, y) do { \
+        prof_row_ = (prof) && ((y) + (prof)->phase) % EYES_PROF_ROW_STRIDE == 0; \
+        if (prof_row_) { \
+            prof_row_t_ = ESP.getCycleCount(); \
+            (prof)->rows_lapped++; \
+        } \
+    } while (0)
+#define EYES_PROF_ROW_LAP(prof, stage) do { \
+        if (prof_row_) { \
+            uint32_t now_ = ESP.getCycleCount(); \
+            (prof)->rows[stage] += now_ - prof_row_t_; \
+            prof_row_t_ = now_; \
+        } \
+    } while (0)
+#define EYES_PROF_ROWS_END(prof, total) eyes_prof_rows_end(prof, total)
+#else
+#define EYES_PROF_ADD(prof, stage, n) do {} while (0)
+#define EYES_PROF_ROWS_START(prof) do {} while (0)
+#define EYES_PROF_ROW(prof, y) do {} while (0)
+#define EYES_PROF_ROW_LAP(prof, stage) do {} while (0)
+#define EYES_PROF_ROWS_END(prof, total) do {} while (0)
+#define EYES_PROF_SAMPLE(prof, stage, us) do {} while (0)
+#define EYES_PROF_COMMIT(prof) do {} while (0)
+#endif
+
+// Percentile (0-100) of a stage over its last EYES_PROF_RING frames, in us
+inline uint32_t eyes_prof_percentile(const EyesProfStage* p, uint8_t pct) {
+    if (!p || p->count == 0) return 0;
+    int n = min<uint32_t>(p->count, EYES_PROF_RING);
+    uint16_t sorted[EYES_PROF_RING];
+    for (int i = 0; i < n; i++) {
+        uint16_t v = p->ring[i];
+        int j = i;
+        for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+    }
+    return sorted[(n - 1) * min<int>(pct, 100) / 100];
 }
 
-uint32_t eyes_get_process_time_ms() {
-    return eyes_result.process_time_ms;
+// Prints every stage: mean, p50/p99 of the ring, max, then the histogram
+// buckets in use ("16:120" = 120 frames took 16-31 us). prof NULL: profiling
+// is compiled out.
+inline void eyes_prof_print(const EyesProfiler* prof) {
+    if (!prof) {
+        Serial.println("Eyes: profiling compiled out (EYES_PROFILE 0)");
+        return;
+    }
+    Serial.println("Eyes: profile (us)   frames   mean    p50    p99    max  | histogram (from us:frames)");
+    for (int s = 0; s < EYES_PROF_STAGES; s++) {
+        const EyesProfStage* p = &prof->stages[s];
+        Serial.printf("Eyes:   %-10s %8u %6u %6u %6u %6u  |", EYES_PROF_NAMES[s], (unsigned)p->count,
+                      (unsigned)(p->count ? p->total_us / p->count : 0), (unsigned)eyes_prof_percentile(p, 50),
+                      (unsigned)eyes_prof_percentile(p, 99), (unsigned)p->max_us);
+        for (int b = 0; b < EYES_PROF_BUCKETS; b++) {
+            if (p->hist[b]) Serial.printf(" %u:%u", b ? 1u << (b - 1) : 0u, (unsigned)p->hist[b]);
+        }
+        Serial.println();
+    }
 }
 
 // RGB <-> HSV CONVERSION
@@ -192,57 +440,254 @@ inline bool eyes_in_hsv_range(uint8_t h, uint8_t s, uint8_t v, const EyesHSVRang
     }
 }
 
-//Connect nearby clusters (can make config more)
-void eyes_dilate(uint8_t* input, uint8_t* output, int width, int height, int kernel_size) {
-    int k = kernel_size / 2;  
+// PIXEL CLASSIFICATION - class bit n is set when EYES_TARGETS[n] matches,
+// and lands in plane n of the packed mask
 
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            uint8_t max_val = 0;
-            // Check neighborhood 
-            for (int dy = -k; dy <= k; dy++) {
-                for (int dx = -k; dx <= k; dx++) {
-                    int ny = y + dy;
-                    int nx = x + dx;
-                    // Boundary check
-                    if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
-                        uint8_t val = input[ny * width + nx];
-                        if (val > max_val) {
-                            max_val = val;
-                        }
-                    }
-                }
-            }
+// Reference classifier: RGB565 -> RGB888 -> HSV -> range checks
+inline uint8_t eyes_classify_pixel_hsv(uint16_t pixel) {
+    uint8_t r5 = (pixel >> 11) & 0x1F;
+    uint8_t g6 = (pixel >> 5) & 0x3F;
+    uint8_t b5 = pixel & 0x1F;
 
-            output[y * width + x] = max_val;
+    uint8_t r = (r5 << 3) | (r5 >> 2);  // Fill lower bits
+    uint8_t g = (g6 << 2) | (g6 >> 4);
+    uint8_t b = (b5 << 3) | (b5 >> 2);
+
+    uint8_t h, s, v;
+    eyes_rgb_to_hsv(r, g, b, &h, &s, &v);
+
+    uint8_t classes = 0;
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        if (eyes_in_hsv_range(h, s, v, EYES_TARGETS[c].range)) classes |= 1 << c;
+    }
+    return classes;
+}
+
+// Reference classifier for YUV422: U/V box and Y gate per target
+inline uint8_t eyes_classify_pixel_yuv(uint8_t y, uint8_t u, uint8_t v) {
+    uint8_t classes = 0;
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        const EyesUVRange& r = EYES_TARGETS[c].uv;
+        if (y >= r.y_min && y <= r.y_max && u >= r.u_min && u <= r.u_max && v >= r.v_min && v <= r.v_max) {
+            classes |= 1 << c;
         }
     }
+    return classes;
 }
 
-void eyes_erode(uint8_t* input, uint8_t* output, int width, int height, int kernel_size) {
-    int k = kernel_size / 2;
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            uint8_t min_val = 255;
-            for (int dy = -k; dy <= k; dy++) {
-                for (int dx = -k; dx <= k; dx++) {
-                    int ny = y + dy;
-                    int nx = x + dx;
-                    if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
-                        uint8_t val = input[ny * width + nx];
-                        if (val < min_val) {
-                            min_val = val;
-                        }
-                    }
-                }
-            }
+// VECTOR CLASSIFIER - eyes_classify_pixel_hsv() on EYES_VEC_LANES pixels at
+// once with GCC vector extensions (SSE2 on the host, plain loops where the
+// target has no vector unit). The branches become lane masks and selects,
+// and the two divisions become bit-by-bit quotient searches (multiply and
+// compare only), so every lane gets the same h, s, v as the scalar code:
+//   s = delta * 255 / max      8 steps, quotient 0..255
+//   h = 30 * diff / delta      5 steps on |diff|, quotient 0..30, sign back
+// Products stay within 16 bits. host/eyes_bench checks it against the
+// scalar classifier on all 65536 values and on random pixel runs.
+#define EYES_VEC_LANES 8  // 128-bit vectors: SSE2 on the host, the ESP32-S3 PIE register width
+
+typedef int16_t EyesVecI16 __attribute__((vector_size(2 * EYES_VEC_LANES)));
+typedef uint16_t EyesVecU16 __attribute__((vector_size(2 * EYES_VEC_LANES)));
+
+// Per lane: a where m is set (all ones, as compares give), else b
+template <typename V, typename M>
+inline V eyes_vsel(M m, V a, V b) {
+    V mv = (V)m;
+    return (mv & a) | (~mv & b);
+}
 
-            output[y * width + x] = min_val;
+inline EyesVecU16 eyes_classify_vec(EyesVecU16 pixel) {
+    EyesVecI16 r5 = (EyesVecI16)((pixel >> 11) & 0x1F);
+    EyesVecI16 g6 = (EyesVecI16)((pixel >> 5) & 0x3F);
+    EyesVecI16 b5 = (EyesVecI16)(pixel & 0x1F);
+    EyesVecI16 r = (r5 << 3) | (r5 >> 2);
+    EyesVecI16 g = (g6 << 2) | (g6 >> 4);
+    EyesVecI16 b = (b5 << 3) | (b5 >> 2);
+
+    EyesVecI16 max_val = eyes_vsel(r > g, r, g);
+    max_val = eyes_vsel(b > max_val, b, max_val);
+    EyesVecI16 min_val = eyes_vsel(r < g, r, g);
+    min_val = eyes_vsel(b < min_val, b, min_val);
+    EyesVecI16 delta = max_val - min_val;
+
+    EyesVecU16 s = {};
+    EyesVecU16 max_u = (EyesVecU16)max_val, scaled = (EyesVecU16)delta * 255;
+    for (int bit = 128; bit; bit >>= 1) {
+        EyesVecU16 t = s | (uint16_t)bit;
+        s = eyes_vsel(t * max_u <= scaled, t, s);
+    }
+    s = eyes_vsel(max_val != 0, s, EyesVecU16{});
+
+    // Same max_val == r / == g order as the scalar tie-break
+    EyesVecI16 is_r = max_val == r;
+    EyesVecI16 is_g = ~is_r & (max_val == g);
+    EyesVecI16 diff = eyes_vsel(is_r, g - b, eyes_vsel(is_g, b - r, r - g));
+    EyesVecI16 base = eyes_vsel(is_r, EyesVecI16{}, eyes_vsel(is_g, EyesVecI16{} + 60, EyesVecI16{} + 120));
+    EyesVecI16 negative = diff < 0;
+    EyesVecI16 num = eyes_vsel(negative, -diff, diff) * 30;
+    EyesVecI16 q = {};
+    for (int bit = 16; bit; bit >>= 1) {
+        EyesVecI16 t = q | (int16_t)bit;
+        q = eyes_vsel(t * delta <= num, t, q);
+    }
+    EyesVecI16 h = base + eyes_vsel(negative, -q, q);
+    h = eyes_vsel(h < 0, h + 180, h);
+    h = eyes_vsel(delta != 0, h, EyesVecI16{});  // Also max_val == 0
+    EyesVecI16 sv = (EyesVecI16)s;
+
+    EyesVecI16 classes = {};
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        const EyesHSVRange& range = EYES_TARGETS[c].range;
+        EyesVecI16 hit = (sv >= range.s_min) & (sv <= range.s_max) & (max_val >= range.v_min) &
+                         (max_val <= range.v_max);
+        if (range.wraps_around()) {
+            hit &= (h >= range.h_min) | (h <= range.h_max);
+        } else {
+            hit &= (h >= range.h_min) & (h <= range.h_max);
         }
+        classes |= hit & (int16_t)(1 << c);
+    }
+    return (EyesVecU16)classes;
+}
+
+// Class bits of n RGB565 pixels (camera byte order) into classes[]. Whole
+// vectors through eyes_classify_vec(), the tail through the scalar path.
+inline void eyes_classify_pixels(const uint8_t* src, uint8_t* classes, int n) {
+    int x = 0;
+    for (; x + EYES_VEC_LANES <= n; x += EYES_VEC_LANES) {
+        EyesVecU16 pixel;
+        memcpy(&pixel, src + x * 2, sizeof(pixel));  // Little-endian load of big-endian pixels
+        EyesVecU16 c = eyes_classify_vec((pixel << 8) | (pixel >> 8));
+        for (int i = 0; i < EYES_VEC_LANES; i++) classes[x + i] = (uint8_t)c[i];
+    }
+    for (const uint8_t* p = src + x * 2; x < n; x++, p += 2) classes[x] = eyes_classify_pixel_hsv((p[0] << 8) | p[1]);
+}
+
+// Class bits for every RGB565 value. Filled by eyes_build_class_lut() with
+// the vector classifier, bit-exact with eyes_classify_pixel_hsv(). Rebuild
+// if the ranges change at runtime. Every EyesPipeline reads the same
+// tables, so build them before any pipeline runs on another thread.
+// With EYES_YUV422 a box is separable, so three 256-entry tables replace
+// it: the classes whose Y, U and V ranges each hold the value, ANDed.
+#if EYES_YUV422
+inline uint8_t eyes_y_lut[256];
+inline uint8_t eyes_u_lut[256];
+inline uint8_t eyes_v_lut[256];
+#else
+inline uint8_t eyes_class_lut[65536];
+#endif
+inline bool eyes_class_lut_built = false;
+
+inline void eyes_build_class_lut() {
+#if EYES_YUV422
+    for (int i = 0; i < 256; i++) {
+        eyes_y_lut[i] = eyes_u_lut[i] = eyes_v_lut[i] = 0;
+        for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+            const EyesUVRange& r = EYES_TARGETS[c].uv;
+            if (i >= r.y_min && i <= r.y_max) eyes_y_lut[i] |= 1 << c;
+            if (i >= r.u_min && i <= r.u_max) eyes_u_lut[i] |= 1 << c;
+            if (i >= r.v_min && i <= r.v_max) eyes_v_lut[i] |= 1 << c;
+        }
+    }
+#else
+    EyesVecU16 lanes;
+    for (int i = 0; i < EYES_VEC_LANES; i++) lanes[i] = i;
+    for (uint32_t pixel = 0; pixel < 65536; pixel += EYES_VEC_LANES) {
+        EyesVecU16 c = eyes_classify_vec(lanes + (uint16_t)pixel);
+        for (int i = 0; i < EYES_VEC_LANES; i++) eyes_class_lut[pixel + i] = (uint8_t)c[i];
     }
+#endif
+    eyes_class_lut_built = true;
 }
 
-void eyes_morphological_close(uint8_t* mask, int width, int height, int kernel_size) {
+// Class bits of pixel x of a row (camera byte order). A YUV422 row must
+// start on a pixel pair.
+inline uint8_t eyes_pixel_classes(const uint8_t* row, int x) {
+#if EYES_YUV422
+    const uint8_t* pair = row + (x & ~1) * 2;
+    return eyes_u_lut[pair[1]] & eyes_v_lut[pair[3]] & eyes_y_lut[row[x * 2]];
+#else
+    return eyes_class_lut[((uint16_t)row[x * 2] << 8) | row[x * 2 + 1]];
+#endif
+}
+
+// SEPARABLE MORPHOLOGY - running max/min (van Herk / Gil-Werman)
+// Filters one line of n values (stride apart) in place with a window of
+// 2r+1: three comparisons per pixel whatever the kernel size. The line is
+// copied into f with r identity values on each side (0 for max, 255 for
+// min), which is the "ignore pixels outside the image" rule, so the inner
+// loops need no bounds checks. f, g, h must each hold eyes_vhgw_len(n, r).
+inline int eyes_vhgw_len(int n, int r) {
+    int k = 2 * r + 1;
+    return ((n + 2 * r + k - 1) / k) * k;
+}
+
+template <bool TakeMax>
+inline uint8_t eyes_vhgw_op(uint8_t a, uint8_t b) {
+    return TakeMax ? (a > b ? a : b) : (a < b ? a : b);
+}
+
+template <bool TakeMax>
+inline void eyes_vhgw_line(uint8_t* line, int n, int stride, int r, uint8_t* f, uint8_t* g, uint8_t* h) {
+    const uint8_t identity = TakeMax ? 0 : 255;
+    int k = 2 * r + 1;
+    int len = eyes_vhgw_len(n, r);
+
+    memset(f, identity, r);
+    for (int i = 0; i < n; i++) f[r + i] = line[i * stride];
+    memset(f + r + n, identity, len - r - n);
+
+    // Prefix (g) and suffix (h) extremes within each block of k
+    for (int b = 0; b < len; b += k) {
+        g[b] = f[b];
+        for (int j = 1; j < k; j++) g[b + j] = eyes_vhgw_op<TakeMax>(g[b + j - 1], f[b + j]);
+        h[b + k - 1] = f[b + k - 1];
+        for (int j = k - 2; j >= 0; j--) h[b + j] = eyes_vhgw_op<TakeMax>(h[b + j + 1], f[b + j]);
+    }
+
+    // Window f[x .. x+2r] spans at most two blocks
+    for (int x = 0; x < n; x++) {
+        line[x * stride] = eyes_vhgw_op<TakeMax>(h[x], g[x + k - 1]);
+    }
+}
+
+// Row pass then column pass, both in place on output
+template <bool TakeMax>
+inline void eyes_separable_filter(uint8_t* input, uint8_t* output, int width, int height, int kernel_size) {
+    int r = kernel_size / 2;
+    memcpy(output, input, width * height);
+    if (r == 0) return;
+
+    int len = eyes_vhgw_len(max(width, height), r);
+    uint8_t* scratch = (uint8_t*)malloc(3 * len);
+    if (!scratch) {
+        Serial.println("Eyes: WARNING - Failed to allocate line buffers for eyes_separable_filter");
+        return;
+    }
+    uint8_t* f = scratch;
+    uint8_t* g = scratch + len;
+    uint8_t* h = scratch + 2 * len;
+
+    for (int y = 0; y < height; y++) {
+        eyes_vhgw_line<TakeMax>(output + y * width, width, 1, r, f, g, h);
+    }
+    for (int x = 0; x < width; x++) {
+        eyes_vhgw_line<TakeMax>(output + x, height, width, r, f, g, h);
+    }
+
+    free(scratch);
+}
+
+//Connect nearby clusters (can make config more)
+inline void eyes_dilate(uint8_t* input, uint8_t* output, int width, int height, int kernel_size) {
+    eyes_separable_filter<true>(input, output, width, height, kernel_size);
+}
+
+inline void eyes_erode(uint8_t* input, uint8_t* output, int width, int height, int kernel_size) {
+    eyes_separable_filter<false>(input, output, width, height, kernel_size);
+}
+
+inline void eyes_morphological_close(uint8_t* mask, int width, int height, int kernel_size) {
     uint8_t* temp = (uint8_t*)malloc(width * height);
     if (!temp) {
         Serial.println("Eyes: WARNING - Failed to allocate temp buffer for eyes_morphological_close");
@@ -258,252 +703,977 @@ void eyes_morphological_close(uint8_t* mask, int width, int height, int kernel_s
     free(temp);
 }
 
-// BLOB DETECTION - Find largest blob in mask
-EyesBlobInfo eyes_find_largest_blob(uint8_t* mask, int width, int height) {
-    EyesBlobInfo largest = {0, 0, 0, width, 0, height, 0};
-    bool* visited = (bool*)calloc(width * height, sizeof(bool));
+// PACKED MASK HELPERS
+typedef uint32_t EyesMaskWord;
 
-    if (!visited) return largest;
+inline int eyes_mask_words(int width) {
+    return (width + 31) / 32;
+}
 
+// Valid bits of the last word in a row (padding bits beyond width are 0)
+inline EyesMaskWord eyes_mask_tail(int width) {
+    int used = width % 32;
+    return used ? (((EyesMaskWord)1 << used) - 1) : ~(EyesMaskWord)0;
+}
+
+inline bool eyes_mask_test(const EyesMaskWord* planes, int plane, int width, int x, int y) {
+    int words = eyes_mask_words(width);
+    const EyesMaskWord* row = planes + (y * EYES_NUM_CLASSES + plane) * words;
+    return (row[x >> 5] >> (x & 31)) & 1;
+}
+
+// Largest close kernel the packed path supports (radius must stay < 32 bits)
+#define EYES_MAX_KERNEL 31
+
+// One horizontal step on a class row: every pixel combines itself with the
+// pixels s to its left and right (1 <= s <= 31), OR for dilate, AND for erode.
+// Outside the image counts as the identity (0 / 1); padding bits beyond
+// width are forced to it so the inner loop has no edge cases.
+template <bool Erode>
+inline void eyes_packed_hstep_row(const EyesMaskWord* in, EyesMaskWord* out, int words, EyesMaskWord tail, int s) {
+    const EyesMaskWord fill = Erode ? ~(EyesMaskWord)0 : 0;
+    EyesMaskWord pad[EYES_MASK_WORDS + 2];
+
+    pad[0] = fill;
+    memcpy(pad + 1, in, words * sizeof(EyesMaskWord));
+    pad[words] = Erode ? (pad[words] | ~tail) : (pad[words] & tail);
+    pad[words + 1] = fill;
+
+    for (int i = 1; i <= words; i++) {
+        EyesMaskWord cur = pad[i];
+        EyesMaskWord left = (cur << s) | (pad[i - 1] >> (32 - s));   // Pixel x-s
+        EyesMaskWord right = (cur >> s) | (pad[i + 1] << (32 - s));  // Pixel x+s
+        out[i - 1] = Erode ? (cur & left & right) : (cur | left | right);
+    }
+    out[words - 1] &= tail;
+}
+
+// One vertical step over whole rows (all classes): row y combines with rows
+// y-s and y+s. Rows outside the image are skipped (the identity).
+template <bool Erode>
+inline void eyes_packed_vstep(const EyesMaskWord* in, EyesMaskWord* out, int row_words, int height, int s) {
     for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int idx = y * width + x;
+        const EyesMaskWord* mid = in + y * row_words;
+        const EyesMaskWord* up = (y >= s) ? mid - s * row_words : mid;
+        const EyesMaskWord* down = (y + s < height) ? mid + s * row_words : mid;
+        EyesMaskWord* dst = out + y * row_words;
+        for (int i = 0; i < row_words; i++) {
+            dst[i] = Erode ? (mid[i] & up[i] & down[i]) : (mid[i] | up[i] | down[i]);
+        }
+    }
+}
+
+// Dilate (or erode) every plane by a (2r+1)^2 square. Radius is built up in
+// steps: combining radius a with offsets +-s (s <= a+1) gives radius a+s, so
+// r is reached in O(log r) word passes per axis (1 for 3x3, 2 for 5x5 and
+// 7x7, 3 for 9x9). Each step ping-pongs between *src and *dst.
+template <bool Erode>
+inline void eyes_packed_morph(EyesMaskWord** src, EyesMaskWord** dst, int width, int height, int r) {
+    int words = eyes_mask_words(width);
+    int row_words = EYES_NUM_CLASSES * words;
+    EyesMaskWord tail = eyes_mask_tail(width);
+
+    for (int a = 0; a < r; ) {
+        int s = min(a + 1, r - a);
+        for (int row = 0; row < height * EYES_NUM_CLASSES; row++) {
+            eyes_packed_hstep_row<Erode>(*src + row * words, *dst + row * words, words, tail, s);
+        }
+        EyesMaskWord* t = *src; *src = *dst; *dst = t;
+        a += s;
+    }
+    for (int a = 0; a < r; ) {
+        int s = min(a + 1, r - a);
+        eyes_packed_vstep<Erode>(*src, *dst, row_words, height, s);
+        EyesMaskWord* t = *src; *src = *dst; *dst = t;
+        a += s;
+    }
+}
 
-            if (mask[idx] && !visited[idx]) {
-                EyesBlobInfo current = {0, 0, 0, width, 0, height, 0};
+// kernel_size x kernel_size close of every class plane at once. temp must
+// hold as many words as planes. Bit-exact with
+// eyes_morphological_close(mask, w, h, kernel_size) per plane. width must
+// not exceed EYES_IMG_WIDTH (row scratch is sized from it).
+inline void eyes_packed_close(EyesMaskWord* planes, EyesMaskWord* temp, int width, int height, int kernel_size) {
+    int r = min(kernel_size, EYES_MAX_KERNEL) / 2;
+    EyesMaskWord* src = planes;
+    EyesMaskWord* dst = temp;
 
-                int* stack_x = (int*)malloc(4000 * sizeof(int));
-                int* stack_y = (int*)malloc(4000 * sizeof(int));
+    // Fills gaps
+    eyes_packed_morph<false>(&src, &dst, width, height, r);
 
-                if (!stack_x || !stack_y) {
-                    if (stack_x) free(stack_x);
-                    if (stack_y) free(stack_y);
-                    continue;
-                }
+    //Removes noise/ keeps connections
+    eyes_packed_morph<true>(&src, &dst, width, height, r);
 
-                int stack_size = 0;
-                stack_x[0] = x;
-                stack_y[0] = y;
-                stack_size = 1;
-
-                while (stack_size > 0) {
-                    int cx = stack_x[--stack_size];
-                    int cy = stack_y[stack_size];
-                    int cidx = cy * width + cx;
-
-                    if (cx < 0 || cx >= width || cy < 0 || cy >= height) continue;
-                    if (visited[cidx] || !mask[cidx]) continue;
-
-                    visited[cidx] = true;
-                    current.x_sum += cx;
-                    current.y_sum += cy;
-                    current.pixel_count++;
-
-                    current.x_min = min(current.x_min, (int16_t)cx);
-                    current.x_max = max(current.x_max, (int16_t)cx);
-                    current.y_min = min(current.y_min, (int16_t)cy);
-                    current.y_max = max(current.y_max, (int16_t)cy);
-
-                    if (stack_size < 3996) {
-                        stack_x[stack_size] = cx + 1; stack_y[stack_size++] = cy;
-                        stack_x[stack_size] = cx - 1; stack_y[stack_size++] = cy;
-                        stack_x[stack_size] = cx; stack_y[stack_size++] = cy + 1;
-                        stack_x[stack_size] = cx; stack_y[stack_size++] = cy - 1;
-                    }
-                }
+    if (src != planes) {
+        memcpy(planes, src, (size_t)height * EYES_NUM_CLASSES * eyes_mask_words(width) * sizeof(EyesMaskWord));
+    }
+}
+
+// Horizontal radius-r dilate (or erode) of one row, all classes, using the
+// same doubling steps as eyes_packed_morph()
+template <bool Erode>
+inline void eyes_packed_hmorph_row(const EyesMaskWord* in, EyesMaskWord* out, int width, int r) {
+    int words = eyes_mask_words(width);
+    int row_words = EYES_NUM_CLASSES * words;
+    EyesMaskWord tail = eyes_mask_tail(width);
+    EyesMaskWord step[EYES_MASK_ROW_WORDS];
+    const EyesMaskWord* src = in;
+
+    if (r == 0) memcpy(out, in, row_words * sizeof(EyesMaskWord));
+    for (int a = 0; a < r; ) {
+        int s = min(a + 1, r - a);
+        for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+            eyes_packed_hstep_row<Erode>(src + c * words, step + c * words, words, tail, s);
+        }
+        memcpy(out, step, row_words * sizeof(EyesMaskWord));
+        src = out;
+        a += s;
+    }
+}
+
+// BLOB LABELING - run-based union-find over the packed planes
+// Rows are fed top to bottom; each row is split into runs of set bits, and
+// a run takes the label of every run above it that it overlaps
+// (4-connectivity, same as the old flood fill), merging labels when it
+// touches several. Blob stats are accumulated per run and merged into the
+// surviving root, so one scan gives area, centroid sums and bounding box of
+// every blob of every class, with no per-blob allocation and no size limit.
+//
+// A blob with no run in the current row is finished: it moves to the
+// per-class blob table and its label is recycled. Only the previous and
+// current rows can hold live labels, so EYES_MAX_LABELS never runs out.
+// The table keeps the EYES_MAX_BLOBS largest blobs, ties in raster order of
+// their first pixel (the order the old flood fill found them in).
+#define EYES_MAX_ROW_RUNS ((EYES_IMG_WIDTH + 1) / 2)  // Worst case: alternating pixels
+#define EYES_MAX_LABELS (2 * EYES_MAX_ROW_RUNS)       // Previous row + current row
+#define EYES_MAX_BLOBS 32                             // Finished blobs kept per class
+#define EYES_NO_LABEL 0xFFFF
+
+typedef struct {
+    int16_t x0, x1;
+    uint16_t label;
+} EyesRun;
+
+typedef struct {
+    // Live labels (per class)
+    uint16_t parent[EYES_NUM_CLASSES][EYES_MAX_LABELS];
+    uint16_t stamp[EYES_NUM_CLASSES][EYES_MAX_LABELS];   // Row bookkeeping for recycling
+    uint32_t order[EYES_NUM_CLASSES][EYES_MAX_LABELS];   // Raster index of first pixel
+    EyesBlobInfo stats[EYES_NUM_CLASSES][EYES_MAX_LABELS];
+    uint16_t free_labels[EYES_NUM_CLASSES][EYES_MAX_LABELS];
+    uint16_t free_count[EYES_NUM_CLASSES];
+    uint16_t new_labels[EYES_NUM_CLASSES][EYES_MAX_ROW_RUNS];  // Created in the current row
+    uint16_t new_count[EYES_NUM_CLASSES];
+
+    EyesRun runs[2][EYES_NUM_CLASSES][EYES_MAX_ROW_RUNS];  // Previous / current row
+    uint16_t run_count[2][EYES_NUM_CLASSES];
+    uint8_t cur;
+    int row;
+    int width;
+
+    // Finished blobs, largest first
+    EyesBlobInfo blobs[EYES_NUM_CLASSES][EYES_MAX_BLOBS];
+    uint32_t blob_order[EYES_NUM_CLASSES][EYES_MAX_BLOBS];
+    uint16_t blob_count[EYES_NUM_CLASSES];  // Kept in blobs[]
+    uint16_t blob_total[EYES_NUM_CLASSES];  // Found this frame, including ones not kept
+} EyesLabeler;
+
+inline void eyes_labeler_reset(EyesLabeler* lab, int width) {
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        for (int l = 0; l < EYES_MAX_LABELS; l++) {
+            lab->free_labels[c][l] = EYES_MAX_LABELS - 1 - l;
+            lab->stamp[c][l] = 0;
+        }
+        lab->free_count[c] = EYES_MAX_LABELS;
+        lab->new_count[c] = 0;
+        lab->run_count[0][c] = 0;
+        lab->run_count[1][c] = 0;
+        lab->blob_count[c] = 0;
+        lab->blob_total[c] = 0;
+    }
+    lab->cur = 0;
+    lab->row = 0;
+    lab->width = width;
+}
+
+inline uint16_t eyes_labeler_find(uint16_t* parent, uint16_t label) {
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];  // Path halving
+        label = parent[label];
+    }
+    return label;
+}
+
+inline void eyes_blob_add_run(EyesBlobInfo* blob, int x0, int x1, int y) {
+    int len = x1 - x0 + 1;
+    blob->x_sum += (x0 + x1) * len / 2;
+    blob->y_sum += y * len;
+    blob->pixel_count += len;
+    if (x0 < blob->x_min) blob->x_min = x0;
+    if (x1 > blob->x_max) blob->x_max = x1;
+    if (y < blob->y_min) blob->y_min = y;
+    if (y > blob->y_max) blob->y_max = y;
+}
+
+inline void eyes_blob_merge(EyesBlobInfo* into, const EyesBlobInfo* from) {
+    into->x_sum += from->x_sum;
+    into->y_sum += from->y_sum;
+    into->pixel_count += from->pixel_count;
+    into->x_min = min(into->x_min, from->x_min);
+    into->x_max = max(into->x_max, from->x_max);
+    into->y_min = min(into->y_min, from->y_min);
+    into->y_max = max(into->y_max, from->y_max);
+}
+
+// Splits one class row into runs of set bits. Returns the run count.
+inline int eyes_extract_runs(const EyesMaskWord* row, int width, EyesRun* runs) {
+    int words = eyes_mask_words(width);
+    int n = 0;
+    int start = -1;
+
+    for (int w = 0; w < words; w++) {
+        EyesMaskWord bits = row[w];
+        int b = 0;
+        while (b < 32) {
+            // Looking for the next 1 (run start) or the next 0 (run end)
+            EyesMaskWord rest = (start < 0 ? bits : ~bits) >> b;
+            if (!rest) break;
+            b += __builtin_ctz(rest);
+            if (start < 0) {
+                start = w * 32 + b;
+            } else {
+                runs[n].x0 = start;
+                runs[n].x1 = w * 32 + b - 1;
+                n++;
+                start = -1;
+            }
+        }
+    }
+    if (start >= 0) {
+        runs[n].x0 = start;
+        runs[n].x1 = width - 1;
+        n++;
+    }
+    return n;
+}
+
+// Moves a finished blob into the class table, keeping the largest
+// EYES_MAX_BLOBS ordered by area, then raster order
+inline void eyes_labeler_emit(EyesLabeler* lab, int c, const EyesBlobInfo* blob, uint32_t order) {
+    EyesBlobInfo* blobs = lab->blobs[c];
+    uint32_t* orders = lab->blob_order[c];
+    int count = lab->blob_count[c];
+    lab->blob_total[c]++;
+
+    int pos = count;
+    while (pos > 0 && (blob->pixel_count > blobs[pos - 1].pixel_count ||
+                       (blob->pixel_count == blobs[pos - 1].pixel_count && order < orders[pos - 1]))) {
+        pos--;
+    }
+    if (pos >= EYES_MAX_BLOBS) return;
+
+    int last = min(count, EYES_MAX_BLOBS - 1);
+    for (int i = last; i > pos; i--) {
+        blobs[i] = blobs[i - 1];
+        orders[i] = orders[i - 1];
+    }
+    blobs[pos] = *blob;
+    orders[pos] = order;
+    if (count < EYES_MAX_BLOBS) lab->blob_count[c]++;
+}
 
-                free(stack_x);
-                free(stack_y);
+// Labels of the previous row that did not continue are finished (roots) or
+// merged away (non-roots); either way they go back on the free list
+inline void eyes_labeler_retire(EyesLabeler* lab, int c, uint16_t label, uint16_t alive) {
+    if (lab->stamp[c][label] == alive || lab->stamp[c][label] == alive + 1) return;
+    if (lab->parent[c][label] == label) {
+        eyes_labeler_emit(lab, c, &lab->stats[c][label], lab->order[c][label]);
+    }
+    lab->stamp[c][label] = alive + 1;  // Retired this row
+    lab->free_labels[c][lab->free_count[c]++] = label;
+}
 
-                if (current.pixel_count > largest.pixel_count) {
-                    largest = current;
+// Feeds the next row (all classes, class-interleaved as in the packed masks)
+inline void eyes_labeler_push_row(EyesLabeler* lab, const EyesMaskWord* row) {
+    int width = lab->width;
+    int words = eyes_mask_words(width);
+    int y = lab->row;
+    uint16_t alive = (uint16_t)(2 * (y + 1));
+    uint8_t prev = lab->cur;
+    uint8_t cur = prev ^ 1;
+
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        uint16_t* parent = lab->parent[c];
+        EyesBlobInfo* stats = lab->stats[c];
+        const EyesRun* above = lab->runs[prev][c];
+        int above_count = lab->run_count[prev][c];
+        EyesRun* runs = lab->runs[cur][c];
+        int n = eyes_extract_runs(row + c * words, width, runs);
+        int a = 0;
+        lab->new_count[c] = 0;
+
+        for (int i = 0; i < n; i++) {
+            EyesRun* run = &runs[i];
+            uint16_t label = EYES_NO_LABEL;
+
+            // Runs above are sorted; skip the ones that end before this starts
+            while (a < above_count && above[a].x1 < run->x0) a++;
+            for (int j = a; j < above_count && above[j].x0 <= run->x1; j++) {
+                uint16_t root = eyes_labeler_find(parent, above[j].label);
+                if (label == EYES_NO_LABEL) {
+                    label = root;
+                } else if (root != label) {
+                    // Two blobs meet: the one that started first stays root
+                    uint16_t keep = lab->order[c][root] < lab->order[c][label] ? root : label;
+                    uint16_t gone = (keep == root) ? label : root;
+                    parent[gone] = keep;
+                    eyes_blob_merge(&stats[keep], &stats[gone]);
+                    label = keep;
                 }
             }
+
+            if (label == EYES_NO_LABEL) {
+                label = lab->free_labels[c][--lab->free_count[c]];
+                lab->new_labels[c][lab->new_count[c]++] = label;
+                parent[label] = label;
+                lab->order[c][label] = (uint32_t)y * width + run->x0;
+                EyesBlobInfo fresh = {0, 0, 0, run->x0, run->x1, (int16_t)y, (int16_t)y};
+                stats[label] = fresh;
+            }
+            run->label = label;
+            eyes_blob_add_run(&stats[label], run->x0, run->x1, y);
         }
+        lab->run_count[cur][c] = n;
+
+        // Point this row's runs at their roots and mark those labels live
+        for (int i = 0; i < n; i++) {
+            runs[i].label = eyes_labeler_find(parent, runs[i].label);
+            lab->stamp[c][runs[i].label] = alive;
+        }
+        for (int j = 0; j < above_count; j++) eyes_labeler_retire(lab, c, above[j].label, alive);
+        for (int j = 0; j < lab->new_count[c]; j++) eyes_labeler_retire(lab, c, lab->new_labels[c][j], alive);
     }
+    lab->cur = cur;
+    lab->row++;
+}
 
-    free(visited);
-    return largest;
+// Empties the blob tables without a labeling pass (for frames with nothing in them)
+inline void eyes_labeler_clear_blobs(EyesLabeler* lab) {
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        lab->blob_count[c] = 0;
+        lab->blob_total[c] = 0;
+    }
 }
 
-// BLOB DETECTION - Find top N blobs sorted by size
-int eyes_find_top_n_blobs(uint8_t* mask, int width, int height, EyesBlobInfo* blobs, int max_blobs) {
-    bool* visited = (bool*)calloc(width * height, sizeof(bool));
-    if (!visited) return 0;
+// Finishes the blobs still open on the last row
+inline void eyes_labeler_finish(EyesLabeler* lab) {
+    uint16_t done = (uint16_t)(2 * (lab->row + 1));
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        const EyesRun* runs = lab->runs[lab->cur][c];
+        for (int i = 0; i < lab->run_count[lab->cur][c]; i++) {
+            eyes_labeler_retire(lab, c, runs[i].label, done);
+        }
+        lab->run_count[lab->cur][c] = 0;
+    }
+}
 
+// BLOB DETECTION - Largest blob of a class (first in raster order on ties)
+inline EyesBlobInfo eyes_find_largest_blob(const EyesLabeler* lab, int plane) {
+    EyesBlobInfo none = {0, 0, 0, 0, 0, 0, 0};
+    return lab->blob_count[plane] ? lab->blobs[plane][0] : none;
+}
+
+// BLOB DETECTION - Top N blobs of a class with at least min_area pixels,
+// largest first (raster order on ties). N up to EYES_MAX_BLOBS.
+inline int eyes_find_top_n_blobs(const EyesLabeler* lab, int plane, EyesBlobInfo* blobs, int max_blobs,
+                          int min_area = EYES_MIN_BLOB_AREA) {
     int num_blobs = 0;
+    for (int i = 0; i < lab->blob_count[plane] && num_blobs < max_blobs; i++) {
+        if (lab->blobs[plane][i].pixel_count < (uint32_t)min_area) break;
+        blobs[num_blobs++] = lab->blobs[plane][i];
+    }
+    return num_blobs;
+}
+
+// Bit w set: mask word w (columns 32w .. 32w+31) of a row is classified
+typedef uint32_t EyesTileMask;
+#define EYES_ALL_TILES ((EyesTileMask)0xFFFFFFFF)
+
+// COLOR FILTERING - one row (camera byte order) to a packed row, all
+// classes. Needs eyes_build_class_lut() (done by eyes_init()). Words not in
+// tiles are written as zero without reading the pixels. YUV422 looks the
+// chroma up once per pixel pair.
+inline void eyes_classify_row(const uint8_t* src, EyesMaskWord* row, int width, EyesTileMask tiles = EYES_ALL_TILES) {
+    int words = eyes_mask_words(width);
+
+    for (int w = 0; w < words; w++) {
+        EyesMaskWord bits[EYES_NUM_CLASSES] = {0};
+        if ((tiles >> w) & 1) {
+            int x0 = w * 32;
+            int n = min(32, width - x0);
+#if EYES_YUV422
+            for (int b = 0; b < n; b += 2) {
+                const uint8_t* pair = src + (x0 + b) * 2;
+                uint8_t chroma = eyes_u_lut[pair[1]] & eyes_v_lut[pair[3]];
+                uint8_t c0 = chroma & eyes_y_lut[pair[0]];
+                uint8_t c1 = chroma & eyes_y_lut[pair[2]];
+                for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+                    bits[c] |= (EyesMaskWord)(((c0 >> c) & 1) | (((c1 >> c) & 1) << 1)) << b;
+                }
+            }
+#else
+            for (int b = 0; b < n; b++) {
+                uint8_t classes = eyes_pixel_classes(src, x0 + b);
+                for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+                    bits[c] |= (EyesMaskWord)((classes >> c) & 1) << b;
+                }
+            }
+#endif
+        }
+        for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+            row[c * words + w] = bits[c];
+        }
+    }
+}
 
+// COLOR FILTERING - whole frame to packed class planes
+inline void eyes_classify_frame(const uint8_t* buf, EyesMaskWord* planes, int width, int height) {
+    int row_words = EYES_NUM_CLASSES * eyes_mask_words(width);
     for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int idx = y * width + x;
+        eyes_classify_row(buf + y * width * 2, planes + y * row_words, width);
+    }
+}
 
-            if (mask[idx] && !visited[idx]) {
-                EyesBlobInfo current = {0, 0, 0, width, 0, height, 0};
+// STREAMING PIPELINE - classify, close and label one row at a time
+// Closed row y needs classified rows up to y + 2r (radius-r dilate, then
+// radius-r erode), so the only mask state is two rings of 2r+1 rows:
+// horizontally dilated rows, and dilated-then-horizontally-eroded rows.
+// Each closed row goes straight to the labeler; no full-frame mask or
+// temp buffer exists, and the state grows with width, not frame area.
+// Bit-exact with eyes_classify_frame() + eyes_packed_close() + labeling.
+#define EYES_CLOSE_RADIUS (EYES_CLOSE_KERNEL / 2)
+#define EYES_RING_ROWS (2 * EYES_CLOSE_RADIUS + 1)
+
+static_assert(EYES_CLOSE_KERNEL >= 1 && EYES_CLOSE_KERNEL <= EYES_MAX_KERNEL,
+              "EYES_CLOSE_KERNEL must be between 1 and EYES_MAX_KERNEL");
+
+// COARSE-TO-FINE - a sparse pass first: every EYES_COARSE_STEP-th pixel of
+// every EYES_COARSE_STEP-th row goes through the class LUT. Tiles (one mask
+// word wide, EYES_TILE_ROWS tall) with a hit, grown by one tile each way,
+// are the only ones classified at full resolution; the rest of the frame
+// is treated as empty, and a frame with no hit skips the fine pass. Close
+// and labeling still run on full-resolution rows, so centroids are exact.
+// A target that fits between samples (under EYES_COARSE_STEP px across)
+// can be missed.
+#define EYES_COARSE_STEP 4
+#define EYES_TILE_ROWS 16
+#define EYES_TILE_GRID_ROWS ((EYES_IMG_HEIGHT + EYES_TILE_ROWS - 1) / EYES_TILE_ROWS)
+
+static_assert(EYES_MASK_WORDS <= 32, "EyesTileMask holds one bit per mask word");
+
+// Fills tiles[] (one mask per tile row) and returns how many tiles need the
+// fine pass
+inline int eyes_coarse_tiles(const uint8_t* buf, int width, int height, int stride, EyesTileMask* tiles) {
+    int grid_rows = (height + EYES_TILE_ROWS - 1) / EYES_TILE_ROWS;
+    EyesTileMask hits[EYES_TILE_GRID_ROWS] = {0};
+
+    for (int y = EYES_COARSE_STEP / 2; y < height; y += EYES_COARSE_STEP) {
+        const uint8_t* src = buf + y * stride;
+        EyesTileMask row_hits = 0;
+        for (int x = EYES_COARSE_STEP / 2; x < width; x += EYES_COARSE_STEP) {
+            if (eyes_pixel_classes(src, x)) {
+                row_hits |= (EyesTileMask)1 << (x >> 5);
+            }
+        }
+        hits[y / EYES_TILE_ROWS] |= row_hits;
+    }
 
-                int* stack_x = (int*)malloc(4000 * sizeof(int));
-                int* stack_y = (int*)malloc(4000 * sizeof(int));
+    // Grow by one tile each way: blob fringes the samples missed, and the
+    // close's reach across tile borders
+    int words = eyes_mask_words(width);
+    EyesTileMask valid = words >= 32 ? EYES_ALL_TILES : (((EyesTileMask)1 << words) - 1);
+    int count = 0;
+    for (int t = 0; t < grid_rows; t++) {
+        EyesTileMask m = hits[t];
+        if (t > 0) m |= hits[t - 1];
+        if (t + 1 < grid_rows) m |= hits[t + 1];
+        m = (m | (m << 1) | (m >> 1)) & valid;
+        tiles[t] = m;
+        count += __builtin_popcount(m);
+    }
+    return count;
+}
 
-                if (!stack_x || !stack_y) {
-                    if (stack_x) free(stack_x);
-                    if (stack_y) free(stack_y);
-                    continue;
-                }
+typedef struct {
+    EyesMaskWord dilated[EYES_RING_ROWS][EYES_MASK_ROW_WORDS];
+    EyesMaskWord eroded[EYES_RING_ROWS][EYES_MASK_ROW_WORDS];
+    EyesMaskWord row[EYES_MASK_ROW_WORDS];
+    EyesTileMask tiles[EYES_TILE_GRID_ROWS];  // Coarse pass output
+} EyesStream;
+
+// Vertical window over a ring: rows max(0, y-r) .. min(height-1, y+r)
+template <bool Erode>
+inline void eyes_ring_combine(EyesMaskWord ring[][EYES_MASK_ROW_WORDS], int y, int height, int r,
+                              int row_words, EyesMaskWord* out) {
+    int y0 = max(0, y - r);
+    int y1 = min(height - 1, y + r);
+    memcpy(out, ring[y0 % EYES_RING_ROWS], row_words * sizeof(EyesMaskWord));
+    for (int yy = y0 + 1; yy <= y1; yy++) {
+        const EyesMaskWord* src = ring[yy % EYES_RING_ROWS];
+        for (int i = 0; i < row_words; i++) {
+            out[i] = Erode ? (out[i] & src[i]) : (out[i] | src[i]);
+        }
+    }
+}
 
-                int stack_size = 0;
-                stack_x[0] = x;
-                stack_y[0] = y;
-                stack_size = 1;
-
-                while (stack_size > 0) {
-                    int cx = stack_x[--stack_size];
-                    int cy = stack_y[stack_size];
-                    int cidx = cy * width + cx;
-
-                    if (cx < 0 || cx >= width || cy < 0 || cy >= height) continue;
-                    if (visited[cidx] || !mask[cidx]) continue;
-
-                    visited[cidx] = true;
-                    current.x_sum += cx;
-                    current.y_sum += cy;
-                    current.pixel_count++;
-
-                    current.x_min = min(current.x_min, (int16_t)cx);
-                    current.x_max = max(current.x_max, (int16_t)cx);
-                    current.y_min = min(current.y_min, (int16_t)cy);
-                    current.y_max = max(current.y_max, (int16_t)cy);
-
-                    if (stack_size < 3996) {
-                        stack_x[stack_size] = cx + 1; stack_y[stack_size++] = cy;
-                        stack_x[stack_size] = cx - 1; stack_y[stack_size++] = cy;
-                        stack_x[stack_size] = cx; stack_y[stack_size++] = cy + 1;
-                        stack_x[stack_size] = cx; stack_y[stack_size++] = cy - 1;
-                    }
-                }
+// Runs the whole frame through st and lab (closed with EYES_CLOSE_KERNEL).
+// width must not exceed EYES_IMG_WIDTH; any height works. stride is the
+// source row pitch in bytes (0 = width * 2), so a column window of a wider
+// frame can be streamed in place. tiles (from eyes_coarse_tiles()) limits
+// classification to those tiles; NULL classifies everything. prof, if
+// given, gets the sampled rows' classify / morph / label laps; the caller
+// times the whole call and passes that to EYES_PROF_ROWS_END().
+inline void eyes_stream_frame(EyesStream* st, EyesLabeler* lab, const uint8_t* buf, int width, int height,
+                       int stride = 0, const EyesTileMask* tiles = NULL, EyesProfiler* prof = NULL) {
+    const int r = EYES_CLOSE_RADIUS;
+    int row_words = EYES_NUM_CLASSES * eyes_mask_words(width);
+    if (stride == 0) stride = width * 2;
+
+    EYES_PROF_ROWS_START(prof);
+    eyes_labeler_reset(lab, width);
+    for (int y_in = 0; y_in < height + 2 * r; y_in++) {
+        EYES_PROF_ROW(prof, y_in);
+
+        // Classify and horizontally dilate the newest row
+        if (y_in < height) {
+            eyes_classify_row(buf + y_in * stride, st->row, width,
+                              tiles ? tiles[y_in / EYES_TILE_ROWS] : EYES_ALL_TILES);
+            EYES_PROF_ROW_LAP(prof, EYES_PROF_CLASSIFY);
+            eyes_packed_hmorph_row<false>(st->row, st->dilated[y_in % EYES_RING_ROWS], width, r);
+        }
 
-                free(stack_x);
-                free(stack_y);
-
-                if (current.pixel_count >= EYES_MIN_BLOB_AREA) {
-                    // Insert into sorted list (largest first)
-                    int insert_pos = num_blobs;
-                    for (int i = 0; i < num_blobs; i++) {
-                        if (current.pixel_count > blobs[i].pixel_count) {
-                            insert_pos = i;
-                            break;
-                        }
-                    }
-                    // Shift blobs down
-                    if (insert_pos < max_blobs) {
-                        for (int i = min(num_blobs, max_blobs - 1); i > insert_pos; i--) {
-                            blobs[i] = blobs[i - 1];
-                        }
-                        blobs[insert_pos] = current;
-                        if (num_blobs < max_blobs) num_blobs++;
-                    }
-                }
-            }
+        // Finish the dilate r rows back, then horizontally erode it
+        int yd = y_in - r;
+        if (yd >= 0 && yd < height) {
+            eyes_ring_combine<false>(st->dilated, yd, height, r, row_words, st->row);
+            eyes_packed_hmorph_row<true>(st->row, st->eroded[yd % EYES_RING_ROWS], width, r);
+        }
+
+        // Finish the erode 2r rows back and label the closed row
+        int ye = y_in - 2 * r;
+        if (ye >= 0) eyes_ring_combine<true>(st->eroded, ye, height, r, row_words, st->row);
+        EYES_PROF_ROW_LAP(prof, EYES_PROF_MORPH);
+        if (ye >= 0) {
+            eyes_labeler_push_row(lab, st->row);
+            EYES_PROF_ROW_LAP(prof, EYES_PROF_LABEL);
         }
     }
+    eyes_labeler_finish(lab);
+}
 
-    free(visited);
-    return num_blobs;
+// ROI TRACKING - once the pillar is found, only a column window around its
+// last bounding box is processed (the pillar spans most of the frame height,
+// so rows are not cropped). The margin doubles on every miss; after
+// EYES_TRACK_MAX_MISSES misses the lock is dropped and full frames resume.
+// Every EYES_TRACK_REFRESH frames one full frame still runs so pink
+// obstacles outside the window are seen. Pink is only reported inside the
+// window on windowed frames.
+#define EYES_TRACK_TARGET EYES_PLANE_YELLOW
+#define EYES_TRACK_MARGIN (16 * EYES_PX_SCALE)  // Pixels either side of the last yellow bounding box
+#define EYES_TRACK_MAX_MISSES 3   // Misses tolerated before going back to full frames
+#define EYES_TRACK_REFRESH 8      // Full frame at least every Nth frame
+
+typedef struct {
+    volatile bool enabled;   // Set from the loop, read by whoever processes
+    uint8_t misses;          // Consecutive frames without yellow
+    uint8_t since_full;      // Frames since the last full frame
+    int16_t x_min, x_max;    // Last yellow bounding box, full-frame columns
+} EyesTrack;
+
+#define EYES_TRACK_INIT {false, EYES_TRACK_MAX_MISSES + 1, 0, 0, 0}  // Off, no lock
+
+// Columns to process this frame: [*x0, *x1)
+inline void eyes_track_window(const EyesTrack* t, int* x0, int* x1) {
+    *x0 = 0;
+    *x1 = EYES_IMG_WIDTH;
+    if (!t->enabled || t->misses > EYES_TRACK_MAX_MISSES) return;  // No lock
+    if (t->since_full + 1 >= EYES_TRACK_REFRESH) return;           // Refresh due
+
+    int margin = EYES_TRACK_MARGIN << t->misses;
+    *x0 = max(0, t->x_min - margin);
+    *x1 = min(EYES_IMG_WIDTH, t->x_max + 1 + margin);
+#if EYES_YUV422
+    *x0 &= ~1;  // Whole pixel pairs
+    *x1 = min(EYES_IMG_WIDTH, (*x1 + 1) & ~1);
+#endif
 }
 
-//Process camera frame and detect blobs
-void eyes_process_frame(camera_fb_t *fb) {
-    uint32_t start = millis();
+// yellow is the tracked target's largest detection, NULL if not found
+inline void eyes_track_update(EyesTrack* t, bool full_frame, const EyesDetection* yellow) {
+    t->since_full = full_frame ? 0 : t->since_full + 1;
+    if (yellow) {
+        t->misses = 0;
+        t->x_min = yellow->x_min;
+        t->x_max = yellow->x_max;
+    } else if (t->misses <= EYES_TRACK_MAX_MISSES) {
+        t->misses++;
+    }
+}
 
-    // Allocate masks
-    uint8_t* yellow_mask = (uint8_t*)calloc(EYES_IMG_WIDTH * EYES_IMG_HEIGHT, sizeof(uint8_t));
-    uint8_t* pink_mask = (uint8_t*)calloc(EYES_IMG_WIDTH * EYES_IMG_HEIGHT, sizeof(uint8_t));
+// Moves a blob from window columns to frame columns
+inline void eyes_blob_shift_x(EyesBlobInfo* blob, int dx) {
+    blob->x_sum += dx * (int32_t)blob->pixel_count;
+    blob->x_min += dx;
+    blob->x_max += dx;
+}
 
-    if (!yellow_mask || !pink_mask) {
-        Serial.println("ERROR: Memory allocation failed in eyes_process_frame!");
-        if (yellow_mask) free(yellow_mask);
-        if (pink_mask) free(pink_mask);
-        return;
+#define EYES_CANDIDATE_BLOBS 5  // Largest blobs per target considered for reporting
+
+// WORKING MEMORY - everything EyesPipeline::process() needs, carved out of
+// one arena inside the pipeline by init(). The size follows from
+// EYES_IMG_WIDTH / EYES_IMG_HEIGHT / EYES_CLOSE_KERNEL at compile time, so
+// a frame never touches the heap, cannot fail to allocate and cannot
+// fragment it.
+#define EYES_ARENA_ALIGN 8
+#define EYES_ARENA_ALIGNED(n) (((n) + EYES_ARENA_ALIGN - 1) / EYES_ARENA_ALIGN * EYES_ARENA_ALIGN)
+#define EYES_ARENA_SIZE (EYES_ARENA_ALIGNED(sizeof(EyesStream)) + EYES_ARENA_ALIGNED(sizeof(EyesLabeler)))
+// Internal SRAM the pipeline may use. The labeler grows with the width, so
+// VGA (about 50 KB) gets twice the budget of the smaller sizes.
+#define EYES_ARENA_BUDGET ((EYES_FRAMESIZE == EYES_VGA ? 64 : 32) * 1024)
+
+static_assert(EYES_ARENA_SIZE <= EYES_ARENA_BUDGET,
+              "Eyes working memory for this frame size exceeds EYES_ARENA_BUDGET");
+
+typedef struct {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+} EyesArena;
+
+inline void* eyes_arena_alloc(EyesArena* arena, size_t bytes) {
+    size_t need = EYES_ARENA_ALIGNED(bytes);
+    if (arena->used + need > arena->size) return NULL;
+    void* p = arena->base + arena->used;
+    arena->used += need;
+    return p;
+}
+
+typedef struct {
+    EyesStream* stream;
+    EyesLabeler* labeler;
+} EyesWorkspace;
+
+inline uint16_t eyes_clamp_us(uint32_t us) {
+    return us > 0xFFFF ? 0xFFFF : (uint16_t)us;
+}
+
+// Clears detections so a failed frame never leaves the previous frame's
+// targets behind
+inline void eyes_clear_detections(EyesResult* res) {
+    memset(res->count, 0, sizeof(res->count));
+    memset(res->blobs, 0, sizeof(res->blobs));
+    memset(res->stage_us, 0, sizeof(res->stage_us));
+    res->roi_x_min = 0;
+    res->roi_x_max = EYES_IMG_WIDTH - 1;
+}
+
+// PIPELINE - one detector: its settings (ROI tracking, coarse-to-fine),
+// working memory, tracking state, profile and latest result. The eyes_*
+// functions drive a default instance, eyes_pipeline. Instances share
+// nothing writable, so several can process frames at once, each on one
+// thread at a time; the class LUT they all read is built by the first
+// init(), so make that call before the others start. Each instance holds
+// its arena inline (EYES_ARENA_SIZE bytes), so it is not copyable.
+class EyesPipeline {
+public:
+    EyesPipeline() {}
+    EyesPipeline(const EyesPipeline&) = delete;
+    EyesPipeline& operator=(const EyesPipeline&) = delete;
+
+    // Resets the result, the frame count, the tracking lock and the profile
+    // (settings are kept), and carves the working memory
+    bool init() {
+        if (!eyes_class_lut_built) eyes_build_class_lut();
+        result_ = EyesResult();
+        result_.roi_x_max = EYES_IMG_WIDTH - 1;
+        track_.misses = EYES_TRACK_MAX_MISSES + 1;
+        track_.since_full = 0;
+        profile_reset();
+
+        arena_.used = 0;
+        work_.stream = (EyesStream*)eyes_arena_alloc(&arena_, sizeof(EyesStream));
+        work_.labeler = (EyesLabeler*)eyes_arena_alloc(&arena_, sizeof(EyesLabeler));
+        return work_.stream != NULL && work_.labeler != NULL;
     }
 
-    // Color filtering (with wrap-around support)
-    for (int i = 0; i < EYES_IMG_WIDTH * EYES_IMG_HEIGHT; i++) {
-        uint16_t pixel = ((uint16_t)fb->buf[i*2] << 8) | fb->buf[i*2+1];
+    bool ready() const { return work_.labeler != NULL; }
+    size_t working_bytes() const { return arena_.used; }
 
-        //RGB888
-        uint8_t r5 = (pixel >> 11) & 0x1F;
-        uint8_t g6 = (pixel >> 5) & 0x3F;
-        uint8_t b5 = pixel & 0x1F;
+    // Detects every target in fb (EYES_IMG_WIDTH x EYES_IMG_HEIGHT) into res.
+    // Continues res's frame count and steps the tracking lock.
+    void process(const camera_fb_t* fb, EyesResult* res);
+    void process(const camera_fb_t* fb) { process(fb, &result_); }
 
-        uint8_t r = (r5 << 3) | (r5 >> 2);  // Fill lower bits
-        uint8_t g = (g6 << 2) | (g6 >> 4);
-        uint8_t b = (b5 << 3) | (b5 >> 2);
+    EyesResult& result() { return result_; }
+    const EyesResult& result() const { return result_; }
 
-        uint8_t h, s, v;
-        eyes_rgb_to_hsv(r, g, b, &h, &s, &v);
+    // ROI tracking on or off. Off (the default) processes every frame in full.
+    void set_tracking(bool enabled) { track_.enabled = enabled; }
+    bool tracking() const { return track_.enabled; }
 
-        yellow_mask[i] = eyes_in_hsv_range(h, s, v, EYES_YELLOW_RANGE) ? 255 : 0;
-        pink_mask[i] = eyes_in_hsv_range(h, s, v, EYES_PINK_RANGE) ? 255 : 0;
+    // Coarse pass on (default) or off (every pixel classified)
+    void set_coarse_to_fine(bool enabled) { coarse_ = enabled; }
+    bool coarse_to_fine() const { return coarse_; }
+
+    // NULL if profiling is compiled out
+    EyesProfiler* profiler() {
+#if EYES_PROFILE
+        return &prof_;
+#else
+        return NULL;
+#endif
     }
 
-    //Connect nearby clusters
-    eyes_morphological_close(yellow_mask, EYES_IMG_WIDTH, EYES_IMG_HEIGHT, 3);
-    eyes_morphological_close(pink_mask, EYES_IMG_WIDTH, EYES_IMG_HEIGHT, 3);
+    void profile_reset() {
+#if EYES_PROFILE
+        memset(&prof_, 0, sizeof(prof_));
+#endif
+    }
 
-    //Reset result
-    eyes_result.yellow_found = 0;
-    eyes_result.pink_count = 0;
+private:
+    uint8_t memory_[EYES_ARENA_SIZE] __attribute__((aligned(EYES_ARENA_ALIGN)));
+    EyesArena arena_ = {memory_, EYES_ARENA_SIZE, 0};
+    EyesWorkspace work_ = {NULL, NULL};
+    EyesTrack track_ = EYES_TRACK_INIT;
+    bool coarse_ = true;
+    EyesResult result_ = EyesResult();
+#if EYES_PROFILE
+    EyesProfiler prof_ = EyesProfiler();
+#endif
+};
+
+// Process camera frame and detect blobs
+inline void EyesPipeline::process(const camera_fb_t* fb, EyesResult* res) {
+    uint32_t start = millis();
+
+    if (!work_.labeler) {
+        Serial.println("Eyes: ERROR - EyesPipeline::process() before init()!");
+        eyes_clear_detections(res);
+        return;
+    }
+    EyesLabeler* labeler = work_.labeler;
+
+    // Column window: the full frame unless tracking has a lock
+    int x0, x1;
+    eyes_track_window(&track_, &x0, &x1);
+    bool full_frame = (x0 == 0 && x1 == EYES_IMG_WIDTH);
+
+    // Stage boundaries on the cycle counter: stage_us and the profile
+    // both come from these four reads
+    uint32_t t_coarse = ESP.getCycleCount();
+
+    // Coarse pass: which tiles of the window need full resolution
+    const uint8_t* window = fb->buf + x0 * 2;
+    EyesStream* stream = work_.stream;
+    int fine_tiles = -1;
+    if (coarse_) {
+        fine_tiles = eyes_coarse_tiles(window, x1 - x0, EYES_IMG_HEIGHT, EYES_IMG_WIDTH * 2, stream->tiles);
+    }
 
-    // Detect largest yellow blob 
-    EyesBlobInfo yellow_blob = eyes_find_largest_blob(yellow_mask, EYES_IMG_WIDTH, EYES_IMG_HEIGHT);
-    if (yellow_blob.pixel_count >= EYES_MIN_BLOB_AREA) {
-        eyes_result.yellow_found = 1;
-        eyes_result.yellow_area = yellow_blob.pixel_count;
-        int16_t centroid_x = yellow_blob.x_sum / yellow_blob.pixel_count;
-        eyes_result.yellow_offset_x = centroid_x - (EYES_IMG_WIDTH / 2);
+    uint32_t t_detect = ESP.getCycleCount();
+
+    // Color filtering, close (yellow and pink together) and labeling, row by row
+    if (fine_tiles == 0) {
+        eyes_labeler_clear_blobs(labeler);  // Nothing anywhere: skip the fine pass
     } else {
-        eyes_result.yellow_offset_x = 0;
-        eyes_result.yellow_area = 0;
-    }
-
-    // Detect up to 5 pink blobs to allow for filtering
-    EyesBlobInfo raw_pink_blobs[5];
-    int num_raw = eyes_find_top_n_blobs(pink_mask, EYES_IMG_WIDTH, EYES_IMG_HEIGHT, raw_pink_blobs, 5);
-
-    int valid_pink = 0;
-    for (int i = 0; i < num_raw && valid_pink < 2; i++) {
-        int16_t cx = raw_pink_blobs[i].x_sum / raw_pink_blobs[i].pixel_count;
-        
-        // Check distance against already added blobs
-        bool distinct = true;
-        for (int j = 0; j < valid_pink; j++) {
-            int16_t existing_cx = eyes_result.pink_offset_x[j] + (EYES_IMG_WIDTH / 2);
-            if (abs(cx - existing_cx) < 20) { // 20 pixel minimum separation
-                distinct = false;
-                break;
+        eyes_stream_frame(stream, labeler, window, x1 - x0, EYES_IMG_HEIGHT, EYES_IMG_WIDTH * 2,
+                          fine_tiles > 0 ? stream->tiles : NULL, profiler());
+    }
+
+    uint32_t t_report = ESP.getCycleCount();
+
+    // Report each target's largest blobs, skipping any too close to one
+    // already reported
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        const EyesTarget& target = EYES_TARGETS[c];
+        EyesBlobInfo candidates[EYES_CANDIDATE_BLOBS];
+        int num_raw = eyes_find_top_n_blobs(labeler, c, candidates, EYES_CANDIDATE_BLOBS, target.min_area);
+
+        int found = 0;
+        for (int i = 0; i < num_raw && found < target.max_blobs; i++) {
+            EyesBlobInfo* blob = &candidates[i];
+            eyes_blob_shift_x(blob, x0);
+            int16_t cx = blob->x_sum / (int32_t)blob->pixel_count;
+
+            bool distinct = true;
+            for (int j = 0; j < found; j++) {
+                int16_t existing_cx = res->blobs[c][j].offset_x + (EYES_IMG_WIDTH / 2);
+                if (abs(cx - existing_cx) < target.min_separation) {
+                    distinct = false;
+                    break;
+                }
+            }
+
+            if (distinct) {
+                EyesDetection* d = &res->blobs[c][found++];
+                d->offset_x = cx - (EYES_IMG_WIDTH / 2);
+                d->centroid_y = blob->y_sum / (int32_t)blob->pixel_count;
+                d->area = blob->pixel_count;
+                d->x_min = blob->x_min;
+                d->x_max = blob->x_max;
+                d->y_min = blob->y_min;
+                d->y_max = blob->y_max;
             }
         }
-        
-        if (distinct) {
-            eyes_result.pink_area[valid_pink] = raw_pink_blobs[i].pixel_count;
-            eyes_result.pink_offset_x[valid_pink] = cx - (EYES_IMG_WIDTH / 2);
-            valid_pink++;
+        res->count[c] = found;
+        // Clear unused slots
+        for (int i = found; i < EYES_MAX_DETECTIONS; i++) {
+            res->blobs[c][i] = EyesDetection();
         }
     }
-    eyes_result.pink_count = valid_pink;
-    // Clear unused pink slots
-    for (int i = valid_pink; i < 2; i++) {
-        eyes_result.pink_offset_x[i] = 0;
-        eyes_result.pink_area[i] = 0;
-    }
 
-    free(yellow_mask);
-    free(pink_mask);
+    const EyesDetection* tracked = res->count[EYES_TRACK_TARGET] ? &res->blobs[EYES_TRACK_TARGET][0] : NULL;
+    eyes_track_update(&track_, full_frame, tracked);
+    uint32_t t_end = ESP.getCycleCount();
+
+    EYES_PROF_ADD(&prof_, EYES_PROF_CLASSIFY, t_detect - t_coarse);
+    EYES_PROF_ROWS_END(&prof_, t_report - t_detect);
+    EYES_PROF_ADD(&prof_, EYES_PROF_FILTER, t_end - t_report);
+    EYES_PROF_COMMIT(&prof_);
+
+    res->roi_x_min = x0;
+    res->roi_x_max = x1 - 1;
+    res->frame_number++;
+    res->capture_us = fb->timestamp.tv_sec * 1000000UL + fb->timestamp.tv_usec;
+    res->process_time_ms = millis() - start;
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    res->stage_us[EYES_STAGE_COARSE] = eyes_clamp_us((t_detect - t_coarse) / mhz);
+    res->stage_us[EYES_STAGE_DETECT] = eyes_clamp_us((t_report - t_detect) / mhz);
+    res->stage_us[EYES_STAGE_REPORT] = eyes_clamp_us((t_end - t_report) / mhz);
+}
+
+// DEFAULT INSTANCE - what eyes_init(), eyes_snap() and the getters use.
+// Static, like every other buffer here, so the robot never allocates it.
+inline EyesPipeline eyes_pipeline;
+
+//Process camera frame and detect blobs
+inline void eyes_process_frame(camera_fb_t *fb) {
+    eyes_pipeline.process(fb);
+}
+
+inline void eyes_set_tracking(bool enabled) {
+    eyes_pipeline.set_tracking(enabled);
+}
 
-    eyes_result.frame_number++;
-    eyes_result.process_time_ms = millis() - start;
+inline bool eyes_get_tracking() {
+    return eyes_pipeline.tracking();
+}
+
+inline void eyes_set_coarse_to_fine(bool enabled) {
+    eyes_pipeline.set_coarse_to_fine(enabled);
+}
+
+// --- GETTER FUNCTIONS ---
+
+// Detections of any target (index into EYES_TARGETS)
+inline uint8_t eyes_get_count(uint8_t target) {
+    if (target >= EYES_NUM_CLASSES) return 0;
+    return eyes_pipeline.result().count[target];
+}
+
+// NULL past the last detection
+inline const EyesDetection* eyes_get_detection(uint8_t target, uint8_t index) {
+    if (index >= eyes_get_count(target)) return NULL;
+    return &eyes_pipeline.result().blobs[target][index];
+}
+
+inline int16_t eyes_get_offset_x(uint8_t target, uint8_t index) {
+    const EyesDetection* d = eyes_get_detection(target, index);
+    return d ? d->offset_x : 0;
+}
+
+inline uint32_t eyes_get_area(uint8_t target, uint8_t index) {
+    const EyesDetection* d = eyes_get_detection(target, index);
+    return d ? d->area : 0;
+}
+
+inline bool eyes_get_yellow_found() {
+    return eyes_get_count(EYES_PLANE_YELLOW) != 0;
+}
+
+inline int16_t eyes_get_yellow_offset_x() {
+    return eyes_get_offset_x(EYES_PLANE_YELLOW, 0);
+}
+
+inline uint32_t eyes_get_yellow_area() {
+    return eyes_get_area(EYES_PLANE_YELLOW, 0);
+}
+
+inline uint8_t eyes_get_pink_count() {
+    return eyes_get_count(EYES_PLANE_PINK);
+}
+
+inline int16_t eyes_get_pink_offset_x(uint8_t index) {
+    return eyes_get_offset_x(EYES_PLANE_PINK, index);
+}
+
+inline uint32_t eyes_get_pink_area(uint8_t index) {
+    return eyes_get_area(EYES_PLANE_PINK, index);
+}
+
+inline camera_fb_t* eyes_get_framebuffer() {
+    return eyes_pipeline.result().framebuffer;
+}
+
+inline uint32_t eyes_get_frame_number() {
+    return eyes_pipeline.result().frame_number;
+}
+
+inline uint32_t eyes_get_process_time_ms() {
+    return eyes_pipeline.result().process_time_ms;
+}
+
+inline uint32_t eyes_get_frame_timestamp_us() {
+    return eyes_pipeline.result().capture_us;
+}
+
+inline uint16_t eyes_get_stage_us(uint8_t stage) {
+    if (stage >= EYES_NUM_STAGES) return 0;
+    return eyes_pipeline.result().stage_us[stage];
+}
+
+// True if the last frame was processed in full (not an ROI tracking window)
+inline bool eyes_get_full_frame() {
+    const EyesResult& r = eyes_pipeline.result();
+    return r.roi_x_min == 0 && r.roi_x_max == EYES_IMG_WIDTH - 1;
+}
+
+// One EYES_PROF_ stage, NULL if profiling is compiled out. In async mode
+// the vision task writes these while the loop reads them, so a read can
+// mix two frames.
+inline const EyesProfStage* eyes_get_profile(uint8_t stage) {
+    EyesProfiler* prof = eyes_pipeline.profiler();
+    if (!prof || stage >= EYES_PROF_STAGES) return NULL;
+    return &prof->stages[stage];
+}
+
+// Percentile (0-100) of a stage over its last EYES_PROF_RING frames, in us
+inline uint32_t eyes_get_profile_percentile(uint8_t stage, uint8_t pct) {
+    return eyes_prof_percentile(eyes_get_profile(stage), pct);
+}
+
+inline void eyes_profile_reset() {
+    eyes_pipeline.profile_reset();
+}
+
+// Prints every stage: mean, p50/p99 of the ring, max, then the histogram
+// buckets in use ("16:120" = 120 frames took 16-31 us)
+inline void eyes_profile_dump() {
+    eyes_prof_print(eyes_pipeline.profiler());
 }
 
 // CAMERA INITIALIZATION
-bool eyes_init_camera() {
+inline bool eyes_init_camera() {
     // Check PSRAM
     if (!psramFound()) {
         Serial.println("Eyes: ERROR - PSRAM not found! Camera requires PSRAM.");
@@ -532,11 +1702,11 @@ bool eyes_init_camera() {
     config.pin_pwdn = EYES_PWDN_GPIO_NUM;
     config.pin_reset = EYES_RESET_GPIO_NUM;
     config.xclk_freq_hz = 20000000;  // Standard 20MHz for OV3660
-    config.pixel_format = PIXFORMAT_RGB565;
-    config.frame_size = FRAMESIZE_QQVGA;
+    config.pixel_format = EYES_YUV422 ? PIXFORMAT_YUV422 : PIXFORMAT_RGB565;
+    config.frame_size = EYES_CAMERA_FRAMESIZE;
     config.jpeg_quality = 12;
     config.fb_count = 2;
-    config.grab_mode = CAMERA_GRAB_WHEN_EMPTY; // Wait for frame to be ready
+    config.grab_mode = CAMERA_GRAB_LATEST; // Recycle stale frames so every grab is the newest one
     config.fb_location = CAMERA_FB_IN_PSRAM;
 
     esp_err_t err = esp_camera_init(&config);
@@ -566,60 +1736,205 @@ bool eyes_init_camera() {
     s->set_whitebal(s, 1);
     s->set_awb_gain(s, 1);
 
-    Serial.println("Eyes: Camera configured for blob detection");
+    Serial.printf("Eyes: Camera configured for blob detection, %dx%d\n", EYES_IMG_WIDTH, EYES_IMG_HEIGHT);
     return true;
 }
 
 //Initialize library
-bool eyes_init() {
-    eyes_result = {0};
-
+inline bool eyes_init() {
     Serial.println("Eyes: Initializing vision library...");
 
+    uint32_t lut_start = millis();
+    eyes_build_class_lut();
+    Serial.printf("Eyes: Class LUT built in %u ms\n", millis() - lut_start);
+
+    if (!eyes_pipeline.init()) {
+        Serial.println("Eyes: FATAL - Working memory arena too small!");
+        return false;
+    }
+    Serial.printf("Eyes: Working memory %u of %u bytes (static arena)\n",
+                  (unsigned)eyes_pipeline.working_bytes(), (unsigned)EYES_ARENA_SIZE);
+
     if (!eyes_init_camera()) {
         Serial.println("Eyes: FATAL - Camera initialization failed!");
         return false;
     }
 
-    Serial.printf("Eyes: Yellow HSV: H=%d-%d S=%d-%d V=%d-%d%s\n",
-                  EYES_YELLOW_RANGE.h_min, EYES_YELLOW_RANGE.h_max,
-                  EYES_YELLOW_RANGE.s_min, EYES_YELLOW_RANGE.s_max,
-                  EYES_YELLOW_RANGE.v_min, EYES_YELLOW_RANGE.v_max,
-                  EYES_YELLOW_RANGE.wraps_around() ? " [WRAP]" : "");
-    Serial.printf("Eyes: Pink HSV: H=%d-%d S=%d-%d V=%d-%d%s\n",
-                  EYES_PINK_RANGE.h_min, EYES_PINK_RANGE.h_max,
-                  EYES_PINK_RANGE.s_min, EYES_PINK_RANGE.s_max,
-                  EYES_PINK_RANGE.v_min, EYES_PINK_RANGE.v_max,
-                  EYES_PINK_RANGE.wraps_around() ? " [WRAP]" : "");
-    Serial.printf("Eyes: Min blob area: %d pixels\n", EYES_MIN_BLOB_AREA);
+    for (const EyesTarget& t : EYES_TARGETS) {
+#if EYES_YUV422
+        Serial.printf("Eyes: %s YUV: Y=%d-%d U=%d-%d V=%d-%d, up to %d blob(s) of %d+ pixels\n",
+                      t.name, t.uv.y_min, t.uv.y_max, t.uv.u_min, t.uv.u_max, t.uv.v_min, t.uv.v_max,
+                      t.max_blobs, t.min_area);
+#else
+        Serial.printf("Eyes: %s HSV: H=%d-%d S=%d-%d V=%d-%d%s, up to %d blob(s) of %d+ pixels\n",
+                      t.name, t.range.h_min, t.range.h_max, t.range.s_min, t.range.s_max,
+                      t.range.v_min, t.range.v_max, t.range.wraps_around() ? " [WRAP]" : "",
+                      t.max_blobs, t.min_area);
+#endif
+    }
     Serial.println("Eyes: Ready!");
 
     return true;
 }
 
+//Release frame buffer
+inline void eyes_release() {
+    EyesResult& r = eyes_pipeline.result();
+    if (r.framebuffer != NULL) {
+        esp_camera_fb_return(r.framebuffer);
+        r.framebuffer = NULL;
+    }
+}
+
+// ASYNC CAPTURE - eyes_start_async() moves capture and processing onto a
+// vision task pinned to the other core (Arduino's loop() runs on core 1).
+// While it runs the camera fills one buffer as the task processes the
+// other, and the loop only copies out the newest finished result.
+// Async results carry no framebuffer: the task returns it right away.
+#define EYES_TASK_CORE 0
+#define EYES_TASK_PRIORITY 2
+#define EYES_TASK_STACK 4096        // Bytes
+#define EYES_ASYNC_TIMEOUT_MS 1000  // eyes_snap() gives up waiting after this
+
+inline SemaphoreHandle_t eyes_async_lock = NULL;   // Guards eyes_async_result
+inline SemaphoreHandle_t eyes_async_ready = NULL;  // Given on every published frame
+inline SemaphoreHandle_t eyes_async_done = NULL;   // Given when the task exits
+inline EyesResult eyes_async_result = {0};         // Newest finished frame
+inline volatile bool eyes_async_running = false;
+
+inline void eyes_vision_task(void* arg) {
+    EyesResult working = eyes_async_result;  // Continue the frame count
+
+    while (eyes_async_running) {
+        uint32_t t_capture = micros();
+        camera_fb_t* fb = esp_camera_fb_get();
+        uint32_t wait_us = micros() - t_capture;
+        uint16_t capture_us = eyes_clamp_us(wait_us);
+        EYES_PROF_SAMPLE(eyes_pipeline.profiler(), EYES_PROF_CAPTURE, wait_us);
+        if (fb) {
+            eyes_pipeline.process(fb, &working);
+            working.stage_us[EYES_STAGE_CAPTURE] = capture_us;
+            esp_camera_fb_return(fb);
+        } else {
+            Serial.println("Eyes: ERROR - Failed to capture frame!");
+            eyes_clear_detections(&working);
+            working.frame_number++;
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        working.framebuffer = NULL;
+
+        xSemaphoreTake(eyes_async_lock, portMAX_DELAY);
+        eyes_async_result = working;
+        xSemaphoreGive(eyes_async_lock);
+        xSemaphoreGive(eyes_async_ready);
+    }
+
+    xSemaphoreGive(eyes_async_done);
+    vTaskDelete(NULL);
+}
+
+// Copies the published result into the getters if it is newer than theirs
+inline bool eyes_async_take() {
+    bool fresh = false;
+    xSemaphoreTake(eyes_async_lock, portMAX_DELAY);
+    if (eyes_async_result.frame_number != eyes_pipeline.result().frame_number) {
+        eyes_pipeline.result() = eyes_async_result;
+        fresh = true;
+    }
+    xSemaphoreGive(eyes_async_lock);
+    return fresh;
+}
+
+inline bool eyes_async_active() {
+    return eyes_async_running;
+}
+
+// Starts the vision task. Call after eyes_init(); holding a frame from
+// eyes_snap() across this call is not allowed.
+inline bool eyes_start_async() {
+    if (eyes_async_running) return true;
+    if (!eyes_pipeline.ready()) {
+        Serial.println("Eyes: ERROR - eyes_start_async() before eyes_init()!");
+        return false;
+    }
+    if (!eyes_async_lock) {
+        eyes_async_lock = xSemaphoreCreateMutex();
+        eyes_async_ready = xSemaphoreCreateBinary();
+        eyes_async_done = xSemaphoreCreateBinary();
+        if (!eyes_async_lock || !eyes_async_ready || !eyes_async_done) {
+            Serial.println("Eyes: ERROR - Failed to create vision task semaphores!");
+            return false;
+        }
+    }
+
+    eyes_release();
+    eyes_async_result = eyes_pipeline.result();
+    eyes_async_running = true;
+    if (xTaskCreatePinnedToCore(eyes_vision_task, "eyes", EYES_TASK_STACK, NULL,
+                                EYES_TASK_PRIORITY, NULL, EYES_TASK_CORE) != pdPASS) {
+        eyes_async_running = false;
+        Serial.println("Eyes: ERROR - Failed to start vision task!");
+        return false;
+    }
+    Serial.printf("Eyes: Vision task running on core %d\n", EYES_TASK_CORE);
+    return true;
+}
+
+// Stops the vision task and waits for it to let go of the camera
+inline void eyes_stop_async() {
+    if (!eyes_async_running) return;
+    eyes_async_running = false;
+    xSemaphoreTake(eyes_async_done, portMAX_DELAY);
+}
+
 //Take picture and detect blobs
-void eyes_snap() {
+// In async mode: wait for the vision task to finish a frame newer than the
+// one the getters hold
+inline void eyes_snap() {
+    if (eyes_async_running) {
+        while (!eyes_async_take()) {
+            if (xSemaphoreTake(eyes_async_ready, pdMS_TO_TICKS(EYES_ASYNC_TIMEOUT_MS)) != pdTRUE) {
+                Serial.println("Eyes: ERROR - Vision task produced no frame!");
+                eyes_clear_detections(&eyes_pipeline.result());
+                return;
+            }
+        }
+        return;
+    }
+
     // Capture frame
+    uint32_t t_capture = micros();
     camera_fb_t* fb = esp_camera_fb_get();
+    uint32_t wait_us = micros() - t_capture;
+    uint16_t capture_us = eyes_clamp_us(wait_us);
+    EYES_PROF_SAMPLE(eyes_pipeline.profiler(), EYES_PROF_CAPTURE, wait_us);
 
+    EyesResult& r = eyes_pipeline.result();
     if (!fb) {
         Serial.println("Eyes: ERROR - Failed to capture frame!");
-        eyes_result.framebuffer = NULL;
+        r.framebuffer = NULL;
+        eyes_clear_detections(&r);
         return;
     }
 
-    eyes_process_frame(fb);
+    eyes_pipeline.process(fb);
+    r.stage_us[EYES_STAGE_CAPTURE] = capture_us;
 
     // Store framebuffer pointer
-    eyes_result.framebuffer = fb;
+    r.framebuffer = fb;
 }
 
-//Release frame buffer
-void eyes_release() {
-    if (eyes_result.framebuffer != NULL) {
-        esp_camera_fb_return(eyes_result.framebuffer);
-        eyes_result.framebuffer = NULL;
-    }
+// Non-blocking pick-up for control loops. Async: copies the newest finished
+// result into the getters, false if there is nothing new since last call.
+// Sync: falls back to eyes_snap() (pair with eyes_release() as usual).
+inline bool eyes_latest() {
+    if (eyes_async_running) return eyes_async_take();
+    eyes_snap();
+    return eyes_pipeline.result().framebuffer != NULL;
 }
 
+#ifdef EYES_NAMESPACE
+}  // namespace EYES_NAMESPACE
+#endif
+
 #endif // EYES_H
@@ -9,12 +9,100 @@ int heading = 0;
 
 
 
+// =============================================
+// MOTION PROFILE - driveControl() only sets target speeds. driveUpdate()
+// (the "drive" scheduler task) moves the actual speeds toward them on the
+// micros() clock: at most DRIVE_MAX_ACCEL, with acceleration changing at
+// most DRIVE_MAX_JERK, easing in so acceleration reaches 0 as the speed
+// reaches the target, without overshoot.
+// Ramps take the same time however often vision calls driveControl(),
+// and a servo is only written when its pulse width changes.
+// =============================================
+#define DRIVE_MAX_ACCEL 250.0f  // Speed units (-100..100) per second
+#define DRIVE_MAX_JERK 2500.0f  // Speed units per second^2
+#define DRIVE_MAX_DT_US 50000   // Longer gaps (first update, stalls) count as this
+
+struct DriveAxis
+{
+  float target;
+  float speed;
+  float accel;
+  int pulse;  // Last written, -1 = write on the next update
+};
+
+DriveAxis leftAxis = {0, 0, 0, -1};
+DriveAxis rightAxis = {0, 0, 0, -1};
+uint32_t driveLastUs = 0;
+
 void driveControl(int left, int right) //0 is STOP. -100 is REV. 100 is FOR
 {
-  int leftSpeed = (-5*left) + 1500;
-  int rightSpeed = (5*right) + 1500;
-  leftDrive.writeMicroseconds(leftSpeed);
-  rightDrive.writeMicroseconds(rightSpeed);
+  leftAxis.target = constrain(left, -100, 100);
+  rightAxis.target = constrain(right, -100, 100);
+}
+
+// Stops both sides at once, no ramp (ESTOP); the next update rewrites both
+void driveHalt()
+{
+  leftAxis = {0, 0, 0, -1};
+  rightAxis = {0, 0, 0, -1};
+}
+
+// One step of constant jerk: speed moves by the mean of the old and new
+// acceleration, exact for a jerk-limited profile. The new acceleration is
+// the largest that leaves the axis on its braking curve (accel^2 =
+// 2 * DRIVE_MAX_JERK * err, which eases to 0 exactly at the target), at
+// most DRIVE_MAX_JERK * dt from the old one. The last step lands on the
+// target once the remaining acceleration can go in one step.
+void driveStep(DriveAxis *axis, float dt)
+{
+  float err = axis->target - axis->speed;
+  // Work toward the target: positive = closing in on it
+  float dir = err > 0 ? 1 : (err < 0 ? -1 : (axis->accel >= 0 ? 1 : -1));
+  float e = err * dir;
+  float a = axis->accel * dir;
+  float jerk = DRIVE_MAX_JERK * dt;
+
+  if (a <= jerk && e <= a * dt / 2)
+  {
+    axis->speed = axis->target;
+    axis->accel = 0;
+    return;
+  }
+
+  // a'^2 = 2J(e - (a + a') dt / 2), solved for a'
+  float disc = jerk * jerk + 8 * DRIVE_MAX_JERK * (e - a * dt / 2);
+  float want = disc > 0 ? (sqrtf(disc) - jerk) / 2 : -DRIVE_MAX_ACCEL;
+  float next = constrain(min(want, DRIVE_MAX_ACCEL), a - jerk, a + jerk);
+  axis->speed += (a + next) / 2 * dt * dir;
+  axis->accel = next * dir;
+}
+
+void driveWrite(Servo *servo, DriveAxis *axis, int pulse)
+{
+  if (pulse == axis->pulse) return;
+  servo->writeMicroseconds(pulse);
+  axis->pulse = pulse;
+}
+
+void driveUpdateAt(uint32_t nowUs)
+{
+  float dt = min<uint32_t>(nowUs - driveLastUs, DRIVE_MAX_DT_US) * 1e-6f;
+  driveLastUs = nowUs;
+  driveStep(&leftAxis, dt);
+  driveStep(&rightAxis, dt);
+  driveWrite(&leftDrive, &leftAxis, lroundf(-5 * leftAxis.speed) + 1500);
+  driveWrite(&rightDrive, &rightAxis, lroundf(5 * rightAxis.speed) + 1500);
+}
+
+void driveUpdate()
+{
+  driveUpdateAt(micros());
+}
+
+// Profiled turn speed, + = turning right (what the tracker integrates)
+float driveTurnSpeed()
+{
+  return (leftAxis.speed - rightAxis.speed) / 2;
 }
 
 // Apply forward/heading to motors
@@ -25,24 +113,3 @@ void applyDrive()
 
   driveControl(left,right);
 }
-
-bool ramping = false;
-
-int currentSpeed = 0;
-
-bool rampUp(int initSpeed, int finalSpeed, int cycles) //Slow initSpeed, high finalSpeed, modulate cycles as needed
-{
-  currentSpeed = initSpeed + currentSpeed + cycles;
-  if(abs(currentSpeed - finalSpeed) > 0)
-  {
-   driveControl(currentSpeed,currentSpeed);
-   return true;
-   delay(10);
-  }
-  else
-  {
-    driveControl(finalSpeed,finalSpeed);
-    //currentSpeed = 0;
-    return false;
-  }
-}
\ No newline at end of file
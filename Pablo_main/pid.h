@@ -1,44 +1,83 @@
 #include "eyes.h"
 
-float p_mod = 0.3;//TUNE
-float p = 0;
-float maxSpeed = 0;
-float max_mod = 2;//TUNE
-#define DEADZONE 10
-bool pillarPID(float heading = 0)
+// =============================================
+// PID - one update() per measurement, dt from the caller's timestamps.
+// The integral is clamped to the output range and frozen while the output
+// saturates in the error's direction (anti-windup). The first update after
+// reset(), or after a gap over PID_MAX_DT_US, is P only.
+// =============================================
+#define PID_MAX_DT_US 250000
+
+class PidController
 {
-  eyes_snap();
+public:
+  PidController(float kp, float ki, float kd, float outMin, float outMax)
+    : kp(kp), ki(ki), kd(kd), outMin(outMin), outMax(outMax)
+  {
+    reset();
+  }
+
+  void reset()
+  {
+    integral = 0;
+    lastError = 0;
+    lastUs = 0;
+    primed = false;
+  }
 
-  int h = fabs(heading);
-  p = -p_mod * h; //proportionality
-  maxSpeed = h/max_mod; //limiter
+  float update(float error, uint32_t nowUs)
+  {
+    float dt = (nowUs - lastUs) * 1e-6f;
+    bool timed = primed && nowUs - lastUs > 0 && nowUs - lastUs <= PID_MAX_DT_US;
+    lastUs = nowUs;
+    primed = true;
 
-  int16_t offset = eyes_get_yellow_offset_x();
-  if (offset == 0) offset = 1;
-  Serial.print("offset: ");
-  Serial.println( offset);
-  int speedMod = ((h/offset)*p);
+    float out = kp * error;
+    if (timed)
+    {
+      out += kd * (error - lastError) / dt;
+      float tryIntegral = integral + error * dt;
+      float tryOut = out + ki * tryIntegral;
+      if ((tryOut < outMax || error < 0) && (tryOut > outMin || error > 0)) integral = tryIntegral;
+      if (ki != 0) integral = constrain(integral, outMin / fabsf(ki), outMax / fabsf(ki));
+      out += ki * integral;
+    }
+    lastError = error;
+    return constrain(out, outMin, outMax);
+  }
 
-  int speedOutLeft = speedMod;
-  if(speedOutLeft > maxSpeed) speedOutLeft = maxSpeed;
+private:
+  float kp, ki, kd;
+  float outMin, outMax;
+  float integral;
+  float lastError;
+  uint32_t lastUs;
+  bool primed;
+};
 
-  int speedOutRight = -speedOutLeft;
+// Pillar alignment: spin in place until the yellow offset is within DEADZONE
+// of heading (pixels, + = right of center)
+#define PILLAR_KP 0.25f   //TUNE Speed units per pixel
+#define PILLAR_KI 0.05f   //TUNE Per pixel-second
+#define PILLAR_KD 0.01f   //TUNE Per pixel/second
+#define PILLAR_MAX_TURN 30 // Speed units
+#define DEADZONE (10 * EYES_PX_SCALE)  // 10 QQVGA pixels at any EYES_FRAMESIZE
 
-  bool result;
-  if(abs(eyes_get_yellow_offset_x()) > heading + DEADZONE)
-  {
-    driveControl(speedOutLeft,speedOutRight);
-    //leftDrive.writeMicroseconds(speedOutLeft);
-    //rightDrive.writeMicroseconds(speedOutRight);
-    result = true;
-  }
-  else
+PidController pillarPid(PILLAR_KP, PILLAR_KI, PILLAR_KD, -PILLAR_MAX_TURN, PILLAR_MAX_TURN);
+
+// One control step for one frame's offset, at the frame's capture time
+// (eyes_get_frame_timestamp_us()); true while the pillar is still off center
+bool pillarPID(int16_t offset, uint32_t captureUs, float heading = 0)
+{
+  float error = offset - heading;
+  if (fabsf(error) <= DEADZONE)
   {
+    pillarPid.reset();
     driveControl(0,0);
-    result = false;
+    return false;
   }
-  
 
-  eyes_release();
-  return result;
-}
\ No newline at end of file
+  int turn = lroundf(pillarPid.update(error, captureUs));
+  driveControl(turn,-turn); // + offset = pillar to the right, turn right
+  return true;
+}
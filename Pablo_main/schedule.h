@@ -0,0 +1,22 @@
+// =============================================
+// SCHEDULE - every input gets its own deadline (see scheduler.h)
+// Periods and budgets in us. The vision task only picks up finished
+// results (the camera runs on its own task), so it never waits on a frame.
+// Pablo_main.ino registers its tasks with these and host/sched_bench
+// checks the same numbers.
+// =============================================
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#define VISION_PERIOD_US 10000
+#define VISION_BUDGET_US 2000
+#define IR_PERIOD_US 5000
+#define IR_BUDGET_US 500
+#define LINE_PERIOD_US 2000
+#define LINE_BUDGET_US 200
+#define DRIVE_PERIOD_US 10000       // Motion profile step (see motor_control.h)
+#define DRIVE_BUDGET_US 300
+#define CONTROL_PERIOD_US 20000     // Steering from the tracker (see tracker.h)
+#define CONTROL_BUDGET_US 1000      // LED ring updates included
+
+#endif // SCHEDULE_H
@@ -0,0 +1,123 @@
+/* SCHEDULER.H - Cooperative fixed-rate tasks for loop()
+ *
+ * sched_add(name, fn, period_us, budget_us) to register a task
+ * sched_run() from loop() to run whichever task is due next
+ * sched_get_task(index) for one task's counters
+ * sched_print_stats() / sched_reset_stats()
+ *
+ * Each task has its own deadline, period_us apart. sched_run() picks the
+ * due task with the oldest deadline (ties: registration order), runs it
+ * to completion and returns, so one task never runs twice while another
+ * waits, and the wait for any input is bounded by the periods plus the
+ * longest single run. Nothing preempts: a task must return within its
+ * budget_us (no delay(), no waiting on the camera). Going over counts an
+ * overrun. Starting more than a period after the deadline counts the
+ * task as late, and its deadlines restart from now instead of bursting
+ * to catch up.
+ *
+ * Times are micros(); the wrap at 71 minutes is handled.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#define SCHED_MAX_TASKS 8
+
+typedef void (*SchedFn)();
+
+typedef struct {
+    const char* name;
+    SchedFn fn;
+    uint32_t period_us;
+    uint32_t budget_us;
+    uint32_t due_us;        // Next deadline
+
+    uint32_t runs;
+    uint32_t overruns;      // Runs longer than budget_us
+    uint32_t late;          // Runs started more than a period after the deadline
+    uint64_t total_us;
+    uint32_t max_run_us;
+    uint32_t max_wait_us;   // Longest deadline -> start
+} SchedTask;
+
+static SchedTask sched_tasks[SCHED_MAX_TASKS];
+static uint8_t sched_count = 0;
+
+// First run is due right away. False if the table is full.
+bool sched_add(const char* name, SchedFn fn, uint32_t period_us, uint32_t budget_us) {
+    if (sched_count >= SCHED_MAX_TASKS || period_us == 0) {
+        Serial.println("Sched: ERROR - Cannot add task!");
+        return false;
+    }
+    SchedTask* t = &sched_tasks[sched_count++];
+    memset(t, 0, sizeof(*t));
+    t->name = name;
+    t->fn = fn;
+    t->period_us = period_us;
+    t->budget_us = budget_us;
+    t->due_us = micros();
+    return true;
+}
+
+uint8_t sched_get_count() {
+    return sched_count;
+}
+
+const SchedTask* sched_get_task(uint8_t index) {
+    return index < sched_count ? &sched_tasks[index] : NULL;
+}
+
+// Runs the most overdue task, if any is due. True if one ran.
+bool sched_run() {
+    uint32_t now = micros();
+    SchedTask* next = NULL;
+    uint32_t next_wait = 0;
+    for (uint8_t i = 0; i < sched_count; i++) {
+        int32_t wait = (int32_t)(now - sched_tasks[i].due_us);
+        if (wait >= 0 && (next == NULL || (uint32_t)wait > next_wait)) {
+            next = &sched_tasks[i];
+            next_wait = wait;
+        }
+    }
+    if (next == NULL) return false;
+
+    next->fn();
+    uint32_t end = micros();
+    uint32_t run_us = end - now;
+
+    next->runs++;
+    next->total_us += run_us;
+    if (run_us > next->max_run_us) next->max_run_us = run_us;
+    if (run_us > next->budget_us) next->overruns++;
+    if (next_wait > next->max_wait_us) next->max_wait_us = next_wait;
+
+    next->due_us += next->period_us;
+    if (next_wait > next->period_us) {
+        next->late++;
+        next->due_us = end + next->period_us;
+    }
+    return true;
+}
+
+void sched_reset_stats() {
+    for (uint8_t i = 0; i < sched_count; i++) {
+        SchedTask* t = &sched_tasks[i];
+        t->runs = t->overruns = t->late = 0;
+        t->total_us = 0;
+        t->max_run_us = t->max_wait_us = 0;
+    }
+}
+
+void sched_print_stats() {
+    Serial.println("Sched: task      period  budget    runs  mean us  max us  max wait  overruns  late");
+    for (uint8_t i = 0; i < sched_count; i++) {
+        const SchedTask* t = &sched_tasks[i];
+        Serial.printf("Sched: %-9s %7u %7u %7u %8u %7u %9u %9u %5u\n", t->name, (unsigned)t->period_us,
+                      (unsigned)t->budget_us, (unsigned)t->runs, (unsigned)(t->runs ? t->total_us / t->runs : 0),
+                      (unsigned)t->max_run_us, (unsigned)t->max_wait_us, (unsigned)t->overruns, (unsigned)t->late);
+    }
+}
+
+#endif // SCHEDULER_H
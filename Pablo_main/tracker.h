@@ -0,0 +1,124 @@
+/* TRACKER.H - Latency-compensated yellow pillar offset
+ *
+ * track_turn(now_us, turn) from the control task, every tick
+ * track_measure(offset_x, capture_us) for every frame that found the pillar
+ * track_predict(now_us) for the offset right now (pixels, + = right of center)
+ * track_valid(now_us) / track_reset()
+ *
+ * A frame's offset is already stale when loop() sees it, and the robot has
+ * kept turning since. The tracker keeps the pillar's bearing in "world"
+ * pixels: the image offset plus how far the robot's own turning has moved
+ * the image (ego), integrated from the turn speed track_turn() is given
+ * and kept per tick in a short history. A detection is moved into world
+ * pixels with the ego at its capture time, then folded in by an
+ * alpha-beta filter (position plus drift rate, for a pillar that moves or
+ * a turn rate that is off). track_predict() runs the filter forward to
+ * now and takes the current ego back out, so control can steer between
+ * frames and through missed ones. After TRACK_TIMEOUT_US without a
+ * detection the track is dropped.
+ *
+ * Times are micros(); the wrap at 71 minutes is handled.
+ */
+
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <Arduino.h>
+#include "eyes.h"
+
+// Pixels are EYES_FRAMESIZE's: tuned in QQVGA pixels, scaled by EYES_PX_SCALE
+#define TRACK_PX_PER_TURN (4.0f * EYES_PX_SCALE)  //TUNE Image drift, px/s per unit of turn speed
+#define TRACK_ALPHA 0.5f         // Position gain
+#define TRACK_BETA 0.1f          // Drift rate gain
+#define TRACK_MAX_RATE (200.0f * EYES_PX_SCALE)  // Drift rate clamp, px/s
+#define TRACK_TIMEOUT_US 500000  // No detection this long = target lost
+#define TRACK_HISTORY 64         // Ego samples kept (power of 2); covers capture latency at the control rate
+
+typedef struct {
+    uint32_t t_us;
+    float ego_px;
+} TrackEgo;
+
+static TrackEgo track_ego[TRACK_HISTORY];
+static uint32_t track_ego_count = 0;    // Samples written so far
+static float track_turn_speed = 0;      // Last track_turn() speed
+
+static bool track_have = false;
+static float track_world_px = 0;        // At track_last_us
+static float track_rate = 0;            // World px/s
+static uint32_t track_last_us = 0;      // Capture time of the last detection
+
+static const TrackEgo* track_ego_latest() {
+    return &track_ego[(track_ego_count - 1) % TRACK_HISTORY];
+}
+
+// Ego at t: interpolated inside the history, extrapolated past its end
+static float track_ego_at(uint32_t t_us) {
+    if (track_ego_count == 0) return 0;
+    const TrackEgo* newest = track_ego_latest();
+    int32_t ahead = (int32_t)(t_us - newest->t_us);
+    if (ahead >= 0) return newest->ego_px + TRACK_PX_PER_TURN * track_turn_speed * ahead * 1e-6f;
+
+    uint32_t kept = min<uint32_t>(track_ego_count, TRACK_HISTORY);
+    const TrackEgo* later = newest;
+    for (uint32_t i = 2; i <= kept; i++) {
+        const TrackEgo* e = &track_ego[(track_ego_count - i) % TRACK_HISTORY];
+        int32_t after = (int32_t)(t_us - e->t_us);
+        if (after >= 0) {
+            float span = (float)(int32_t)(later->t_us - e->t_us);
+            float f = span > 0 ? after / span : 0;
+            return e->ego_px + (later->ego_px - e->ego_px) * f;
+        }
+        later = e;
+    }
+    return later->ego_px;  // Older than the history
+}
+
+// Integrates the robot's turn speed (-100..100, + = right) up to now
+void track_turn(uint32_t now_us, float turn) {
+    float ego = 0;
+    if (track_ego_count > 0) {
+        const TrackEgo* newest = track_ego_latest();
+        ego = newest->ego_px + TRACK_PX_PER_TURN * track_turn_speed * (int32_t)(now_us - newest->t_us) * 1e-6f;
+    }
+    track_ego[track_ego_count % TRACK_HISTORY] = {now_us, ego};
+    track_ego_count++;
+    track_turn_speed = turn;
+}
+
+// A detection at its capture time; older than the last one is ignored
+void track_measure(int16_t offset_x, uint32_t capture_us) {
+    float world = offset_x + track_ego_at(capture_us);
+    int32_t dt_us = (int32_t)(capture_us - track_last_us);
+    if (!track_have || dt_us > TRACK_TIMEOUT_US) {
+        track_world_px = world;
+        track_rate = 0;
+    } else if (dt_us > 0) {
+        float dt = dt_us * 1e-6f;
+        float predicted = track_world_px + track_rate * dt;
+        float residual = world - predicted;
+        track_world_px = predicted + TRACK_ALPHA * residual;
+        track_rate = constrain(track_rate + TRACK_BETA * residual / dt, -TRACK_MAX_RATE, TRACK_MAX_RATE);
+    } else {
+        return;
+    }
+    track_have = true;
+    track_last_us = capture_us;
+}
+
+bool track_valid(uint32_t now_us) {
+    return track_have && (int32_t)(now_us - track_last_us) <= TRACK_TIMEOUT_US;
+}
+
+// Image offset the pillar has now; only meaningful while track_valid()
+float track_predict(uint32_t now_us) {
+    float dt = (int32_t)(now_us - track_last_us) * 1e-6f;
+    return track_world_px + track_rate * dt - track_ego_at(now_us);
+}
+
+void track_reset() {
+    track_have = false;
+    track_rate = 0;
+}
+
+#endif // TRACKER_H
@@ -0,0 +1,224 @@
+/* FRAME_CODEC.H - Lossless frame compression for the viewer link
+ *
+ * codec_encode_rgb565() / codec_decode_rgb565() for camera frames
+ * codec_encode_bits() / codec_decode_bits() for packed class planes
+ *
+ * RGB565 stream (QOI-style, one op per byte tag, pixels in camera byte
+ * order). Both sides track the previous pixel ("left") and a 64-entry
+ * table of recent pixels; with a reference frame, runs may also copy the
+ * same pixels from it:
+ *   00nnnnnn            left repeated n+1 times
+ *   01nnnnnn            next n+1 pixels equal the reference frame
+ *   10iiiiii            pixel table[i]
+ *   110rrrrg ggggbbbb   left + (dr -8..7, dg -16..15, db -8..7), mod 32/64/32
+ *   11111111 hi lo      literal pixel
+ * Tags 0xE0-0xFE are invalid. After every op, table[hash(left)] = left.
+ *
+ * Bit planes: XOR with the reference (if any), then the lengths of
+ * alternating runs of 0 and 1 bits (starting with 0, LSB first in each
+ * word) as LEB128 varints. Static masks cost a few bytes.
+ *
+ * Encoders return the encoded size, or 0 if it would exceed cap (send the
+ * raw data instead). Decoders return false on a malformed stream.
+ *
+ * Lives next to eyes.h; viewer.py has the matching decoders. Every
+ * function is inline, so any number of .cpp files may include it.
+ */
+
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <Arduino.h>
+
+#define CODEC_OP_RUN   0x00
+#define CODEC_OP_REF   0x40
+#define CODEC_OP_INDEX 0x80
+#define CODEC_OP_DIFF  0xC0
+#define CODEC_OP_RAW   0xFF
+#define CODEC_MAX_RUN  64
+
+inline uint8_t codec_hash(uint16_t px) {
+    return ((px >> 11) * 3 + ((px >> 5) & 0x3F) * 5 + (px & 0x1F) * 7) & 63;
+}
+
+// Signed difference a - b wrapped to bits wide
+inline int codec_wrap(int a, int b, int bits) {
+    int d = (a - b) & ((1 << bits) - 1);
+    return d >= (1 << (bits - 1)) ? d - (1 << bits) : d;
+}
+
+inline uint16_t codec_load(const uint8_t* buf, int i) {
+    return ((uint16_t)buf[i * 2] << 8) | buf[i * 2 + 1];
+}
+
+// RGB565 ENCODER - count pixels of px against ref (NULL for a key frame)
+inline size_t codec_encode_rgb565(const uint8_t* px, const uint8_t* ref, int count, uint8_t* out, size_t cap) {
+    uint16_t table[64] = {0};
+    uint16_t left = 0;
+    size_t n = 0;
+    int i = 0;
+
+    while (i < count) {
+        if (n + 3 > cap) return 0;
+        uint16_t p = codec_load(px, i);
+
+        // Longest run from here: repeats of left, or pixels unchanged since ref
+        int run_left = 0;
+        while (run_left < CODEC_MAX_RUN && i + run_left < count && codec_load(px, i + run_left) == left) run_left++;
+        int run_ref = 0;
+        if (ref) {
+            while (run_ref < CODEC_MAX_RUN && i + run_ref < count &&
+                   codec_load(px, i + run_ref) == codec_load(ref, i + run_ref)) run_ref++;
+        }
+
+        if (run_ref > 0 && run_ref >= run_left) {
+            out[n++] = CODEC_OP_REF | (run_ref - 1);
+            i += run_ref;
+            left = codec_load(px, i - 1);
+        } else if (run_left > 0) {
+            out[n++] = CODEC_OP_RUN | (run_left - 1);
+            i += run_left;
+        } else {
+            uint8_t h = codec_hash(p);
+            int dr = codec_wrap(p >> 11, left >> 11, 5);
+            int dg = codec_wrap((p >> 5) & 0x3F, (left >> 5) & 0x3F, 6);
+            int db = codec_wrap(p & 0x1F, left & 0x1F, 5);
+            if (table[h] == p) {
+                out[n++] = CODEC_OP_INDEX | h;
+            } else if (dr >= -8 && dr <= 7 && dg >= -16 && dg <= 15 && db >= -8 && db <= 7) {
+                out[n++] = CODEC_OP_DIFF | ((dr + 8) << 1) | ((dg + 16) >> 4);
+                out[n++] = (((dg + 16) & 0x0F) << 4) | (db + 8);
+            } else {
+                out[n++] = CODEC_OP_RAW;
+                out[n++] = p >> 8;
+                out[n++] = p & 0xFF;
+            }
+            left = p;
+            i++;
+        }
+        table[codec_hash(left)] = left;
+    }
+    return n;
+}
+
+// RGB565 DECODER - ref must be the frame the encoder was given (or NULL)
+inline bool codec_decode_rgb565(const uint8_t* in, size_t len, const uint8_t* ref, int count, uint8_t* out) {
+    uint16_t table[64] = {0};
+    uint16_t left = 0;
+    size_t n = 0;
+    int i = 0;
+
+    while (i < count) {
+        if (n >= len) return false;
+        uint8_t tag = in[n++];
+        int run = 0;
+
+        if (tag == CODEC_OP_RAW) {
+            if (n + 2 > len) return false;
+            left = ((uint16_t)in[n] << 8) | in[n + 1];
+            n += 2;
+            run = 1;
+        } else if ((tag & 0xE0) == CODEC_OP_DIFF) {
+            if (n >= len) return false;
+            int dr = ((tag >> 1) & 0x0F) - 8;
+            int dg = (((tag & 0x01) << 4) | (in[n] >> 4)) - 16;
+            int db = (in[n] & 0x0F) - 8;
+            n++;
+            left = (uint16_t)((((left >> 11) + dr) & 0x1F) << 11 |
+                              ((((left >> 5) & 0x3F) + dg) & 0x3F) << 5 |
+                              (((left & 0x1F) + db) & 0x1F));
+            run = 1;
+        } else if ((tag & 0xC0) == CODEC_OP_INDEX) {
+            left = table[tag & 0x3F];
+            run = 1;
+        } else if ((tag & 0xE0) == 0xE0) {
+            return false;
+        } else if ((tag & 0xC0) == CODEC_OP_REF) {
+            run = (tag & 0x3F) + 1;
+            if (!ref || i + run > count) return false;
+            memcpy(out + i * 2, ref + i * 2, run * 2);
+            i += run;
+            left = codec_load(out, i - 1);
+            table[codec_hash(left)] = left;
+            continue;
+        } else {
+            run = (tag & 0x3F) + 1;
+        }
+
+        if (i + run > count) return false;
+        for (int k = 0; k < run; k++, i++) {
+            out[i * 2] = left >> 8;
+            out[i * 2 + 1] = left & 0xFF;
+        }
+        table[codec_hash(left)] = left;
+    }
+    return n == len;
+}
+
+inline bool codec_put_varint(uint8_t* out, size_t* n, size_t cap, uint32_t v) {
+    do {
+        if (*n >= cap) return false;
+        out[(*n)++] = (v & 0x7F) | (v > 0x7F ? 0x80 : 0);
+        v >>= 7;
+    } while (v);
+    return true;
+}
+
+// BIT PLANE ENCODER - words of packed masks against ref (NULL for a key frame)
+inline size_t codec_encode_bits(const uint32_t* words, const uint32_t* ref, int count, uint8_t* out, size_t cap) {
+    size_t n = 0;
+    uint32_t bit = 0;  // Value of the current run
+    uint32_t run = 0;
+
+    for (int w = 0; w < count; w++) {
+        uint32_t word = ref ? words[w] ^ ref[w] : words[w];
+        if (word == (bit ? 0xFFFFFFFFu : 0)) {
+            run += 32;
+            continue;
+        }
+        for (int b = 0; b < 32; b++) {
+            if (((word >> b) & 1) != bit) {
+                if (!codec_put_varint(out, &n, cap, run)) return 0;
+                bit ^= 1;
+                run = 0;
+            }
+            run++;
+        }
+    }
+    if (!codec_put_varint(out, &n, cap, run)) return 0;
+    return n;
+}
+
+// BIT PLANE DECODER - count words into out
+inline bool codec_decode_bits(const uint8_t* in, size_t len, const uint32_t* ref, int count, uint32_t* out) {
+    memset(out, 0, count * sizeof(uint32_t));
+    uint32_t total = (uint32_t)count * 32;
+    uint32_t pos = 0;
+    uint32_t bit = 0;
+    size_t n = 0;
+
+    while (n < len) {
+        uint32_t run = 0;
+        int shift = 0;
+        while (true) {
+            if (n >= len || shift > 28) return false;
+            uint8_t b = in[n++];
+            run |= (uint32_t)(b & 0x7F) << shift;
+            shift += 7;
+            if (!(b & 0x80)) break;
+        }
+        if (run > total - pos) return false;
+        if (bit) {
+            for (uint32_t k = pos; k < pos + run; k++) out[k / 32] |= 1u << (k % 32);
+        }
+        pos += run;
+        bit ^= 1;
+    }
+    if (pos != total) return false;
+    if (ref) {
+        for (int w = 0; w < count; w++) out[w] ^= ref[w];
+    }
+    return true;
+}
+
+#endif // FRAME_CODEC_H
@@ -0,0 +1,94 @@
+/* BENCH_ARGS.H - Command-line options for host benchmarks
+ *
+ *   BenchArgs args("sched_bench [--ms T] [--frame-us F] [--seed S]");
+ *   args.option("--ms", &opt.ms);
+ *   args.option("--seed", &opt.seed);
+ *   if (!args.parse(argc, argv, [&] { return opt.ms > 0; })) return 2;
+ *
+ * option() takes an int, a uint32_t (any base strtoul reads), a string,
+ * a vector (the option may repeat) or a function that parses the value
+ * and returns false if it is bad. flag() is an option without a value,
+ * positional() the one bare argument. parse() prints the usage text to
+ * stderr and returns false on an unknown option, a missing or bad value,
+ * or when the check it is given fails.
+ */
+
+#ifndef BENCH_ARGS_H
+#define BENCH_ARGS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+class BenchArgs {
+public:
+    // Everything after "usage: "; continuation lines carry their own indent
+    explicit BenchArgs(const char* usage) : usage_(usage) {}
+
+    void option(const char* name, std::function<bool(const char*)> parse) {
+        options_.push_back({name, true, parse});
+    }
+    void option(const char* name, int* out) {
+        option(name, [out](const char* v) { *out = atoi(v); return true; });
+    }
+    void option(const char* name, uint32_t* out) {
+        option(name, [out](const char* v) { *out = (uint32_t)strtoul(v, NULL, 0); return true; });
+    }
+    void option(const char* name, const char** out) {
+        option(name, [out](const char* v) { *out = v; return true; });
+    }
+    void option(const char* name, std::string* out) {
+        option(name, [out](const char* v) { *out = v; return true; });
+    }
+    void option(const char* name, std::vector<std::string>* out) {
+        option(name, [out](const char* v) { out->push_back(v); return true; });
+    }
+
+    // Sets *out to value when present
+    void flag(const char* name, bool* out, bool value = true) {
+        options_.push_back({name, false, [out, value](const char*) { *out = value; return true; }});
+    }
+
+    void positional(std::string* out) { positional_ = out; }
+
+    bool parse(int argc, char** argv, std::function<bool()> check = nullptr) {
+        bool ok = parse_options(argc, argv) && (!check || check());
+        if (!ok) fprintf(stderr, "usage: %s\n", usage_);
+        return ok;
+    }
+
+private:
+    struct Option {
+        std::string name;
+        bool has_value;
+        std::function<bool(const char*)> parse;
+    };
+
+    bool parse_options(int argc, char** argv) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            const Option* match = NULL;
+            for (const Option& o : options_) {
+                if (o.name == arg) match = &o;
+            }
+            if (match) {
+                if (match->has_value && i + 1 >= argc) return false;
+                if (!match->parse(match->has_value ? argv[++i] : NULL)) return false;
+            } else if (positional_ && arg[0] != '-' && positional_->empty()) {
+                *positional_ = arg;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* usage_;
+    std::vector<Option> options_;
+    std::string* positional_ = NULL;
+};
+
+#endif // BENCH_ARGS_H
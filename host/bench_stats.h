@@ -0,0 +1,56 @@
+/* BENCH_STATS.H - Sample collection and table output for host benchmarks */
+
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+inline uint64_t bench_now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class BenchSamples {
+public:
+    explicit BenchSamples(const std::string& name) : name_(name) {}
+
+    void add(uint64_t ns) { samples_.push_back(ns); }
+    size_t count() const { return samples_.size(); }
+    const std::string& name() const { return name_; }
+
+    double mean_us() const {
+        if (samples_.empty()) return 0;
+        uint64_t total = 0;
+        for (uint64_t s : samples_) total += s;
+        return total / 1000.0 / samples_.size();
+    }
+
+    // p in [0, 100]
+    double percentile_us(double p) const {
+        if (samples_.empty()) return 0;
+        std::vector<uint64_t> sorted(samples_);
+        std::sort(sorted.begin(), sorted.end());
+        size_t idx = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[idx] / 1000.0;
+    }
+
+    static void print_header(FILE* out = stdout) {
+        fprintf(out, "%-28s %10s %10s %10s %10s %10s\n", "stage (us)", "min", "mean", "p50", "p99", "max");
+    }
+
+    void print_row(FILE* out = stdout) const {
+        fprintf(out, "%-28s %10.2f %10.2f %10.2f %10.2f %10.2f\n", name_.c_str(),
+                percentile_us(0), mean_us(), percentile_us(50), percentile_us(99), percentile_us(100));
+    }
+
+private:
+    std::string name_;
+    std::vector<uint64_t> samples_;
+};
+
+#endif // BENCH_STATS_H
@@ -0,0 +1,195 @@
+/* CODEC_BENCH - frame_codec.h throughput and compression on Linux
+ *
+ * Usage:
+ *   codec_bench [--frames N] [--scene empty|pillar|mixed] [--seed S]
+ *               [--input dump.rgb565 ...] [--key-every K]
+ *
+ * Encodes every frame as a key frame, as a delta against the previous
+ * frame, and as laptop.ino streams them (a key frame every K sends,
+ * deltas in between), plus the closed class planes the same three ways
+ * (laptop.ino sends those as key frames only: deltas of moving edges cost
+ * more than they save).
+ * Each encoding is decoded and compared with its source. The last table
+ * turns the mean sizes into full frames per second the link can carry
+ * (chunk framing included), at 115200 baud and at USB CDC speed.
+ */
+
+#include "eyes.h"
+#include "frame_codec.h"
+#include "serial_link.h"
+
+#include "bench_args.h"
+#include "bench_stats.h"
+#include "mock_camera.h"
+
+#include <string>
+#include <vector>
+
+#define CODEC_BENCH_UART_BPS 11520     // 115200 baud, 8N1
+#define CODEC_BENCH_USB_BPS 1000000    // Typical ESP32S3 USB CDC throughput
+#define CODEC_BENCH_FRAME_HEADER 13     // sizeof(FrameHeader) in laptop.ino
+
+struct CodecBenchOptions {
+    int frames = 300;
+    MockScene scene = MOCK_SCENE_MIXED;
+    const char* scene_name = "mixed";
+    uint32_t seed = 1;
+    std::vector<std::string> inputs;
+    int key_every = 8;
+};
+
+static bool parse_args(int argc, char** argv, CodecBenchOptions* opt) {
+    BenchArgs args("codec_bench [--frames N] [--scene empty|pillar|mixed] [--seed S] [--input file.rgb565 ...]\n"
+                   "                   [--key-every K]");
+    args.option("--frames", &opt->frames);
+    args.option("--scene", [opt](const char* v) {
+        opt->scene_name = v;
+        return mock_scene_from_name(v, &opt->scene);
+    });
+    args.option("--seed", &opt->seed);
+    args.option("--input", &opt->inputs);
+    args.option("--key-every", &opt->key_every);
+    return args.parse(argc, argv, [opt] { return opt->frames > 1 && opt->key_every > 0; });
+}
+
+// One way of encoding frames: timing, sizes and decode check
+struct CodecRun {
+    BenchSamples encode;
+    BenchSamples decode;
+    uint64_t raw_bytes = 0;
+    uint64_t encoded_bytes = 0;   // What goes on the wire (raw if encoding did not help)
+    int frames = 0;
+    int fallbacks = 0;            // Frames sent raw
+    bool exact = true;
+
+    explicit CodecRun(const std::string& name) : encode(name), decode(name) {}
+
+    void add(size_t raw, size_t encoded) {
+        raw_bytes += raw;
+        encoded_bytes += encoded ? encoded : raw;
+        fallbacks += encoded == 0;
+        frames++;
+    }
+    double ratio() const { return encoded_bytes ? (double)raw_bytes / encoded_bytes : 0; }
+    double mean_bytes() const { return frames ? (double)encoded_bytes / frames : 0; }
+};
+
+static size_t encode_rgb(CodecRun* run, const uint8_t* px, const uint8_t* ref, int count,
+                         std::vector<uint8_t>* out, std::vector<uint8_t>* check) {
+    uint64_t t0 = bench_now_ns();
+    size_t n = codec_encode_rgb565(px, ref, count, out->data(), count * 2);
+    run->encode.add(bench_now_ns() - t0);
+    run->add(count * 2, n);
+    if (n) {
+        t0 = bench_now_ns();
+        bool ok = codec_decode_rgb565(out->data(), n, ref, count, check->data());
+        run->decode.add(bench_now_ns() - t0);
+        if (!ok || memcmp(check->data(), px, count * 2) != 0) run->exact = false;
+    }
+    return n;
+}
+
+static size_t encode_planes(CodecRun* run, const EyesMaskWord* planes, const EyesMaskWord* ref, int words,
+                            std::vector<uint8_t>* out, std::vector<EyesMaskWord>* check) {
+    uint64_t t0 = bench_now_ns();
+    size_t n = codec_encode_bits(planes, ref, words, out->data(), words * 4);
+    run->encode.add(bench_now_ns() - t0);
+    run->add(words * 4, n);
+    if (n) {
+        t0 = bench_now_ns();
+        bool ok = codec_decode_bits(out->data(), n, ref, words, check->data());
+        run->decode.add(bench_now_ns() - t0);
+        if (!ok || memcmp(check->data(), planes, words * 4) != 0) run->exact = false;
+    }
+    return n;
+}
+
+// Bytes on the wire for one full frame sent through link_bulk_start()
+static double wire_bytes(double payload, size_t header) {
+    double chunks = payload > 0 ? (double)(((size_t)payload + LINK_BULK_CHUNK - 1) / LINK_BULK_CHUNK) : 0;
+    return payload + chunks * (LINK_OVERHEAD + 8) + LINK_OVERHEAD + 8 + header;
+}
+
+int main(int argc, char** argv) {
+    CodecBenchOptions opt;
+    if (!parse_args(argc, argv, &opt)) return 2;
+
+    const int w = EYES_IMG_WIDTH, h = EYES_IMG_HEIGHT, count = w * h;
+    MockFrameListSource source(w, h, true);
+    if (opt.inputs.empty()) {
+        mock_render_scene(opt.scene, 120, opt.seed, &source);
+    } else {
+        for (const std::string& path : opt.inputs) {
+            if (mock_load_rgb565_file(path, &source) == 0) {
+                fprintf(stderr, "codec_bench: no %dx%d frames in %s\n", w, h, path.c_str());
+                return 1;
+            }
+        }
+    }
+    eyes_build_class_lut();
+
+    printf("codec_bench: %dx%d, %s, %zu distinct frames, %d iterations, key frame every %d\n\n",
+           w, h, opt.inputs.empty() ? opt.scene_name : "recorded input",
+           source.frame_count(), opt.frames, opt.key_every);
+
+    CodecRun rgb_key("rgb565 key"), rgb_delta("rgb565 delta"), rgb_stream("rgb565 stream");
+    CodecRun mask_key("masks key"), mask_delta("masks delta"), mask_stream("masks stream");
+
+    std::vector<uint8_t> prev(count * 2), out(count * 3), check(count * 2);
+    std::vector<EyesMaskWord> planes(EYES_MASK_TOTAL_WORDS), prev_planes(EYES_MASK_TOTAL_WORDS);
+    std::vector<EyesMaskWord> temp(EYES_MASK_TOTAL_WORDS), plane_check(EYES_MASK_TOTAL_WORDS);
+
+    for (int f = 0; f < opt.frames; f++) {
+        uint32_t ts;
+        const uint8_t* px = source.next_frame(&ts);
+        eyes_classify_frame(px, planes.data(), w, h);
+        eyes_packed_close(planes.data(), temp.data(), w, h, EYES_CLOSE_KERNEL);
+
+        bool key = f % opt.key_every == 0;
+        encode_rgb(&rgb_key, px, NULL, count, &out, &check);
+        encode_planes(&mask_key, planes.data(), NULL, EYES_MASK_TOTAL_WORDS, &out, &plane_check);
+        if (f > 0) {
+            encode_rgb(&rgb_delta, px, prev.data(), count, &out, &check);
+            encode_planes(&mask_delta, planes.data(), prev_planes.data(), EYES_MASK_TOTAL_WORDS, &out, &plane_check);
+        }
+        encode_rgb(&rgb_stream, px, key ? NULL : prev.data(), count, &out, &check);
+        encode_planes(&mask_stream, planes.data(), key ? NULL : prev_planes.data(), EYES_MASK_TOTAL_WORDS,
+                      &out, &plane_check);
+
+        memcpy(prev.data(), px, count * 2);
+        prev_planes = planes;
+    }
+
+    const CodecRun* runs[] = {&rgb_key, &rgb_delta, &rgb_stream, &mask_key, &mask_delta, &mask_stream};
+
+    printf("encode\n");
+    BenchSamples::print_header();
+    for (const CodecRun* r : runs) r->encode.print_row();
+    printf("\ndecode\n");
+    BenchSamples::print_header();
+    for (const CodecRun* r : runs) r->decode.print_row();
+
+    printf("\n%-28s %10s %10s %10s %10s %10s %10s\n", "compression", "raw B", "mean B", "ratio", "raw sent",
+           "MB/s enc", "fps uart");
+    for (const CodecRun* r : runs) {
+        double mbps = r->encode.mean_us() > 0 ? (r->raw_bytes / (double)r->frames) / r->encode.mean_us() : 0;
+        printf("%-28s %10llu %10.0f %10.2f %10d %10.1f %10.2f\n", r->encode.name().c_str(),
+               (unsigned long long)(r->raw_bytes / r->frames), r->mean_bytes(), r->ratio(), r->fallbacks, mbps,
+               CODEC_BENCH_UART_BPS / wire_bytes(r->mean_bytes(), CODEC_BENCH_FRAME_HEADER));
+    }
+
+    // Full frames per second the link sustains, laptop.ino's stream modes
+    double raw_wire = wire_bytes(count * 2, CODEC_BENCH_FRAME_HEADER);
+    double rgb_wire = wire_bytes(rgb_stream.mean_bytes(), CODEC_BENCH_FRAME_HEADER);
+    double mask_wire = wire_bytes(mask_key.mean_bytes(), CODEC_BENCH_FRAME_HEADER);  // laptop.ino sends masks as key frames
+    printf("\n%-28s %10s %10s %10s\n", "full frames/s on the link", "raw", "rgb565", "masks");
+    printf("%-28s %10.2f %10.2f %10.1f\n", "uart 115200 baud", CODEC_BENCH_UART_BPS / raw_wire,
+           CODEC_BENCH_UART_BPS / rgb_wire, CODEC_BENCH_UART_BPS / mask_wire);
+    printf("%-28s %10.1f %10.1f %10.0f\n", "usb cdc ~1 MB/s", CODEC_BENCH_USB_BPS / raw_wire,
+           CODEC_BENCH_USB_BPS / rgb_wire, CODEC_BENCH_USB_BPS / mask_wire);
+
+    bool ok = true;
+    for (const CodecRun* r : runs) ok &= r->exact;
+    printf("\nverify: every encoded frame decodes to its source: %s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+/* ESTOP_BENCH - IR-to-stop latency of Pablo_main/estop.h while frames run
+ *
+ * Usage:
+ *   estop_bench [--ms T] [--sensor-fps F] [--estop-every N] [--seed S]
+ *
+ * The main thread plays loop() at its worst: back-to-back eyes_snap()
+ * calls against a mock sensor at F frames/s, so almost every IR frame
+ * lands mid-capture or mid-processing. An "IR receiver" thread finishes a
+ * frame every 100-300 ms (every Nth one the ESTOP code, the rest other
+ * buttons) and raises estop_notify_from_isr(). The ESTOP task's stop()
+ * stands in for detaching the servos.
+ *
+ * Reported per ESTOP: estop.h's interrupt -> stop latency, and what the
+ * old loop() would have taken (polling IR after the frame in progress).
+ * The check is every stop within ESTOP_BOUND_US (plus host jitter).
+ */
+
+#include "eyes.h"
+#include "estop.h"
+
+#include "bench_args.h"
+#include "bench_stats.h"
+#include "mock_camera.h"
+
+#include <atomic>
+#include <random>
+#include <vector>
+
+#define ESTOP_BENCH_CODE 0xFF00EF00u     // ir_receiver.h's ESTOP
+#define ESTOP_BENCH_OTHER 0xFE01EF00u    // stop
+#define ESTOP_BENCH_JITTER_US 1000       // Host thread wake-up noise allowed by the check
+
+struct EstopBenchOptions {
+    int ms = 3000;
+    int sensor_fps = 30;
+    int estop_every = 2;
+    uint32_t seed = 1;
+};
+
+static bool parse_args(int argc, char** argv, EstopBenchOptions* opt) {
+    BenchArgs args("estop_bench [--ms T] [--sensor-fps F] [--estop-every N] [--seed S]");
+    args.option("--ms", &opt->ms);
+    args.option("--sensor-fps", &opt->sensor_fps);
+    args.option("--estop-every", &opt->estop_every);
+    args.option("--seed", &opt->seed);
+    return args.parse(argc, argv, [opt] { return opt->ms > 0 && opt->sensor_fps > 0 && opt->estop_every > 0; });
+}
+
+// IR RECEIVER + SERVOS
+static std::atomic<uint32_t> ir_pending(0);   // Decoded frame waiting for read(), 0 = none
+static std::atomic<uint32_t> stops(0);
+
+static bool fake_ir_read(uint32_t* code) {
+    uint32_t c = ir_pending.exchange(0);
+    if (c == 0) return false;
+    *code = c;
+    return true;
+}
+
+static void fake_drives_detach() {
+    stops++;
+}
+
+struct IrEvent {
+    uint32_t at_us;
+    bool estop;
+    uint32_t latency_us;  // estop.h, ESTOP only
+};
+
+static void ir_thread(const EstopBenchOptions& opt, std::atomic<bool>* stop, std::vector<IrEvent>* events) {
+    std::mt19937 rng(opt.seed);
+    std::uniform_int_distribution<int> gap_ms(100, 300);
+    for (int n = 0; !stop->load(); n++) {
+        delay(gap_ms(rng));
+        if (stop->load()) break;
+        bool estop = n % opt.estop_every == 0;
+        uint32_t before = estop_get_count();
+        ir_pending = estop ? ESTOP_BENCH_CODE : ESTOP_BENCH_OTHER;
+        IrEvent ev = {micros(), estop, 0};
+        estop_notify_from_isr();
+
+        // Wait for the task to take it (and clear the latch, as re-attaching would)
+        uint32_t t0 = millis();
+        while (ir_pending.load() != 0 && millis() - t0 < 1000) delayMicroseconds(50);
+        if (estop) {
+            while (estop_get_count() == before && millis() - t0 < 1000) delayMicroseconds(50);
+            ev.latency_us = estop_get_latency_us();
+            estop_clear();
+        }
+        events->push_back(ev);
+    }
+}
+
+int main(int argc, char** argv) {
+    EstopBenchOptions opt;
+    if (!parse_args(argc, argv, &opt)) return 2;
+
+    MockFrameListSource source(EYES_IMG_WIDTH, EYES_IMG_HEIGHT, true);
+    mock_render_scene(MOCK_SCENE_MIXED, 120, opt.seed, &source);
+    mock_camera_set_source(&source);
+    if (!eyes_init() || !estop_begin(ESTOP_BENCH_CODE, fake_ir_read, fake_drives_detach)) {
+        fprintf(stderr, "estop_bench: init failed\n");
+        return 1;
+    }
+
+    printf("estop_bench: %d ms, sensor %d fps, sync eyes_snap() loop, ESTOP every %d IR frames\n\n",
+           opt.ms, opt.sensor_fps, opt.estop_every);
+
+    mock_camera_start_sensor(1000000 / opt.sensor_fps);
+    std::atomic<bool> stop(false);
+    std::vector<IrEvent> events;
+    std::thread ir(ir_thread, std::cref(opt), &stop, &events);
+
+    // loop(): frames back to back, IR codes for loop() drained in between
+    std::vector<uint32_t> frame_end;
+    uint32_t other_codes = 0, code;
+    uint32_t start = millis();
+    while (millis() - start < (uint32_t)opt.ms) {
+        eyes_snap();
+        eyes_release();
+        frame_end.push_back(micros());
+        while (estop_poll_code(&code)) other_codes += code == ESTOP_BENCH_OTHER;
+    }
+    stop = true;
+    ir.join();
+    mock_camera_stop_sensor();
+    while (estop_poll_code(&code)) other_codes += code == ESTOP_BENCH_OTHER;
+
+    BenchSamples task("estop.h task"), polled("polled after the frame");
+    uint32_t estops = 0, others = 0, worst = 0;
+    for (const IrEvent& ev : events) {
+        if (!ev.estop) {
+            others++;
+            continue;
+        }
+        estops++;
+        task.add((uint64_t)ev.latency_us * 1000);
+        worst = max(worst, ev.latency_us);
+        auto next = std::lower_bound(frame_end.begin(), frame_end.end(), ev.at_us);
+        if (next != frame_end.end()) polled.add((uint64_t)(*next - ev.at_us) * 1000);
+    }
+
+    printf("%u frames, %u IR frames (%u ESTOP)\n", (unsigned)frame_end.size(), estops + others, estops);
+    printf("\n%-28s %10s %10s %10s %10s %10s\n", "ir -> drives stopped (us)", "min", "mean", "p50", "p99", "max");
+    for (const BenchSamples* s : {&task, &polled}) {
+        printf("%-28s %10.0f %10.0f %10.0f %10.0f %10.0f\n", s->name().c_str(), s->percentile_us(0), s->mean_us(),
+               s->percentile_us(50), s->percentile_us(99), s->percentile_us(100));
+    }
+    printf("estop.h max latency metric: %u us\n\n", estop_get_max_latency_us());
+
+    bool ok = estops > 0 && stops == estops && worst <= ESTOP_BOUND_US + ESTOP_BENCH_JITTER_US;
+    printf("verify: every ESTOP stopped the drives within %d us (+%d us host jitter): %s\n", ESTOP_BOUND_US,
+           ESTOP_BENCH_JITTER_US, ok ? "ok" : "FAIL");
+    bool passed = other_codes == others;
+    printf("verify: every other IR code reached loop(): %s (%u of %u)\n", passed ? "ok" : "FAIL", other_codes, others);
+    return ok && passed ? 0 : 1;
+}
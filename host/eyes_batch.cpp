@@ -0,0 +1,355 @@
+/* EYES_BATCH - Detections for a directory of recorded frames, on every core
+ *
+ * Usage:
+ *   eyes_batch DIR [--out detections.csv] [--threads T] [--chunk F]
+ *              [--tracking] [--no-coarse] [--no-check]
+ *
+ * Every .eyrec recording and .rgb565 raw dump in DIR (not recursive) goes
+ * through the pipeline. Each worker thread owns an EyesPipeline. The work
+ * is chunks of F consecutive frames of one file, dealt round-robin into
+ * one deque per worker; a worker pops its own newest chunk and, when its
+ * deque runs dry, steals the oldest chunk of the next non-empty one, so
+ * the workers finish together however uneven the files are. With
+ * --tracking each frame's window follows the one before, so every file is
+ * a single chunk, run in order from a fresh init().
+ *
+ * CSV (to --out, stdout by default), sorted by file and frame, one row per
+ * detection; a frame with none gets one row with target and the fields
+ * after it empty:
+ *   file,frame,timestamp_us,target,rank,offset_x,centroid_y,area,x_min,x_max,y_min,y_max
+ * frame counts from 0 within the file; timestamp_us is the recorded
+ * sensor time (0 for raw dumps).
+ *
+ * The check runs everything again on one thread with one pipeline and
+ * expects identical detections on every frame, which also gives the
+ * speedup. The summary goes to stderr.
+ */
+
+#include "eyes.h"
+
+#include "bench_args.h"
+#include "eyes_recording.h"
+#include "mock_camera.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static_assert(!EYES_YUV422, "Recordings and dumps are RGB565");
+
+struct BatchOptions {
+    std::string dir;
+    std::string out = "-";
+    int threads = 0;  // 0: one per core
+    int chunk = 16;
+    bool tracking = false;
+    bool coarse = true;
+    bool check = true;
+};
+
+static bool parse_args(int argc, char** argv, BatchOptions* opt) {
+    BenchArgs args("eyes_batch DIR [--out detections.csv] [--threads T] [--chunk F]\n"
+                   "                  [--tracking] [--no-coarse] [--no-check]");
+    args.positional(&opt->dir);
+    args.option("--out", &opt->out);
+    args.option("--threads", &opt->threads);
+    args.option("--chunk", &opt->chunk);
+    args.flag("--tracking", &opt->tracking);
+    args.flag("--no-coarse", &opt->coarse, false);
+    args.flag("--no-check", &opt->check, false);
+    return args.parse(argc, argv, [opt] {
+        if (opt->threads == 0) opt->threads = max(1u, std::thread::hardware_concurrency());
+        return !opt->dir.empty() && opt->threads > 0 && opt->chunk > 0;
+    });
+}
+
+// DATASET - one recording or raw dump, with a result slot per frame
+struct BatchFile {
+    std::string name;
+    std::unique_ptr<RecordingReader> recording;  // .eyrec
+    std::unique_ptr<MockFrameListSource> dump;   // .rgb565
+    std::vector<EyesResult> results;
+
+    size_t frame_count() const { return recording ? recording->frame_count() : dump->frame_count(); }
+    const uint8_t* pixels(size_t i) const { return recording ? recording->pixels(i) : dump->frame(i); }
+    uint32_t timestamp_us(size_t i) const { return recording ? recording->frame(i)->timestamp_us : 0; }
+};
+
+// Loads every usable file in dir, sorted by name. Files of another frame
+// size are skipped with a warning.
+static bool load_dataset(const std::string& dir, std::vector<BatchFile>* files) {
+    std::error_code err;
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, err)) {
+        std::string ext = entry.path().extension().string();
+        if (entry.is_regular_file() && (ext == ".eyrec" || ext == ".rgb565")) paths.push_back(entry.path());
+    }
+    if (err) {
+        fprintf(stderr, "eyes_batch: cannot list %s: %s\n", dir.c_str(), err.message().c_str());
+        return false;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    for (const std::filesystem::path& path : paths) {
+        BatchFile file;
+        file.name = path.filename().string();
+        if (path.extension() == ".eyrec") {
+            file.recording.reset(new RecordingReader);
+            if (!file.recording->open(path.string())) {
+                fprintf(stderr, "eyes_batch: %s is not a readable recording, skipped\n", file.name.c_str());
+                continue;
+            }
+            if (file.recording->width() != EYES_IMG_WIDTH || file.recording->height() != EYES_IMG_HEIGHT) {
+                fprintf(stderr, "eyes_batch: %s is %dx%d, pipeline is %dx%d, skipped\n", file.name.c_str(),
+                        file.recording->width(), file.recording->height(), EYES_IMG_WIDTH, EYES_IMG_HEIGHT);
+                continue;
+            }
+        } else {
+            file.dump.reset(new MockFrameListSource(EYES_IMG_WIDTH, EYES_IMG_HEIGHT, false));
+            mock_load_rgb565_file(path.string(), file.dump.get());
+        }
+        if (file.frame_count() == 0) {
+            fprintf(stderr, "eyes_batch: no %dx%d frames in %s, skipped\n", EYES_IMG_WIDTH, EYES_IMG_HEIGHT,
+                    file.name.c_str());
+            continue;
+        }
+        file.results.resize(file.frame_count());
+        files->push_back(std::move(file));
+    }
+    return true;
+}
+
+// WORK-STEALING POOL - chunks never spawn more work, so a worker whose
+// own deque and every other one is empty is done
+struct BatchChunk {
+    size_t file;
+    size_t first, count;
+};
+
+class BatchDeque {
+public:
+    void push(const BatchChunk& chunk) {
+        std::lock_guard<std::mutex> guard(lock_);
+        chunks_.push_back(chunk);
+    }
+
+    // Owner end: the newest chunk
+    bool pop(BatchChunk* chunk) {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (chunks_.empty()) return false;
+        *chunk = chunks_.back();
+        chunks_.pop_back();
+        return true;
+    }
+
+    // Thief end: the oldest chunk
+    bool steal(BatchChunk* chunk) {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (chunks_.empty()) return false;
+        *chunk = chunks_.front();
+        chunks_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex lock_;
+    std::deque<BatchChunk> chunks_;
+};
+
+struct BatchWorker {
+    BatchDeque queue;
+    std::unique_ptr<EyesPipeline> pipeline;
+    size_t chunks = 0, stolen = 0, frames = 0;
+};
+
+static void process_frame(EyesPipeline* pipeline, const BatchFile& file, size_t i, EyesResult* out) {
+    camera_fb_t fb = {};
+    fb.buf = (uint8_t*)file.pixels(i);
+    fb.len = EYES_IMG_WIDTH * EYES_IMG_HEIGHT * 2;
+    fb.width = EYES_IMG_WIDTH;
+    fb.height = EYES_IMG_HEIGHT;
+    fb.format = PIXFORMAT_RGB565;
+    uint32_t ts = file.timestamp_us(i);
+    fb.timestamp.tv_sec = ts / 1000000;
+    fb.timestamp.tv_usec = ts % 1000000;
+
+    EyesResult res = EyesResult();
+    pipeline->process(&fb, &res);
+    res.frame_number = i;
+    *out = res;
+}
+
+static void run_chunk(EyesPipeline* pipeline, const BatchChunk& chunk, bool tracking, std::vector<BatchFile>* files) {
+    BatchFile& file = (*files)[chunk.file];
+    if (tracking) pipeline->init();  // No lock carried over from another file
+    for (size_t i = chunk.first; i < chunk.first + chunk.count; i++) {
+        process_frame(pipeline, file, i, &file.results[i]);
+    }
+}
+
+static void run_worker(std::vector<BatchWorker>* workers, int self, bool tracking, std::vector<BatchFile>* files) {
+    BatchWorker& me = (*workers)[self];
+    int n = workers->size();
+    BatchChunk chunk;
+    for (;;) {
+        bool got = me.queue.pop(&chunk);
+        for (int k = 1; !got && k < n; k++) {
+            got = (*workers)[(self + k) % n].queue.steal(&chunk);
+            me.stolen += got;
+        }
+        if (!got) return;
+        run_chunk(me.pipeline.get(), chunk, tracking, files);
+        me.chunks++;
+        me.frames += chunk.count;
+    }
+}
+
+static bool new_pipeline(const BatchOptions& opt, std::unique_ptr<EyesPipeline>* out) {
+    out->reset(new EyesPipeline);
+    (*out)->set_tracking(opt.tracking);
+    (*out)->set_coarse_to_fine(opt.coarse);
+    return (*out)->init();
+}
+
+// Deals the chunks out round-robin and runs the pool; false if a pipeline
+// could not be set up
+static bool run_parallel(const BatchOptions& opt, std::vector<BatchFile>* files, std::vector<BatchWorker>* workers) {
+    // First init() builds the class LUT the others share, before any thread starts
+    for (BatchWorker& w : *workers) {
+        if (!new_pipeline(opt, &w.pipeline)) return false;
+    }
+    size_t next = 0;
+    for (size_t f = 0; f < files->size(); f++) {
+        size_t frames = (*files)[f].frame_count();
+        size_t step = opt.tracking ? frames : (size_t)opt.chunk;
+        for (size_t first = 0; first < frames; first += step) {
+            (*workers)[next++ % workers->size()].queue.push({f, first, min(step, frames - first)});
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < (int)workers->size(); t++) threads.emplace_back(run_worker, workers, t, opt.tracking, files);
+    for (std::thread& t : threads) t.join();
+    return true;
+}
+
+static bool same_detections(const EyesResult& a, const EyesResult& b) {
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        if (a.count[c] != b.count[c]) return false;
+        if (memcmp(a.blobs[c], b.blobs[c], a.count[c] * sizeof(EyesDetection)) != 0) return false;
+    }
+    return true;
+}
+
+// CSV - file names are quoted when they hold a comma or a quote
+static std::string csv_field(const std::string& s) {
+    if (s.find_first_of(",\"") == std::string::npos) return s;
+    std::string quoted = "\"";
+    for (char ch : s) quoted += ch == '"' ? std::string("\"\"") : std::string(1, ch);
+    return quoted + "\"";
+}
+
+static bool write_csv(const std::string& path, const std::vector<BatchFile>& files, size_t* rows) {
+    FILE* out = path == "-" ? stdout : fopen(path.c_str(), "w");
+    if (!out) return false;
+    fprintf(out, "file,frame,timestamp_us,target,rank,offset_x,centroid_y,area,x_min,x_max,y_min,y_max\n");
+    *rows = 0;
+    for (const BatchFile& file : files) {
+        std::string name = csv_field(file.name);
+        for (size_t i = 0; i < file.results.size(); i++) {
+            const EyesResult& res = file.results[i];
+            int written = 0;
+            for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+                for (int k = 0; k < res.count[c]; k++) {
+                    const EyesDetection& d = res.blobs[c][k];
+                    fprintf(out, "%s,%zu,%u,%s,%d,%d,%d,%u,%d,%d,%d,%d\n", name.c_str(), i, res.capture_us,
+                            EYES_TARGETS[c].name, k, d.offset_x, d.centroid_y, d.area, d.x_min, d.x_max,
+                            d.y_min, d.y_max);
+                    written++;
+                }
+            }
+            if (!written) fprintf(out, "%s,%zu,%u,,,,,,,,,\n", name.c_str(), i, res.capture_us);
+            *rows += max(written, 1);
+        }
+    }
+    bool ok = !ferror(out);
+    if (out != stdout) ok = fclose(out) == 0 && ok;
+    else fflush(out);
+    return ok;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    BatchOptions opt;
+    if (!parse_args(argc, argv, &opt)) return 2;
+
+    std::vector<BatchFile> files;
+    if (!load_dataset(opt.dir, &files)) return 1;
+    if (files.empty()) {
+        fprintf(stderr, "eyes_batch: no %dx%d .eyrec or .rgb565 files in %s\n", EYES_IMG_WIDTH, EYES_IMG_HEIGHT,
+                opt.dir.c_str());
+        return 1;
+    }
+    size_t total = 0;
+    for (const BatchFile& file : files) total += file.frame_count();
+
+    std::vector<BatchWorker> workers(opt.threads);
+    auto start = std::chrono::steady_clock::now();
+    if (!run_parallel(opt, &files, &workers)) {
+        fprintf(stderr, "eyes_batch: pipeline init failed\n");
+        return 1;
+    }
+    double parallel_s = seconds_since(start);
+
+    size_t rows = 0;
+    if (!write_csv(opt.out, files, &rows)) {
+        fprintf(stderr, "eyes_batch: cannot write %s\n", opt.out.c_str());
+        return 1;
+    }
+
+    fprintf(stderr, "\neyes_batch: %zu frames in %zu files, %d threads, chunks of %s%s\n", total, files.size(),
+            opt.threads, opt.tracking ? "a whole file (--tracking)" : std::to_string(opt.chunk).c_str(),
+            opt.coarse ? "" : ", coarse pass off");
+    fprintf(stderr, "%-10s %10s %10s %10s\n", "worker", "chunks", "stolen", "frames");
+    size_t done = 0;
+    for (int t = 0; t < opt.threads; t++) {
+        fprintf(stderr, "%-10d %10zu %10zu %10zu\n", t, workers[t].chunks, workers[t].stolen, workers[t].frames);
+        done += workers[t].frames;
+    }
+    fprintf(stderr, "parallel: %.3f s, %.0f frames/s; %zu CSV rows to %s\n", parallel_s, total / parallel_s, rows,
+            opt.out == "-" ? "stdout" : opt.out.c_str());
+    bool ok = done == total;
+    fprintf(stderr, "verify: every frame processed exactly once: %s\n", ok ? "ok" : "FAIL");
+    if (!opt.check) return ok ? 0 : 1;
+
+    // One thread, one pipeline, files in order
+    std::unique_ptr<EyesPipeline> single;
+    if (!new_pipeline(opt, &single)) return 1;
+    size_t mismatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (const BatchFile& file : files) {
+        if (opt.tracking) single->init();
+        for (size_t i = 0; i < file.frame_count(); i++) {
+            EyesResult res;
+            process_frame(single.get(), file, i, &res);
+            mismatches += !same_detections(res, file.results[i]);
+        }
+    }
+    double single_s = seconds_since(start);
+    fprintf(stderr, "one thread: %.3f s, %.0f frames/s; speedup %.2fx on %d threads\n", single_s, total / single_s,
+            single_s / parallel_s, opt.threads);
+    bool same = mismatches == 0;
+    fprintf(stderr, "verify: detections identical to one pipeline on one thread: %s (%zu of %zu frames differ)\n",
+            same ? "ok" : "FAIL", mismatches, total);
+    return ok && same ? 0 : 1;
+}
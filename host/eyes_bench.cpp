@@ -0,0 +1,877 @@
+/* EYES_BENCH - Per-frame and per-stage timing of the eyes.h pipeline on Linux
+ *
+ * Usage:
+ *   eyes_bench [--frames N] [--scene empty|pillar|mixed] [--seed S]
+ *              [--input dump.rgb565 ...]
+ *              [--sensor-fps F] [--loop-us U] [--capture-ms T]
+ *
+ * --input replaces the synthetic scene with raw RGB565 dumps (camera byte
+ * order, any number of whole frames per file). Frames loop until N frames
+ * have been processed.
+ *
+ * The capture section runs a captureMode()-style loop (pick up a result,
+ * then U us of other work) for T ms against a mock sensor delivering F
+ * frames/s, once with eyes_snap() and once with the async vision task.
+ */
+
+#include "eyes.h"
+
+#include "bench_args.h"
+#include "bench_stats.h"
+#include "eyes_reference.h"
+#include "mock_camera.h"
+
+#include <string>
+#include <vector>
+
+struct BenchOptions {
+    int frames = 2000;
+    MockScene scene = MOCK_SCENE_MIXED;
+    const char* scene_name = "mixed";
+    uint32_t seed = 1;
+    std::vector<std::string> inputs;
+    int sensor_fps = 30;
+    int loop_us = 5000;
+    int capture_ms = 2000;
+};
+
+static bool parse_args(int argc, char** argv, BenchOptions* opt) {
+    BenchArgs args("eyes_bench [--frames N] [--scene empty|pillar|mixed] [--seed S] [--input file.rgb565 ...]\n"
+                   "                  [--sensor-fps F] [--loop-us U] [--capture-ms T]");
+    args.option("--frames", &opt->frames);
+    args.option("--scene", [opt](const char* v) {
+        opt->scene_name = v;
+        return mock_scene_from_name(v, &opt->scene);
+    });
+    args.option("--seed", &opt->seed);
+    args.option("--input", &opt->inputs);
+    args.option("--sensor-fps", &opt->sensor_fps);
+    args.option("--loop-us", &opt->loop_us);
+    args.option("--capture-ms", &opt->capture_ms);
+    return args.parse(argc, argv, [opt] {
+        return opt->frames > 0 && opt->sensor_fps > 0 && opt->loop_us >= 0 && opt->capture_ms > 0;
+    });
+}
+
+// True if a packed class plane holds exactly the pixels set in a byte mask
+static bool plane_matches(const EyesMaskWord* planes, int plane, const uint8_t* mask, int width, int height) {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (eyes_mask_test(planes, plane, width, x, y) != (mask[y * width + x] != 0)) return false;
+        }
+    }
+    return true;
+}
+
+// Packs per-class byte masks into the class-interleaved word layout
+static void pack_planes(const std::vector<std::vector<uint8_t>>& masks, int width, int height,
+                        std::vector<EyesMaskWord>* planes) {
+    int words = eyes_mask_words(width);
+    planes->assign((size_t)height * EYES_NUM_CLASSES * words, 0);
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                if (masks[c][y * width + x]) {
+                    (*planes)[(y * EYES_NUM_CLASSES + c) * words + (x >> 5)] |= (EyesMaskWord)1 << (x & 31);
+                }
+            }
+        }
+    }
+}
+
+// Random masks at awkward sizes (partial words, 1-pixel images, borders):
+// separable byte close and packed close vs the brute-force close
+static bool verify_close_random() {
+    const int sizes[][2] = {{160, 120}, {37, 11}, {64, 3}, {33, 1}, {1, 9}, {95, 40}};
+    const int kernels[] = {1, 3, 4, 5, 7, 9, 15};
+    uint32_t rng = 12345;
+    int failures = 0;
+
+    for (const auto& size : sizes) {
+        int w = size[0], h = size[1];
+        for (int kernel : kernels)
+        for (int density = 5; density <= 80; density += 15) {
+            std::vector<std::vector<uint8_t>> masks(EYES_NUM_CLASSES, std::vector<uint8_t>(w * h));
+            for (auto& m : masks) {
+                for (uint8_t& px : m) {
+                    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+                    px = (int)(rng % 100) < density ? 255 : 0;
+                }
+            }
+            std::vector<EyesMaskWord> planes, temp;
+            pack_planes(masks, w, h, &planes);
+            temp.resize(planes.size());
+
+            eyes_packed_close(planes.data(), temp.data(), w, h, kernel);
+            for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+                std::vector<uint8_t> fast(masks[c]);
+                eyes_morphological_close(fast.data(), w, h, kernel);
+                eyes_ref_morphological_close(masks[c].data(), w, h, kernel);
+                if (fast != masks[c]) failures++;
+                if (!plane_matches(planes.data(), c, masks[c].data(), w, h)) failures++;
+            }
+        }
+    }
+    printf("verify: separable and packed close vs brute force, random masks, k=1..15: %s (%d failures)\n",
+           failures ? "FAIL" : "ok", failures);
+    return failures == 0;
+}
+
+static bool blob_equal(const EyesBlobInfo& a, const EyesBlobInfo& b) {
+    return a.pixel_count == b.pixel_count && a.x_sum == b.x_sum && a.y_sum == b.y_sum &&
+           a.x_min == b.x_min && a.x_max == b.x_max && a.y_min == b.y_min && a.y_max == b.y_max;
+}
+
+static void label_planes(const EyesMaskWord* planes, int width, int height, EyesLabeler* lab) {
+    int row_words = EYES_NUM_CLASSES * eyes_mask_words(width);
+    eyes_labeler_reset(lab, width);
+    for (int y = 0; y < height; y++) eyes_labeler_push_row(lab, planes + y * row_words);
+    eyes_labeler_finish(lab);
+}
+
+// Union-find queries vs the flood fill on the same (closed) byte mask
+static bool labels_match(const EyesLabeler* lab, int plane, uint8_t* mask, int width, int height, int max_blobs) {
+    EyesBlobInfo largest = eyes_find_largest_blob(lab, plane);
+    EyesBlobInfo ref_largest = eyes_ref_find_largest_blob(mask, width, height);
+    if (largest.pixel_count != ref_largest.pixel_count) return false;
+    if (largest.pixel_count && !blob_equal(largest, ref_largest)) return false;
+
+    std::vector<EyesBlobInfo> top(max_blobs), ref_top(max_blobs);
+    int n = eyes_find_top_n_blobs(lab, plane, top.data(), max_blobs);
+    int ref_n = eyes_ref_find_top_n_blobs(mask, width, height, ref_top.data(), max_blobs);
+    if (n != ref_n) return false;
+    for (int i = 0; i < n; i++) {
+        if (!blob_equal(top[i], ref_top[i])) return false;
+    }
+    return true;
+}
+
+// Random masks with blobs small enough that the flood fill does not truncate
+static bool verify_labels_random() {
+    const int sizes[][2] = {{160, 120}, {37, 11}, {64, 30}, {33, 1}, {1, 9}, {96, 40}};
+    uint32_t rng = 777;
+    int failures = 0;
+    EyesLabeler* lab = new EyesLabeler;
+
+    for (const auto& size : sizes) {
+        int w = size[0], h = size[1];
+        for (int density = 5; density <= 45; density += 10) {
+            std::vector<std::vector<uint8_t>> masks(EYES_NUM_CLASSES, std::vector<uint8_t>(w * h));
+            for (auto& m : masks) {
+                for (uint8_t& px : m) {
+                    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+                    px = (int)(rng % 100) < density ? 255 : 0;
+                }
+            }
+            std::vector<EyesMaskWord> planes;
+            pack_planes(masks, w, h, &planes);
+            label_planes(planes.data(), w, h, lab);
+            for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+                if (!labels_match(lab, c, masks[c].data(), w, h, EYES_MAX_BLOBS)) failures++;
+            }
+        }
+    }
+    delete lab;
+    printf("verify: union-find labels vs flood fill on random masks: %s (%d failures)\n",
+           failures ? "FAIL" : "ok", failures);
+    return failures == 0;
+}
+
+static bool tables_equal(const EyesLabeler* a, const EyesLabeler* b) {
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        if (a->blob_count[c] != b->blob_count[c] || a->blob_total[c] != b->blob_total[c]) return false;
+        for (int i = 0; i < a->blob_count[c]; i++) {
+            if (!blob_equal(a->blobs[c][i], b->blobs[c][i])) return false;
+        }
+    }
+    return true;
+}
+
+// Full-frame classify + close + label, the pre-streaming pipeline
+static void full_frame_labels(const uint8_t* buf, int width, int height, std::vector<EyesMaskWord>* planes,
+                              std::vector<EyesMaskWord>* temp, EyesLabeler* lab) {
+    size_t total = (size_t)height * EYES_NUM_CLASSES * eyes_mask_words(width);
+    planes->resize(total);
+    temp->resize(total);
+    eyes_classify_frame(buf, planes->data(), width, height);
+    eyes_packed_close(planes->data(), temp->data(), width, height, EYES_CLOSE_KERNEL);
+    label_planes(planes->data(), width, height, lab);
+}
+
+// Random target/background pixels at awkward sizes through both pipelines
+static bool verify_streaming_random() {
+    const int sizes[][2] = {{160, 120}, {37, 11}, {64, 3}, {33, 1}, {1, 9}, {95, 40}, {160, 2}};
+    const uint16_t palette[] = {0xFE45, 0xE1F5, 0x4208, 0x0000, 0xFFFF};  // Yellow, pink, grays
+    uint32_t rng = 4242;
+    int failures = 0;
+    EyesLabeler* full = new EyesLabeler;
+    EyesLabeler* streamed = new EyesLabeler;
+    EyesStream* st = new EyesStream;
+
+    for (const auto& size : sizes) {
+        int w = size[0], h = size[1];
+        for (int trial = 0; trial < 8; trial++) {
+            std::vector<uint8_t> frame(w * h * 2);
+            for (int i = 0; i < w * h; i++) {
+                rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+                uint16_t px = palette[rng % 5];
+                frame[i * 2] = px >> 8;
+                frame[i * 2 + 1] = px & 0xFF;
+            }
+            std::vector<EyesMaskWord> planes, temp;
+            full_frame_labels(frame.data(), w, h, &planes, &temp, full);
+            eyes_stream_frame(st, streamed, frame.data(), w, h);
+            if (!tables_equal(full, streamed)) failures++;
+        }
+    }
+    delete full;
+    delete streamed;
+    delete st;
+    printf("verify: streaming vs full-frame blob tables on random frames: %s (%d failures)\n",
+           failures ? "FAIL" : "ok", failures);
+    return failures == 0;
+}
+
+// Every RGB565 value through the original HSV loop vs the class LUT
+static bool verify_class_lut() {
+    int mismatches = 0;
+    for (uint32_t pixel = 0; pixel < 65536; pixel++) {
+        uint8_t buf[2] = {(uint8_t)(pixel >> 8), (uint8_t)(pixel & 0xFF)};
+        uint8_t ref_y, ref_p;
+        EyesMaskWord planes[EYES_NUM_CLASSES];
+        eyes_ref_classify_frame(buf, &ref_y, &ref_p, 1);
+        eyes_classify_frame(buf, planes, 1, 1);
+        if (!plane_matches(planes, EYES_PLANE_YELLOW, &ref_y, 1, 1) ||
+            !plane_matches(planes, EYES_PLANE_PINK, &ref_p, 1, 1)) mismatches++;
+    }
+    printf("verify: class LUT vs HSV over 65536 RGB565 values: %s (%d mismatches)\n",
+           mismatches ? "FAIL" : "ok", mismatches);
+    return mismatches == 0;
+}
+
+// Vector classifier vs scalar: every RGB565 value in one call, then the
+// values shuffled and cut into random runs (0..3 vectors long) from an odd
+// address, so unaligned loads and the scalar tail are covered too
+static bool verify_classify_vector(uint32_t seed) {
+    std::vector<uint16_t> values(65536);
+    for (uint32_t i = 0; i < 65536; i++) values[i] = (uint16_t)i;
+    std::vector<uint8_t> buf(65536 * 2 + 1), classes(65536);
+    uint32_t rng = seed | 1;
+    auto next = [&rng]() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; };
+    int mismatches = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        uint8_t* src = buf.data() + pass;  // Pass 1 starts on an odd byte
+        if (pass == 1) {
+            for (uint32_t i = 65535; i > 0; i--) std::swap(values[i], values[next() % (i + 1)]);
+        }
+        for (uint32_t i = 0; i < 65536; i++) {
+            src[i * 2] = values[i] >> 8;
+            src[i * 2 + 1] = values[i] & 0xFF;
+        }
+        if (pass == 0) {
+            eyes_classify_pixels(src, classes.data(), 65536);
+        } else {
+            for (int x = 0; x < 65536;) {
+                int n = min<int>(next() % (3 * EYES_VEC_LANES + 1), 65536 - x);
+                eyes_classify_pixels(src + x * 2, classes.data() + x, n);
+                x += n;
+            }
+        }
+        for (uint32_t i = 0; i < 65536; i++) mismatches += classes[i] != eyes_classify_pixel_hsv(values[i]);
+    }
+    printf("verify: vector classifier vs HSV, all 65536 values and shuffled random runs: %s (%d mismatches)\n",
+           mismatches ? "FAIL" : "ok", mismatches);
+    return mismatches == 0;
+}
+
+// Class LUT fill at eyes_init(): scalar classifier per value vs vector
+static void bench_lut_build(int repeats, BenchSamples* scalar, BenchSamples* vec) {
+    std::vector<uint8_t> lut(65536);
+    for (int i = 0; i < repeats; i++) {
+        uint64_t t0 = bench_now_ns();
+        for (uint32_t pixel = 0; pixel < 65536; pixel++) lut[pixel] = eyes_classify_pixel_hsv((uint16_t)pixel);
+        uint64_t t1 = bench_now_ns();
+        eyes_build_class_lut();
+        uint64_t t2 = bench_now_ns();
+        scalar->add(t1 - t0);
+        vec->add(t2 - t1);
+    }
+}
+
+// Classification alone: original HSV loop vs vector kernel vs LUT, masks
+// compared every frame
+static bool bench_classify(const BenchOptions& opt, BenchSamples* hsv, BenchSamples* vec, BenchSamples* lut) {
+    const int w = EYES_IMG_WIDTH, h = EYES_IMG_HEIGHT, n = w * h;
+    std::vector<uint8_t> ref_y(n), ref_p(n), classes(n);
+    std::vector<EyesMaskWord> planes(EYES_MASK_TOTAL_WORDS);
+    bool exact = true;
+
+    for (int f = 0; f < opt.frames; f++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) break;
+
+        uint64_t t0 = bench_now_ns();
+        eyes_ref_classify_frame(fb->buf, ref_y.data(), ref_p.data(), n);
+        uint64_t t1 = bench_now_ns();
+        eyes_classify_pixels(fb->buf, classes.data(), n);
+        uint64_t t2 = bench_now_ns();
+        eyes_classify_frame(fb->buf, planes.data(), w, h);
+        uint64_t t3 = bench_now_ns();
+
+        hsv->add(t1 - t0);
+        vec->add(t2 - t1);
+        lut->add(t3 - t2);
+        exact = exact && plane_matches(planes.data(), EYES_PLANE_YELLOW, ref_y.data(), w, h) &&
+                plane_matches(planes.data(), EYES_PLANE_PINK, ref_p.data(), w, h);
+        for (int i = 0; i < n && exact; i++) {
+            exact = ((classes[i] >> EYES_PLANE_YELLOW) & 1) == (ref_y[i] != 0) &&
+                    ((classes[i] >> EYES_PLANE_PINK) & 1) == (ref_p[i] != 0);
+        }
+        esp_camera_fb_return(fb);
+    }
+    return exact;
+}
+
+// Close cost vs kernel size: brute force, separable byte masks, packed planes
+static void bench_kernel_sweep(const BenchOptions& opt) {
+    const int w = EYES_IMG_WIDTH, h = EYES_IMG_HEIGHT, n = w * h;
+    const int frames = min(opt.frames, 200);  // Brute force 9x9 is slow
+    std::vector<uint8_t> ref_y(n), ref_p(n);
+    std::vector<EyesMaskWord> planes(EYES_MASK_TOTAL_WORDS), temp(EYES_MASK_TOTAL_WORDS);
+
+    printf("close kernel sweep, mean us over %d frames (yellow+pink)\n", frames);
+    printf("%-8s %14s %14s %14s\n", "kernel", "brute force", "separable", "packed");
+    for (int kernel = 3; kernel <= 9; kernel += 2) {
+        BenchSamples brute("brute"), separable("separable"), packed("packed");
+        for (int f = 0; f < frames; f++) {
+            camera_fb_t* fb = esp_camera_fb_get();
+            if (!fb) break;
+
+            eyes_ref_classify_frame(fb->buf, ref_y.data(), ref_p.data(), n);
+            uint64_t t0 = bench_now_ns();
+            eyes_ref_morphological_close(ref_y.data(), w, h, kernel);
+            eyes_ref_morphological_close(ref_p.data(), w, h, kernel);
+            uint64_t t1 = bench_now_ns();
+
+            eyes_ref_classify_frame(fb->buf, ref_y.data(), ref_p.data(), n);
+            uint64_t t2 = bench_now_ns();
+            eyes_morphological_close(ref_y.data(), w, h, kernel);
+            eyes_morphological_close(ref_p.data(), w, h, kernel);
+            uint64_t t3 = bench_now_ns();
+
+            eyes_classify_frame(fb->buf, planes.data(), w, h);
+            uint64_t t4 = bench_now_ns();
+            eyes_packed_close(planes.data(), temp.data(), w, h, kernel);
+            uint64_t t5 = bench_now_ns();
+
+            brute.add(t1 - t0);
+            separable.add(t3 - t2);
+            packed.add(t5 - t4);
+            esp_camera_fb_return(fb);
+        }
+        char label[16];
+        snprintf(label, sizeof(label), "%dx%d", kernel, kernel);
+        printf("%-8s %14.2f %14.2f %14.2f\n", label, brute.mean_us(), separable.mean_us(), packed.mean_us());
+    }
+}
+
+// Labeling: two flood fills (largest yellow, top 5 pink) vs one union-find scan
+static bool bench_labels(const BenchOptions& opt, BenchSamples* flood, BenchSamples* union_find) {
+    const int w = EYES_IMG_WIDTH, h = EYES_IMG_HEIGHT, n = w * h;
+    std::vector<uint8_t> ref_y(n), ref_p(n);
+    std::vector<EyesMaskWord> planes(EYES_MASK_TOTAL_WORDS), temp(EYES_MASK_TOTAL_WORDS);
+    EyesLabeler* lab = new EyesLabeler;
+    EyesBlobInfo ref_pink[5], pink[5];
+    bool exact = true;
+
+    for (int f = 0; f < opt.frames; f++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) break;
+        eyes_ref_classify_frame(fb->buf, ref_y.data(), ref_p.data(), n);
+        eyes_ref_morphological_close(ref_y.data(), w, h, EYES_CLOSE_KERNEL);
+        eyes_ref_morphological_close(ref_p.data(), w, h, EYES_CLOSE_KERNEL);
+        eyes_classify_frame(fb->buf, planes.data(), w, h);
+        eyes_packed_close(planes.data(), temp.data(), w, h, EYES_CLOSE_KERNEL);
+
+        uint64_t t0 = bench_now_ns();
+        EyesBlobInfo ref_yellow = eyes_ref_find_largest_blob(ref_y.data(), w, h);
+        int ref_n = eyes_ref_find_top_n_blobs(ref_p.data(), w, h, ref_pink, 5);
+        uint64_t t1 = bench_now_ns();
+        label_planes(planes.data(), w, h, lab);
+        EyesBlobInfo yellow = eyes_find_largest_blob(lab, EYES_PLANE_YELLOW);
+        int pink_n = eyes_find_top_n_blobs(lab, EYES_PLANE_PINK, pink, 5);
+        uint64_t t2 = bench_now_ns();
+
+        flood->add(t1 - t0);
+        union_find->add(t2 - t1);
+        // No blob: the flood fill leaves its min corner at (width, height)
+        exact = exact && yellow.pixel_count == ref_yellow.pixel_count && pink_n == ref_n;
+        exact = exact && (yellow.pixel_count == 0 || blob_equal(yellow, ref_yellow));
+        for (int i = 0; exact && i < pink_n; i++) exact = blob_equal(pink[i], ref_pink[i]);
+        esp_camera_fb_return(fb);
+    }
+    delete lab;
+    return exact;
+}
+
+// Full-frame stages back to back vs the row-streaming pipeline
+static bool bench_streaming(const BenchOptions& opt, BenchSamples* full, BenchSamples* streaming) {
+    const int w = EYES_IMG_WIDTH, h = EYES_IMG_HEIGHT;
+    std::vector<EyesMaskWord> planes, temp;
+    EyesLabeler* full_lab = new EyesLabeler;
+    EyesLabeler* stream_lab = new EyesLabeler;
+    EyesStream* st = new EyesStream;
+    bool exact = true;
+
+    for (int f = 0; f < opt.frames; f++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) break;
+
+        uint64_t t0 = bench_now_ns();
+        full_frame_labels(fb->buf, w, h, &planes, &temp, full_lab);
+        uint64_t t1 = bench_now_ns();
+        eyes_stream_frame(st, stream_lab, fb->buf, w, h);
+        uint64_t t2 = bench_now_ns();
+
+        full->add(t1 - t0);
+        streaming->add(t2 - t1);
+        exact = exact && tables_equal(full_lab, stream_lab);
+        esp_camera_fb_return(fb);
+    }
+    delete full_lab;
+    delete stream_lab;
+    delete st;
+    return exact;
+}
+
+// 3x3 close: two byte masks closed separately vs both packed planes at once
+static bool bench_close(const BenchOptions& opt, BenchSamples* bytes, BenchSamples* packed) {
+    const int w = EYES_IMG_WIDTH, h = EYES_IMG_HEIGHT, n = w * h;
+    std::vector<uint8_t> ref_y(n), ref_p(n);
+    std::vector<EyesMaskWord> planes(EYES_MASK_TOTAL_WORDS), temp(EYES_MASK_TOTAL_WORDS);
+    bool exact = true;
+
+    for (int f = 0; f < opt.frames; f++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) break;
+        eyes_ref_classify_frame(fb->buf, ref_y.data(), ref_p.data(), n);
+        eyes_classify_frame(fb->buf, planes.data(), w, h);
+
+        uint64_t t0 = bench_now_ns();
+        eyes_ref_morphological_close(ref_y.data(), w, h, 3);
+        eyes_ref_morphological_close(ref_p.data(), w, h, 3);
+        uint64_t t1 = bench_now_ns();
+        eyes_packed_close(planes.data(), temp.data(), w, h, 3);
+        uint64_t t2 = bench_now_ns();
+
+        bytes->add(t1 - t0);
+        packed->add(t2 - t1);
+        exact = exact && plane_matches(planes.data(), EYES_PLANE_YELLOW, ref_y.data(), w, h) &&
+                plane_matches(planes.data(), EYES_PLANE_PINK, ref_p.data(), w, h);
+        esp_camera_fb_return(fb);
+    }
+    return exact;
+}
+
+// Whole pipeline through the public API, camera included
+static void bench_pipeline(const BenchOptions& opt, BenchSamples* frame) {
+    uint32_t seen[EYES_NUM_CLASSES] = {0}, blobs[EYES_NUM_CLASSES] = {0};
+
+    for (int f = 0; f < opt.frames; f++) {
+        uint64_t t0 = bench_now_ns();
+        eyes_snap();
+        frame->add(bench_now_ns() - t0);
+
+        for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+            seen[c] += eyes_get_count(c) > 0;
+            blobs[c] += eyes_get_count(c);
+        }
+        eyes_release();
+    }
+
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        printf("detections: %s in %u/%d frames, %.2f blobs/frame\n",
+               EYES_TARGETS[c].name, seen[c], opt.frames, (double)blobs[c] / opt.frames);
+    }
+    printf("\n");
+}
+
+// The profiler's own view of the bench_pipeline() frames, and what its
+// probes cost: one counter read, one row split plus commit and one capture
+// sample timed back to back (an upper bound, in the pipeline the reads
+// overlap other work), scaled by the reads the sampled rows took per
+// frame, against the frame time. Stage boundaries are read for stage_us
+// anyway, so they are free.
+static bool bench_profile(const BenchSamples& frame) {
+    printf("%-28s %10s %10s %10s %10s %10s\n", "profile (us)", "frames", "mean", "p50", "p99", "max");
+    double staged_us = 0;
+    for (int s = 0; s < EYES_PROF_STAGES; s++) {
+        const EyesProfStage* p = eyes_get_profile(s);
+        double mean = p->count ? (double)p->total_us / p->count : 0;
+        if (s != EYES_PROF_CAPTURE) staged_us += mean;
+        printf("  %-26s %10u %10.2f %10u %10u %10u\n", EYES_PROF_NAMES[s], p->count, mean,
+               eyes_get_profile_percentile(s, 50), eyes_get_profile_percentile(s, 99), p->max_us);
+    }
+    printf("profiled stages: %.2f us of a %.2f us frame\n", staged_us, frame.mean_us());
+
+    // 4 reads per sampled row: its start and one lap per stage
+    EyesProfiler* prof = eyes_pipeline.profiler();
+    uint32_t frames = prof->stages[EYES_PROF_FILTER].count;
+    double reads = frames ? 4.0 * prof->rows_lapped / frames : 0;
+
+    const int reps = 200000;
+    volatile uint32_t sink = 0;
+    uint64_t t0 = bench_now_ns();
+    for (int i = 0; i < reps; i++) sink = sink + ESP.getCycleCount();
+    double read_ns = (double)(bench_now_ns() - t0) / reps;
+    t0 = bench_now_ns();
+    for (int i = 0; i < reps / 100; i++) {
+        EYES_PROF_ROWS_END(prof, 1000);
+        EYES_PROF_COMMIT(prof);
+    }
+    double commit_ns = (double)(bench_now_ns() - t0) / (reps / 100);
+    t0 = bench_now_ns();
+    for (int i = 0; i < reps / 100; i++) EYES_PROF_SAMPLE(prof, EYES_PROF_CAPTURE, i & 0xFF);
+    double sample_ns = (double)(bench_now_ns() - t0) / (reps / 100);
+    eyes_profile_reset();
+
+    double overhead = (reads * read_ns + commit_ns + sample_ns) / (frame.mean_us() * 1000);
+    printf("probe cost: %.1f ns per counter read x %.1f + %.1f ns commit + %.1f ns capture sample = %.2f%% of a frame\n",
+           read_ns, reads, commit_ns, sample_ns, overhead * 100);
+    bool ok = overhead < 0.01;
+    printf("verify: profiling overhead under 1%% of a frame: %s\n\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Full-frame stage functions timed piece by piece (eyes_process_frame()
+// runs the same stages fused row by row, see bench_streaming())
+static void bench_stages(const BenchOptions& opt, std::vector<BenchSamples>* stages) {
+    const int w = EYES_IMG_WIDTH, h = EYES_IMG_HEIGHT;
+    std::vector<EyesMaskWord> masks(EYES_MASK_TOTAL_WORDS), temp(EYES_MASK_TOTAL_WORDS);
+    EyesLabeler* lab = new EyesLabeler;
+    EyesBlobInfo pink_blobs[5];
+
+    for (int f = 0; f < opt.frames; f++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) break;
+
+        uint64_t t0 = bench_now_ns();
+        eyes_classify_frame(fb->buf, masks.data(), w, h);
+        uint64_t t1 = bench_now_ns();
+        eyes_packed_close(masks.data(), temp.data(), w, h, EYES_CLOSE_KERNEL);
+        uint64_t t2 = bench_now_ns();
+        label_planes(masks.data(), w, h, lab);
+        uint64_t t3 = bench_now_ns();
+        EyesBlobInfo yellow = eyes_find_largest_blob(lab, EYES_PLANE_YELLOW);
+        int n = eyes_find_top_n_blobs(lab, EYES_PLANE_PINK, pink_blobs, 5);
+        uint64_t t4 = bench_now_ns();
+
+        (*stages)[0].add(t1 - t0);
+        (*stages)[1].add(t2 - t1);
+        (*stages)[2].add(t3 - t2);
+        (*stages)[3].add(t4 - t3);
+
+        esp_camera_fb_return(fb);
+        (void)yellow;
+        (void)n;
+    }
+    delete lab;
+}
+
+// ROI tracking vs full frames over the same sequence: time per frame and
+// how far the tracked detections drift from the full-frame ones
+static void bench_tracking(const BenchOptions& opt, MockFrameListSource* source) {
+    BenchSamples full("frame: full (tracking off)"), tracked("frame: tracking on");
+    std::vector<uint8_t> found_full(opt.frames);
+    std::vector<int16_t> offset_full(opt.frames);
+
+    eyes_set_tracking(false);
+    source->rewind();
+    for (int f = 0; f < opt.frames; f++) {
+        uint64_t t0 = bench_now_ns();
+        eyes_snap();
+        full.add(bench_now_ns() - t0);
+        found_full[f] = eyes_get_yellow_found();
+        offset_full[f] = eyes_get_yellow_offset_x();
+        eyes_release();
+    }
+
+    int windowed = 0, found_mismatch = 0, max_offset_diff = 0;
+    long window_columns = 0;
+    eyes_set_tracking(true);
+    source->rewind();
+    for (int f = 0; f < opt.frames; f++) {
+        uint64_t t0 = bench_now_ns();
+        eyes_snap();
+        tracked.add(bench_now_ns() - t0);
+        if (!eyes_get_full_frame()) {
+            windowed++;
+            const EyesResult& res = eyes_pipeline.result();
+            window_columns += res.roi_x_max - res.roi_x_min + 1;
+        }
+        if (eyes_get_yellow_found() != (found_full[f] != 0)) {
+            found_mismatch++;
+        } else if (found_full[f]) {
+            max_offset_diff = max(max_offset_diff, abs(eyes_get_yellow_offset_x() - offset_full[f]));
+        }
+        eyes_release();
+    }
+    eyes_set_tracking(false);
+
+    printf("tracking: %d/%d frames windowed, mean window %.1f of %d columns\n", windowed, opt.frames,
+           windowed ? (double)window_columns / windowed : 0.0, EYES_IMG_WIDTH);
+    printf("tracking: yellow found differs on %d frames, max offset difference %d px\n",
+           found_mismatch, max_offset_diff);
+    BenchSamples::print_header();
+    full.print_row();
+    tracked.print_row();
+    printf("tracking speedup (mean): %.2fx\n\n", full.mean_us() / tracked.mean_us());
+}
+
+// Coarse-to-fine vs classifying every pixel over the same sequence
+static void bench_coarse(const BenchOptions& opt, MockFrameListSource* source) {
+    struct Detections {
+        bool yellow;
+        int16_t yellow_offset;
+        uint32_t yellow_area;
+        uint8_t pink;
+        int16_t pink_offset[2];
+    };
+    BenchSamples full("frame: every pixel"), coarse("frame: coarse-to-fine");
+    std::vector<Detections> reference(opt.frames);
+
+    eyes_set_coarse_to_fine(false);
+    source->rewind();
+    for (int f = 0; f < opt.frames; f++) {
+        uint64_t t0 = bench_now_ns();
+        eyes_snap();
+        full.add(bench_now_ns() - t0);
+        reference[f] = {eyes_get_yellow_found(), eyes_get_yellow_offset_x(), eyes_get_yellow_area(),
+                        eyes_get_pink_count(), {eyes_get_pink_offset_x(0), eyes_get_pink_offset_x(1)}};
+        eyes_release();
+    }
+
+    // Tile coverage of the coarse pass, measured separately
+    const int tiles_per_frame = EYES_MASK_WORDS * EYES_TILE_GRID_ROWS;
+    EyesTileMask tiles[EYES_TILE_GRID_ROWS];
+    long fine_tiles = 0;
+    int empty_frames = 0, mismatches = 0, missed_small = 0;
+
+    eyes_set_coarse_to_fine(true);
+    source->rewind();
+    for (int f = 0; f < opt.frames; f++) {
+        uint64_t t0 = bench_now_ns();
+        eyes_snap();
+        coarse.add(bench_now_ns() - t0);
+
+        int n = eyes_coarse_tiles(eyes_get_framebuffer()->buf, EYES_IMG_WIDTH, EYES_IMG_HEIGHT,
+                                  EYES_IMG_WIDTH * 2, tiles);
+        fine_tiles += n;
+        empty_frames += (n == 0);
+
+        const Detections& r = reference[f];
+        Detections d = {eyes_get_yellow_found(), eyes_get_yellow_offset_x(), eyes_get_yellow_area(),
+                        eyes_get_pink_count(), {eyes_get_pink_offset_x(0), eyes_get_pink_offset_x(1)}};
+        if (d.yellow != r.yellow || d.yellow_offset != r.yellow_offset || d.yellow_area != r.yellow_area ||
+            d.pink != r.pink || d.pink_offset[0] != r.pink_offset[0] || d.pink_offset[1] != r.pink_offset[1]) {
+            mismatches++;
+            // Expected miss: a yellow blob small enough to sit between samples
+            bool small = r.yellow && !d.yellow && r.yellow_area < EYES_COARSE_STEP * EYES_COARSE_STEP &&
+                         d.pink == r.pink;
+            missed_small += small;
+        }
+        eyes_release();
+    }
+
+    printf("coarse-to-fine: step %d, %d of %d tiles classified in full on average, %d/%d frames skipped the fine pass\n",
+           EYES_COARSE_STEP, (int)(fine_tiles / opt.frames), tiles_per_frame, empty_frames, opt.frames);
+    printf("coarse-to-fine: detections differ from every-pixel results on %d/%d frames (%d: yellow blob under %d px missed)\n",
+           mismatches, opt.frames, missed_small, EYES_COARSE_STEP * EYES_COARSE_STEP);
+    BenchSamples::print_header();
+    full.print_row();
+    coarse.print_row();
+    printf("coarse-to-fine speedup (mean): %.2fx\n\n", full.mean_us() / coarse.mean_us());
+}
+
+struct CaptureRun {
+    double seconds;
+    uint32_t loops;
+    uint32_t fresh;        // Loop iterations that saw a new result
+    uint32_t processed;    // Frames the pipeline finished
+    uint32_t sensor;       // Frames the sensor delivered
+    BenchSamples age;      // Frame timestamp -> decision
+
+    CaptureRun() : seconds(0), loops(0), fresh(0), processed(0), sensor(0), age("result age") {}
+};
+
+// captureMode()-style loop against the mock sensor: pick up a result, act
+// on it, then opt.loop_us of other work (drive, LEDs, IR)
+static void run_capture_loop(const BenchOptions& opt, bool async, CaptureRun* run) {
+    mock_camera_start_sensor(1000000 / opt.sensor_fps);
+    if (async) eyes_start_async();
+
+    uint32_t first_frame = eyes_get_frame_number();
+    uint64_t t0 = bench_now_ns();
+    uint64_t end = t0 + (uint64_t)opt.capture_ms * 1000000;
+    while (bench_now_ns() < end) {
+        bool fresh;
+        if (async) {
+            fresh = eyes_latest();
+        } else {
+            eyes_snap();
+            fresh = eyes_get_framebuffer() != NULL;
+        }
+        if (fresh) {
+            run->fresh++;
+            run->age.add((uint64_t)(micros() - eyes_get_frame_timestamp_us()) * 1000);
+        }
+        eyes_release();
+        run->loops++;
+        if (opt.loop_us) delayMicroseconds(opt.loop_us);
+    }
+    run->seconds = (bench_now_ns() - t0) / 1e9;
+
+    if (async) eyes_stop_async();
+    eyes_latest();  // Final count includes frames the loop never picked up
+    run->processed = eyes_get_frame_number() - first_frame;
+    eyes_release();
+    mock_camera_stop_sensor();
+    run->sensor = mock_camera_sensor_frames();
+}
+
+static void print_capture_run(const char* name, const CaptureRun& run) {
+    printf("%-28s %10.1f %10.1f %10.1f %10.1f %10.2f %10.2f\n", name,
+           run.loops / run.seconds, run.fresh / run.seconds, run.processed / run.seconds,
+           run.sensor / run.seconds, run.age.mean_us() / 1000, run.age.percentile_us(99) / 1000);
+}
+
+static void bench_capture_modes(const BenchOptions& opt) {
+    CaptureRun sync_run, async_run;
+    run_capture_loop(opt, false, &sync_run);
+    run_capture_loop(opt, true, &async_run);
+
+    printf("capture: mock sensor at %d fps, %d us of other work per loop, %d ms per mode\n",
+           opt.sensor_fps, opt.loop_us, opt.capture_ms);
+    printf("%-28s %10s %10s %10s %10s %10s %10s\n", "mode (per second)", "loops", "new res", "processed",
+           "sensor", "age ms", "age p99");
+    print_capture_run("sync (eyes_snap)", sync_run);
+    print_capture_run("async (vision task)", async_run);
+    printf("loop rate gain: %.2fx, vision throughput gain: %.2fx\n\n",
+           (async_run.loops / async_run.seconds) / (sync_run.loops / sync_run.seconds),
+           (async_run.processed / async_run.seconds) / (sync_run.processed / sync_run.seconds));
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    if (!parse_args(argc, argv, &opt)) return 2;
+
+    MockFrameListSource source(EYES_IMG_WIDTH, EYES_IMG_HEIGHT, true);
+    if (opt.inputs.empty()) {
+        mock_render_scene(opt.scene, 120, opt.seed, &source);
+    } else {
+        for (const std::string& path : opt.inputs) {
+            if (mock_load_rgb565_file(path, &source) == 0) {
+                fprintf(stderr, "eyes_bench: no %dx%d frames in %s\n", EYES_IMG_WIDTH, EYES_IMG_HEIGHT, path.c_str());
+                return 1;
+            }
+        }
+    }
+    mock_camera_set_source(&source);
+
+    if (!eyes_init()) {
+        fprintf(stderr, "eyes_bench: eyes_init() failed\n");
+        return 1;
+    }
+
+    printf("eyes_bench: %dx%d, %s, %zu distinct frames, %d iterations\n",
+           EYES_IMG_WIDTH, EYES_IMG_HEIGHT,
+           opt.inputs.empty() ? opt.scene_name : "recorded input",
+           source.frame_count(), opt.frames);
+
+    BenchSamples frame("frame (eyes_snap)");
+    eyes_profile_reset();
+    bench_pipeline(opt, &frame);
+
+    std::vector<BenchSamples> stages;
+    stages.emplace_back("  classify");
+    stages.emplace_back("  close (yellow+pink)");
+    stages.emplace_back("  label (all classes)");
+    stages.emplace_back("  blob queries");
+    source.rewind();
+    bench_stages(opt, &stages);
+
+    BenchSamples::print_header();
+    frame.print_row();
+    for (const BenchSamples& s : stages) s.print_row();
+
+    printf("\n");
+    bool profile_ok = bench_profile(frame);
+    bool ok = verify_class_lut();
+    ok = verify_classify_vector(opt.seed) && ok;
+
+    BenchSamples hsv("classify: HSV per pixel"), vec("classify: HSV vector"), lut("classify: class LUT");
+    source.rewind();
+    bool exact = bench_classify(opt, &hsv, &vec, &lut);
+    printf("verify: vector and LUT masks identical to HSV masks on every frame: %s\n\n", exact ? "ok" : "FAIL");
+    BenchSamples::print_header();
+    hsv.print_row();
+    vec.print_row();
+    lut.print_row();
+    printf("vector speedup (mean): %.2fx, LUT speedup (mean): %.2fx\n\n", hsv.mean_us() / vec.mean_us(),
+           hsv.mean_us() / lut.mean_us());
+
+    BenchSamples lut_scalar("LUT build: scalar"), lut_vec("LUT build: vector");
+    bench_lut_build(20, &lut_scalar, &lut_vec);
+    BenchSamples::print_header();
+    lut_scalar.print_row();
+    lut_vec.print_row();
+    printf("LUT build speedup (mean): %.2fx\n\n", lut_scalar.mean_us() / lut_vec.mean_us());
+
+    BenchSamples byte_close("close: 2 byte masks (brute)"), packed_close("close: packed planes");
+    source.rewind();
+    bool close_exact = bench_close(opt, &byte_close, &packed_close);
+    close_exact = verify_close_random() && close_exact;
+    printf("verify: packed close identical to byte close on every frame: %s\n", close_exact ? "ok" : "FAIL");
+    printf("mask memory: %d bytes as bytes (+%d temp), %d bytes packed (+%d temp)\n\n",
+           2 * EYES_IMG_WIDTH * EYES_IMG_HEIGHT, EYES_IMG_WIDTH * EYES_IMG_HEIGHT,
+           (int)(EYES_MASK_TOTAL_WORDS * sizeof(EyesMaskWord)), (int)(EYES_MASK_TOTAL_WORDS * sizeof(EyesMaskWord)));
+    BenchSamples::print_header();
+    byte_close.print_row();
+    packed_close.print_row();
+    printf("packed close speedup (mean): %.2fx\n\n", byte_close.mean_us() / packed_close.mean_us());
+
+    BenchSamples flood("label: 2 flood fills"), union_find("label: union-find");
+    source.rewind();
+    bool labels_exact = bench_labels(opt, &flood, &union_find);
+    printf("verify: union-find results identical to flood fill on every frame: %s\n", labels_exact ? "ok" : "FAIL");
+    labels_exact = verify_labels_random() && labels_exact;
+    printf("\n");
+    BenchSamples::print_header();
+    flood.print_row();
+    union_find.print_row();
+    printf("union-find speedup (mean): %.2fx\n\n", flood.mean_us() / union_find.mean_us());
+
+    BenchSamples full("full-frame stages"), streaming("streaming rows");
+    source.rewind();
+    bool stream_exact = bench_streaming(opt, &full, &streaming);
+    printf("verify: streaming blob tables identical to full-frame on every frame: %s\n", stream_exact ? "ok" : "FAIL");
+    stream_exact = verify_streaming_random() && stream_exact;
+    printf("mask state: %d bytes full-frame (masks + temp), %d bytes streaming (row rings)\n\n",
+           (int)(2 * EYES_MASK_TOTAL_WORDS * sizeof(EyesMaskWord)), (int)sizeof(EyesStream));
+    BenchSamples::print_header();
+    full.print_row();
+    streaming.print_row();
+    printf("\n");
+
+    source.rewind();
+    bench_kernel_sweep(opt);
+
+    bench_coarse(opt, &source);
+    bench_tracking(opt, &source);
+
+    source.rewind();
+    bench_capture_modes(opt);
+
+    return (ok && profile_ok && exact && close_exact && labels_exact && stream_exact) ? 0 : 1;
+}
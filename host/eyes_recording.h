@@ -0,0 +1,265 @@
+/* EYES_RECORDING.H - Recorded camera frames for offline runs, host only
+ *
+ * RecordingWriter appends frames (and the EyesResult computed for them)
+ * to a .eyrec file; RecordingReader maps one into memory; and
+ * MockRecordingSource serves a recording to the esp_camera shim, so the
+ * unmodified eyes_snap() replays it as fast as the CPU allows.
+ * viewer.py writes the same format from the robot's stream.
+ *
+ * File layout (little-endian, fixed-size records, so frame i is at
+ * header_bytes + i * record_bytes and no separate index is needed):
+ *   EyesRecordHeader    64 bytes
+ *   record 0..N-1       record_bytes each:
+ *     EyesRecordFrame   frame_number, timestamp_us, has_result
+ *     EyesRecordResult  at result_offset (counts, detections, timings)
+ *     pixels            at pixel_offset, width * height * 2, RGB565 camera byte order
+ * frame_count is patched in on close; a file whose writer never closed
+ * it (frame_count 0) is read up to its last whole record.
+ *
+ * Include after eyes.h: the result block is sized by EYES_NUM_CLASSES,
+ * EYES_MAX_DETECTIONS and EYES_NUM_STAGES, which the header records and
+ * the reader checks.
+ */
+
+#ifndef EYES_RECORDING_H
+#define EYES_RECORDING_H
+
+#include "mock_camera.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+
+#define EYES_RECORD_MAGIC "EYRC"
+#define EYES_RECORD_VERSION 2  // 2: 32-bit detection area
+#define EYES_RECORD_RGB565 0  // pixel_format: RGB565, camera byte order
+#define EYES_RECORD_ALIGN 8
+
+struct __attribute__((packed)) EyesRecordHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t header_bytes;
+    uint16_t width, height;
+    uint8_t pixel_format;
+    uint8_t num_classes, max_detections, num_stages;
+    uint32_t frame_count;
+    uint32_t record_bytes;
+    uint32_t result_offset;    // Within a record
+    uint32_t pixel_offset;     // Within a record
+    uint8_t reserved[32];
+};
+
+struct __attribute__((packed)) EyesRecordFrame {
+    uint32_t frame_number;
+    uint32_t timestamp_us;     // Sensor timestamp (EyesResult.capture_us)
+    uint8_t has_result;        // 0: pixels only
+    uint8_t reserved[3];
+};
+
+struct __attribute__((packed)) EyesRecordResult {
+    uint8_t count[EYES_NUM_CLASSES];
+    EyesDetection blobs[EYES_NUM_CLASSES][EYES_MAX_DETECTIONS];
+    uint32_t process_time_ms;
+    int16_t roi_x_min, roi_x_max;
+    uint16_t stage_us[EYES_NUM_STAGES];
+};
+
+static_assert(sizeof(EyesRecordHeader) == 64, "Header is 64 bytes on disk");
+static_assert(sizeof(EyesDetection) == 16, "Detections are stored as 16-bit fields with a 32-bit area");
+
+inline uint32_t eyes_record_align(uint32_t n) {
+    return (n + EYES_RECORD_ALIGN - 1) / EYES_RECORD_ALIGN * EYES_RECORD_ALIGN;
+}
+
+inline EyesRecordHeader eyes_record_header(int width, int height) {
+    EyesRecordHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, EYES_RECORD_MAGIC, 4);
+    h.version = EYES_RECORD_VERSION;
+    h.header_bytes = sizeof(EyesRecordHeader);
+    h.width = width;
+    h.height = height;
+    h.pixel_format = EYES_RECORD_RGB565;
+    h.num_classes = EYES_NUM_CLASSES;
+    h.max_detections = EYES_MAX_DETECTIONS;
+    h.num_stages = EYES_NUM_STAGES;
+    h.result_offset = sizeof(EyesRecordFrame);
+    h.pixel_offset = eyes_record_align(h.result_offset + sizeof(EyesRecordResult));
+    h.record_bytes = eyes_record_align(h.pixel_offset + width * height * 2);
+    return h;
+}
+
+inline void eyes_record_pack_result(const EyesResult* res, EyesRecordResult* out) {
+    memcpy(out->count, res->count, sizeof(out->count));
+    memcpy(out->blobs, res->blobs, sizeof(out->blobs));
+    out->process_time_ms = res->process_time_ms;
+    out->roi_x_min = res->roi_x_min;
+    out->roi_x_max = res->roi_x_max;
+    memcpy(out->stage_us, res->stage_us, sizeof(out->stage_us));
+}
+
+inline void eyes_record_unpack_result(const EyesRecordResult* rec, uint32_t frame_number, uint32_t timestamp_us,
+                                      EyesResult* out) {
+    memset(out, 0, sizeof(*out));
+    memcpy(out->count, rec->count, sizeof(out->count));
+    memcpy(out->blobs, rec->blobs, sizeof(out->blobs));
+    out->frame_number = frame_number;
+    out->process_time_ms = rec->process_time_ms;
+    out->capture_us = timestamp_us;
+    out->roi_x_min = rec->roi_x_min;
+    out->roi_x_max = rec->roi_x_max;
+    memcpy(out->stage_us, rec->stage_us, sizeof(out->stage_us));
+}
+
+// WRITER
+class RecordingWriter {
+public:
+    ~RecordingWriter() { close(); }
+
+    bool open(const std::string& path, int width, int height) {
+        close();
+        file_ = fopen(path.c_str(), "wb");
+        if (!file_) return false;
+        header_ = eyes_record_header(width, height);
+        record_.assign(header_.record_bytes, 0);
+        return fwrite(&header_, sizeof(header_), 1, file_) == 1;
+    }
+
+    // result may be NULL (pixels only)
+    bool add(uint32_t frame_number, uint32_t timestamp_us, const uint8_t* pixels, const EyesResult* result) {
+        if (!file_) return false;
+        std::fill(record_.begin(), record_.end(), 0);
+        EyesRecordFrame* frame = (EyesRecordFrame*)record_.data();
+        frame->frame_number = frame_number;
+        frame->timestamp_us = timestamp_us;
+        frame->has_result = result != NULL;
+        if (result) eyes_record_pack_result(result, (EyesRecordResult*)(record_.data() + header_.result_offset));
+        memcpy(record_.data() + header_.pixel_offset, pixels, header_.width * header_.height * 2);
+        if (fwrite(record_.data(), record_.size(), 1, file_) != 1) return false;
+        header_.frame_count++;
+        return true;
+    }
+
+    // Patches frame_count into the header
+    bool close() {
+        if (!file_) return true;
+        bool ok = fseek(file_, 0, SEEK_SET) == 0 && fwrite(&header_, sizeof(header_), 1, file_) == 1;
+        ok = fclose(file_) == 0 && ok;
+        file_ = NULL;
+        return ok;
+    }
+
+    uint32_t frame_count() const { return header_.frame_count; }
+
+private:
+    FILE* file_ = NULL;
+    EyesRecordHeader header_;
+    std::vector<uint8_t> record_;
+};
+
+// READER - the whole file mapped read-only; frames are served in place
+class RecordingReader {
+public:
+    ~RecordingReader() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(EyesRecordHeader)) {
+            ::close(fd);
+            return false;
+        }
+        size_ = st.st_size;
+        void* map = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) return false;
+        data_ = (const uint8_t*)map;
+
+        memcpy(&header_, data_, sizeof(header_));
+        if (memcmp(header_.magic, EYES_RECORD_MAGIC, 4) != 0 || header_.version != EYES_RECORD_VERSION ||
+            header_.header_bytes < sizeof(header_) || header_.header_bytes > size_ ||
+            header_.pixel_format != EYES_RECORD_RGB565 || header_.record_bytes == 0 ||
+            header_.pixel_offset + header_.width * header_.height * 2 > header_.record_bytes) {
+            close();
+            return false;
+        }
+        count_ = (size_ - header_.header_bytes) / header_.record_bytes;
+        if (header_.frame_count && header_.frame_count < count_) count_ = header_.frame_count;
+        return true;
+    }
+
+    void close() {
+        if (data_) munmap((void*)data_, size_);
+        data_ = NULL;
+        count_ = 0;
+    }
+
+    // True if the result block matches this build's EyesResult layout
+    bool results_compatible() const {
+        return header_.num_classes == EYES_NUM_CLASSES && header_.max_detections == EYES_MAX_DETECTIONS &&
+               header_.num_stages == EYES_NUM_STAGES &&
+               header_.pixel_offset >= header_.result_offset + sizeof(EyesRecordResult);
+    }
+
+    int width() const { return header_.width; }
+    int height() const { return header_.height; }
+    size_t frame_count() const { return count_; }
+
+    const EyesRecordFrame* frame(size_t i) const {
+        return (const EyesRecordFrame*)(data_ + header_.header_bytes + i * header_.record_bytes);
+    }
+
+    const uint8_t* pixels(size_t i) const {
+        return (const uint8_t*)frame(i) + header_.pixel_offset;
+    }
+
+    // False if frame i has no result, or it was recorded with another target table
+    bool result(size_t i, EyesResult* out) const {
+        const EyesRecordFrame* f = frame(i);
+        if (!f->has_result || !results_compatible()) return false;
+        EyesRecordResult rec;
+        memcpy(&rec, (const uint8_t*)f + header_.result_offset, sizeof(rec));
+        eyes_record_unpack_result(&rec, f->frame_number, f->timestamp_us, out);
+        return true;
+    }
+
+private:
+    const uint8_t* data_ = NULL;
+    size_t size_ = 0;
+    size_t count_ = 0;
+    EyesRecordHeader header_;
+};
+
+// REPLAY SOURCE - recorded frames in order, with their recorded timestamps
+class MockRecordingSource : public MockFrameSource {
+public:
+    MockRecordingSource(const RecordingReader* reader, bool loop = false)
+        : reader_(reader), loop_(loop), index_(0) {}
+
+    int width() const override { return reader_->width(); }
+    int height() const override { return reader_->height(); }
+
+    const uint8_t* next_frame(uint32_t* timestamp_us) override {
+        if (index_ >= reader_->frame_count()) {
+            if (!loop_ || reader_->frame_count() == 0) return NULL;
+            index_ = 0;
+        }
+        if (timestamp_us) *timestamp_us = reader_->frame(index_)->timestamp_us;
+        return reader_->pixels(index_++);
+    }
+
+    size_t position() const { return index_; }  // Frames served since the last wrap
+    void rewind() { index_ = 0; }
+
+private:
+    const RecordingReader* reader_;
+    bool loop_;
+    size_t index_;
+};
+
+#endif // EYES_RECORDING_H
@@ -0,0 +1,249 @@
+/* EYES_REFERENCE.H - Original (pre-optimization) eyes.h stages, host only
+ *
+ * Kept verbatim so the benchmark can check that the shipped fast paths are
+ * bit-exact and report how much faster they are. Include after eyes.h.
+ */
+
+#ifndef EYES_REFERENCE_H
+#define EYES_REFERENCE_H
+
+// Per-pixel RGB565 -> HSV -> range check, as eyes_process_frame() did it
+inline void eyes_ref_classify_frame(const uint8_t* buf, uint8_t* yellow_mask, uint8_t* pink_mask, int pixel_count) {
+    for (int i = 0; i < pixel_count; i++) {
+        uint16_t pixel = ((uint16_t)buf[i*2] << 8) | buf[i*2+1];
+
+        //RGB888
+        uint8_t r5 = (pixel >> 11) & 0x1F;
+        uint8_t g6 = (pixel >> 5) & 0x3F;
+        uint8_t b5 = pixel & 0x1F;
+
+        uint8_t r = (r5 << 3) | (r5 >> 2);  // Fill lower bits
+        uint8_t g = (g6 << 2) | (g6 >> 4);
+        uint8_t b = (b5 << 3) | (b5 >> 2);
+
+        uint8_t h, s, v;
+        eyes_rgb_to_hsv(r, g, b, &h, &s, &v);
+
+        yellow_mask[i] = eyes_in_hsv_range(h, s, v, EYES_YELLOW_RANGE) ? 255 : 0;
+        pink_mask[i] = eyes_in_hsv_range(h, s, v, EYES_PINK_RANGE) ? 255 : 0;
+    }
+}
+
+// Brute-force k x k dilate/erode with a bounds check per tap
+inline void eyes_ref_dilate(uint8_t* input, uint8_t* output, int width, int height, int kernel_size) {
+    int k = kernel_size / 2;  
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t max_val = 0;
+            // Check neighborhood 
+            for (int dy = -k; dy <= k; dy++) {
+                for (int dx = -k; dx <= k; dx++) {
+                    int ny = y + dy;
+                    int nx = x + dx;
+                    // Boundary check
+                    if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
+                        uint8_t val = input[ny * width + nx];
+                        if (val > max_val) {
+                            max_val = val;
+                        }
+                    }
+                }
+            }
+
+            output[y * width + x] = max_val;
+        }
+    }
+}
+
+inline void eyes_ref_erode(uint8_t* input, uint8_t* output, int width, int height, int kernel_size) {
+    int k = kernel_size / 2;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t min_val = 255;
+            for (int dy = -k; dy <= k; dy++) {
+                for (int dx = -k; dx <= k; dx++) {
+                    int ny = y + dy;
+                    int nx = x + dx;
+                    if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
+                        uint8_t val = input[ny * width + nx];
+                        if (val < min_val) {
+                            min_val = val;
+                        }
+                    }
+                }
+            }
+
+            output[y * width + x] = min_val;
+        }
+    }
+}
+
+inline void eyes_ref_morphological_close(uint8_t* mask, int width, int height, int kernel_size) {
+    uint8_t* temp = (uint8_t*)malloc(width * height);
+    if (!temp) {
+        return;
+    }
+
+    // Fills gaps
+    eyes_ref_dilate(mask, temp, width, height, kernel_size);
+
+    //Removes noise/ keeps connections
+    eyes_ref_erode(temp, mask, width, height, kernel_size);
+
+    free(temp);
+}
+
+// Flood fill with per-blob stacks (truncates blobs past the 4000-entry stack)
+// BLOB DETECTION - Find largest blob in mask
+inline EyesBlobInfo eyes_ref_find_largest_blob(uint8_t* mask, int width, int height) {
+    EyesBlobInfo largest = {0, 0, 0, (int16_t)width, 0, (int16_t)height, 0};
+    bool* visited = (bool*)calloc(width * height, sizeof(bool));
+
+    if (!visited) return largest;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int idx = y * width + x;
+
+            if (mask[idx] && !visited[idx]) {
+                EyesBlobInfo current = {0, 0, 0, (int16_t)width, 0, (int16_t)height, 0};
+
+                int* stack_x = (int*)malloc(4000 * sizeof(int));
+                int* stack_y = (int*)malloc(4000 * sizeof(int));
+
+                if (!stack_x || !stack_y) {
+                    if (stack_x) free(stack_x);
+                    if (stack_y) free(stack_y);
+                    continue;
+                }
+
+                int stack_size = 0;
+                stack_x[0] = x;
+                stack_y[0] = y;
+                stack_size = 1;
+
+                while (stack_size > 0) {
+                    int cx = stack_x[--stack_size];
+                    int cy = stack_y[stack_size];
+                    int cidx = cy * width + cx;
+
+                    if (cx < 0 || cx >= width || cy < 0 || cy >= height) continue;
+                    if (visited[cidx] || !mask[cidx]) continue;
+
+                    visited[cidx] = true;
+                    current.x_sum += cx;
+                    current.y_sum += cy;
+                    current.pixel_count++;
+
+                    current.x_min = min(current.x_min, (int16_t)cx);
+                    current.x_max = max(current.x_max, (int16_t)cx);
+                    current.y_min = min(current.y_min, (int16_t)cy);
+                    current.y_max = max(current.y_max, (int16_t)cy);
+
+                    if (stack_size < 3996) {
+                        stack_x[stack_size] = cx + 1; stack_y[stack_size++] = cy;
+                        stack_x[stack_size] = cx - 1; stack_y[stack_size++] = cy;
+                        stack_x[stack_size] = cx; stack_y[stack_size++] = cy + 1;
+                        stack_x[stack_size] = cx; stack_y[stack_size++] = cy - 1;
+                    }
+                }
+
+                free(stack_x);
+                free(stack_y);
+
+                if (current.pixel_count > largest.pixel_count) {
+                    largest = current;
+                }
+            }
+        }
+    }
+
+    free(visited);
+    return largest;
+}
+
+// BLOB DETECTION - Find top N blobs sorted by size
+inline int eyes_ref_find_top_n_blobs(uint8_t* mask, int width, int height, EyesBlobInfo* blobs, int max_blobs) {
+    bool* visited = (bool*)calloc(width * height, sizeof(bool));
+    if (!visited) return 0;
+
+    int num_blobs = 0;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int idx = y * width + x;
+
+            if (mask[idx] && !visited[idx]) {
+                EyesBlobInfo current = {0, 0, 0, (int16_t)width, 0, (int16_t)height, 0};
+
+                int* stack_x = (int*)malloc(4000 * sizeof(int));
+                int* stack_y = (int*)malloc(4000 * sizeof(int));
+
+                if (!stack_x || !stack_y) {
+                    if (stack_x) free(stack_x);
+                    if (stack_y) free(stack_y);
+                    continue;
+                }
+
+                int stack_size = 0;
+                stack_x[0] = x;
+                stack_y[0] = y;
+                stack_size = 1;
+
+                while (stack_size > 0) {
+                    int cx = stack_x[--stack_size];
+                    int cy = stack_y[stack_size];
+                    int cidx = cy * width + cx;
+
+                    if (cx < 0 || cx >= width || cy < 0 || cy >= height) continue;
+                    if (visited[cidx] || !mask[cidx]) continue;
+
+                    visited[cidx] = true;
+                    current.x_sum += cx;
+                    current.y_sum += cy;
+                    current.pixel_count++;
+
+                    current.x_min = min(current.x_min, (int16_t)cx);
+                    current.x_max = max(current.x_max, (int16_t)cx);
+                    current.y_min = min(current.y_min, (int16_t)cy);
+                    current.y_max = max(current.y_max, (int16_t)cy);
+
+                    if (stack_size < 3996) {
+                        stack_x[stack_size] = cx + 1; stack_y[stack_size++] = cy;
+                        stack_x[stack_size] = cx - 1; stack_y[stack_size++] = cy;
+                        stack_x[stack_size] = cx; stack_y[stack_size++] = cy + 1;
+                        stack_x[stack_size] = cx; stack_y[stack_size++] = cy - 1;
+                    }
+                }
+
+                free(stack_x);
+                free(stack_y);
+
+                if (current.pixel_count >= EYES_MIN_BLOB_AREA) {
+                    // Insert into sorted list (largest first)
+                    int insert_pos = num_blobs;
+                    for (int i = 0; i < num_blobs; i++) {
+                        if (current.pixel_count > blobs[i].pixel_count) {
+                            insert_pos = i;
+                            break;
+                        }
+                    }
+                    // Shift blobs down
+                    if (insert_pos < max_blobs) {
+                        for (int i = min(num_blobs, max_blobs - 1); i > insert_pos; i--) {
+                            blobs[i] = blobs[i - 1];
+                        }
+                        blobs[insert_pos] = current;
+                        if (num_blobs < max_blobs) num_blobs++;
+                    }
+                }
+            }
+        }
+    }
+
+    free(visited);
+    return num_blobs;
+}
+
+#endif // EYES_REFERENCE_H
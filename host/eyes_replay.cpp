@@ -0,0 +1,202 @@
+/* EYES_REPLAY - Record frames to a .eyrec file, or replay one through eyes_snap()
+ *
+ * Usage:
+ *   eyes_replay recording.eyrec [--repeat R] [--tracking] [--no-coarse]
+ *   eyes_replay --record out.eyrec [--frames N] [--scene empty|pillar|mixed]
+ *               [--seed S] [--input dump.rgb565 ...]
+ *
+ * Replay serves the recording through MockRecordingSource with no sensor
+ * clock, so frames go through as fast as the pipeline takes them, and
+ * compares each frame's detections with the recorded result (from the
+ * robot via viewer.py, or from --record).
+ *
+ * --record runs synthetic scenes or raw dumps through the pipeline,
+ * writes every frame with its EyesResult, then replays the file and
+ * checks the detections come back identical.
+ */
+
+#include "eyes.h"
+
+#include "bench_args.h"
+#include "eyes_recording.h"
+#include "mock_camera.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct ReplayOptions {
+    std::string replay;
+    std::string record;
+    int repeat = 1;
+    bool tracking = false;
+    bool coarse = true;
+    int frames = 300;
+    MockScene scene = MOCK_SCENE_MIXED;
+    const char* scene_name = "mixed";
+    uint32_t seed = 1;
+    std::vector<std::string> inputs;
+};
+
+static bool parse_args(int argc, char** argv, ReplayOptions* opt) {
+    BenchArgs args("eyes_replay recording.eyrec [--repeat R] [--tracking] [--no-coarse]\n"
+                   "       eyes_replay --record out.eyrec [--frames N] [--scene empty|pillar|mixed] [--seed S]\n"
+                   "                   [--input file.rgb565 ...]");
+    args.positional(&opt->replay);
+    args.option("--record", &opt->record);
+    args.option("--repeat", &opt->repeat);
+    args.flag("--tracking", &opt->tracking);
+    args.flag("--no-coarse", &opt->coarse, false);
+    args.option("--frames", &opt->frames);
+    args.option("--scene", [opt](const char* v) {
+        opt->scene_name = v;
+        return mock_scene_from_name(v, &opt->scene);
+    });
+    args.option("--seed", &opt->seed);
+    args.option("--input", &opt->inputs);
+    return args.parse(argc, argv, [opt] {
+        return opt->replay.empty() != opt->record.empty() && opt->repeat > 0 && opt->frames > 0;
+    });
+}
+
+static bool same_detections(const EyesResult& a, const EyesResult& b) {
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        if (a.count[c] != b.count[c]) return false;
+        if (memcmp(a.blobs[c], b.blobs[c], a.count[c] * sizeof(EyesDetection)) != 0) return false;
+    }
+    return true;
+}
+
+// RECORD - every frame of source with the host pipeline's result
+static bool record(const ReplayOptions& opt, MockFrameListSource* source) {
+    mock_camera_set_source(source);
+    if (!eyes_init()) return false;
+
+    RecordingWriter writer;
+    if (!writer.open(opt.record, EYES_IMG_WIDTH, EYES_IMG_HEIGHT)) {
+        fprintf(stderr, "eyes_replay: cannot write %s\n", opt.record.c_str());
+        return false;
+    }
+    for (int i = 0; i < opt.frames; i++) {
+        eyes_snap();
+        camera_fb_t* fb = eyes_get_framebuffer();
+        if (fb == NULL) break;
+        const EyesResult& res = eyes_pipeline.result();
+        writer.add(res.frame_number, res.capture_us, fb->buf, &res);
+        eyes_release();
+    }
+    uint32_t written = writer.frame_count();
+    if (!writer.close()) return false;
+    printf("recorded %u frames to %s\n", written, opt.record.c_str());
+    return written > 0;
+}
+
+// REPLAY
+struct ReplayStats {
+    size_t frames = 0;
+    size_t with_result = 0;   // Frames the recording has a result for
+    size_t matching = 0;      // ... that came out identical
+    size_t count_diffs = 0;   // ... with a different number of detections
+    int max_offset_diff = 0;  // Largest offset_x change where counts agree
+    double seconds = 0;
+};
+
+static bool replay(const RecordingReader& reader, const ReplayOptions& opt, ReplayStats* st) {
+    MockRecordingSource source(&reader, true);
+    mock_camera_set_source(&source);
+    if (!eyes_init()) return false;
+    eyes_set_tracking(opt.tracking);
+    eyes_set_coarse_to_fine(opt.coarse);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < opt.repeat; pass++) {
+        for (size_t i = 0; i < reader.frame_count(); i++) {
+            eyes_snap();
+            if (eyes_get_framebuffer() == NULL) return false;
+            st->frames++;
+
+            const EyesResult& res = eyes_pipeline.result();
+            EyesResult recorded;
+            if (reader.result(i, &recorded)) {
+                st->with_result++;
+                if (same_detections(res, recorded)) {
+                    st->matching++;
+                } else {
+                    bool counts_agree = true;
+                    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+                        if (res.count[c] != recorded.count[c]) {
+                            counts_agree = false;
+                            continue;
+                        }
+                        for (int k = 0; k < recorded.count[c]; k++) {
+                            int d = abs(res.blobs[c][k].offset_x - recorded.blobs[c][k].offset_x);
+                            st->max_offset_diff = max(st->max_offset_diff, d);
+                        }
+                    }
+                    st->count_diffs += !counts_agree;
+                }
+            }
+            eyes_release();
+        }
+    }
+    st->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+static void print_replay(const RecordingReader& reader, const ReplayStats& st) {
+    printf("replayed %zu frames (%zu recorded, %dx%d) in %.3f s: %.0f frames/s\n", st.frames,
+           reader.frame_count(), reader.width(), reader.height(), st.seconds, st.frames / st.seconds);
+    if (!reader.results_compatible()) {
+        printf("recorded results use another target table, not compared\n");
+    } else if (st.with_result > 0) {
+        printf("detections identical to the recording: %zu of %zu frames (%zu with other counts, "
+               "max offset_x change %d px)\n", st.matching, st.with_result, st.count_diffs, st.max_offset_diff);
+    }
+}
+
+int main(int argc, char** argv) {
+    ReplayOptions opt;
+    if (!parse_args(argc, argv, &opt)) return 2;
+
+    if (!opt.record.empty()) {
+        MockFrameListSource source(EYES_IMG_WIDTH, EYES_IMG_HEIGHT, true);
+        if (opt.inputs.empty()) {
+            mock_render_scene(opt.scene, 120, opt.seed, &source);
+        } else {
+            for (const std::string& path : opt.inputs) {
+                if (mock_load_rgb565_file(path, &source) == 0) {
+                    fprintf(stderr, "eyes_replay: no %dx%d frames in %s\n", EYES_IMG_WIDTH, EYES_IMG_HEIGHT,
+                            path.c_str());
+                    return 1;
+                }
+            }
+        }
+        if (!record(opt, &source)) return 1;
+        opt.replay = opt.record;
+    }
+
+    RecordingReader reader;
+    if (!reader.open(opt.replay)) {
+        fprintf(stderr, "eyes_replay: %s is not a readable recording\n", opt.replay.c_str());
+        return 1;
+    }
+    if (reader.width() != EYES_IMG_WIDTH || reader.height() != EYES_IMG_HEIGHT) {
+        fprintf(stderr, "eyes_replay: recording is %dx%d, pipeline is %dx%d\n", reader.width(), reader.height(),
+                EYES_IMG_WIDTH, EYES_IMG_HEIGHT);
+        return 1;
+    }
+
+    ReplayStats st;
+    if (!replay(reader, opt, &st)) {
+        fprintf(stderr, "eyes_replay: eyes_snap() failed\n");
+        return 1;
+    }
+    print_replay(reader, st);
+
+    if (!opt.record.empty()) {
+        bool ok = st.with_result == st.frames && st.matching == st.frames;
+        printf("verify: replay of the recording reproduces every result: %s\n", ok ? "ok" : "FAIL");
+        return ok ? 0 : 1;
+    }
+    return 0;
+}
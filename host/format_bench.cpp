@@ -0,0 +1,241 @@
+/* FORMAT_BENCH - RGB565/HSV vs YUV422/UV-box classification (eyes.h EYES_YUV422)
+ *
+ * Usage:
+ *   format_bench [--frames N] [--scene empty|pillar|mixed] [--seed S]
+ *                [--input dump.rgb565 ...] [--recording run.eyrec]
+ *
+ * Built twice: format_bench runs the RGB565 pipeline, format_bench_yuv the
+ * YUV422 one (EYES_YUV422 1). Both read the same RGB565 frames (synthetic,
+ * raw dumps or an eyes_replay recording); the YUV build's mock sensor
+ * converts them with mock_rgb565_to_yuv422().
+ *
+ * Accuracy, per distinct frame, the same in both builds:
+ *   pixels      every pixel's HSV class (EYES_TARGETS[].range on RGB565)
+ *               against its UV-box class (EYES_TARGETS[].uv on YUV422):
+ *               IoU, precision and recall of the UV masks, per target
+ *   detections  the HSV masks closed and labeled as eyes.h does, against
+ *               this build's eyes_snap() (coarse pass off): frames where
+ *               found/not found agrees, and the mean |offset_x| change
+ *
+ * Timing, this build's format: classify of a whole frame and
+ * eyes_process_frame() (coarse pass on) over N frames, converted before
+ * the clock starts. Run both binaries to compare the paths.
+ */
+
+#include "eyes.h"
+
+#include "bench_args.h"
+#include "bench_stats.h"
+#include "eyes_recording.h"
+#include "mock_camera.h"
+
+#include <string>
+#include <vector>
+
+#define FORMAT_BENCH_MIN_AGREE 0.95   // Share of frames whose found/not found must agree
+#define FORMAT_BENCH_MAX_OFFSET 2.0   // Mean |offset_x| change allowed where both found, px
+
+struct FormatBenchOptions {
+    int frames = 2000;
+    MockScene scene = MOCK_SCENE_MIXED;
+    const char* scene_name = "mixed";
+    uint32_t seed = 1;
+    std::vector<std::string> inputs;
+    std::string recording;
+};
+
+struct PixelAgreement {
+    uint64_t hsv = 0, uv = 0, both = 0;
+
+    double iou() const { return hsv + uv - both ? (double)both / (hsv + uv - both) : 1.0; }
+    double precision() const { return uv ? (double)both / uv : 1.0; }
+    double recall() const { return hsv ? (double)both / hsv : 1.0; }
+};
+
+struct DetectionAgreement {
+    uint32_t frames = 0, agree = 0, both = 0;
+    double offset_diff = 0;
+
+    double agree_rate() const { return frames ? (double)agree / frames : 1.0; }
+    double mean_offset_diff() const { return both ? offset_diff / both : 0.0; }
+};
+
+static bool parse_args(int argc, char** argv, FormatBenchOptions* opt) {
+    BenchArgs args("format_bench [--frames N] [--scene empty|pillar|mixed] [--seed S] [--input file.rgb565 ...]\n"
+                   "                    [--recording run.eyrec]");
+    args.option("--frames", &opt->frames);
+    args.option("--scene", [opt](const char* v) {
+        opt->scene_name = v;
+        return mock_scene_from_name(v, &opt->scene);
+    });
+    args.option("--seed", &opt->seed);
+    args.option("--input", &opt->inputs);
+    args.option("--recording", &opt->recording);
+    return args.parse(argc, argv, [opt] { return opt->frames > 0; });
+}
+
+// Closed, labeled HSV masks of an RGB565 frame: what the RGB565 pipeline sees
+static void hsv_labels(const uint8_t* rgb, EyesLabeler* lab) {
+    const int w = EYES_IMG_WIDTH, h = EYES_IMG_HEIGHT, words = eyes_mask_words(w);
+    std::vector<EyesMaskWord> planes(EYES_MASK_TOTAL_WORDS, 0), temp(EYES_MASK_TOTAL_WORDS);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            const uint8_t* px = rgb + (y * w + x) * 2;
+            uint8_t classes = eyes_classify_pixel_hsv(((uint16_t)px[0] << 8) | px[1]);
+            for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+                if ((classes >> c) & 1) planes[(y * EYES_NUM_CLASSES + c) * words + (x >> 5)] |= (EyesMaskWord)1 << (x & 31);
+            }
+        }
+    }
+    eyes_packed_close(planes.data(), temp.data(), w, h, EYES_CLOSE_KERNEL);
+    eyes_labeler_reset(lab, w);
+    for (int y = 0; y < h; y++) eyes_labeler_push_row(lab, planes.data() + y * EYES_MASK_ROW_WORDS);
+    eyes_labeler_finish(lab);
+}
+
+static void compare_pixels(const uint8_t* rgb, PixelAgreement* agree) {
+    const int n = EYES_IMG_WIDTH * EYES_IMG_HEIGHT;
+    std::vector<uint8_t> yuv(n * 2);
+    mock_rgb565_to_yuv422(rgb, yuv.data(), n);
+    for (int i = 0; i < n; i++) {
+        uint8_t hsv = eyes_classify_pixel_hsv(((uint16_t)rgb[i * 2] << 8) | rgb[i * 2 + 1]);
+        const uint8_t* pair = yuv.data() + (i & ~1) * 2;
+        uint8_t uv = eyes_classify_pixel_yuv(yuv[i * 2], pair[1], pair[3]);
+        for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+            bool a = (hsv >> c) & 1, b = (uv >> c) & 1;
+            agree[c].hsv += a;
+            agree[c].uv += b;
+            agree[c].both += a && b;
+        }
+    }
+}
+
+// Each target's largest HSV blob vs the nearest of this build's detections
+static bool compare_detections(const uint8_t* rgb, EyesLabeler* lab, DetectionAgreement* agree) {
+    hsv_labels(rgb, lab);
+    eyes_snap();
+    if (!eyes_get_framebuffer()) return false;
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        EyesBlobInfo ref = {};
+        bool ref_found = eyes_find_top_n_blobs(lab, c, &ref, 1, EYES_TARGETS[c].min_area) > 0;
+        bool found = eyes_get_count(c) > 0;
+        agree[c].frames++;
+        agree[c].agree += ref_found == found;
+        if (ref_found && found) {
+            int16_t ref_offset = ref.x_sum / (int32_t)ref.pixel_count - EYES_IMG_WIDTH / 2;
+            int diff = EYES_IMG_WIDTH;
+            for (int i = 0; i < eyes_get_count(c); i++) diff = min(diff, abs(ref_offset - eyes_get_offset_x(c, i)));
+            agree[c].both++;
+            agree[c].offset_diff += diff;
+        }
+    }
+    eyes_release();
+    return true;
+}
+
+// Frames converted up front, so the mock sensor's conversion is not timed
+static void bench_timing(const FormatBenchOptions& opt, const MockFrameListSource& source, BenchSamples* classify,
+                         BenchSamples* frame) {
+    const int n = EYES_IMG_WIDTH * EYES_IMG_HEIGHT;
+    std::vector<std::vector<uint8_t>> frames(source.frame_count(), std::vector<uint8_t>(n * 2));
+    for (size_t f = 0; f < frames.size(); f++) {
+        if (EYES_YUV422) mock_rgb565_to_yuv422(source.frame(f), frames[f].data(), n);
+        else memcpy(frames[f].data(), source.frame(f), n * 2);
+    }
+
+    std::vector<EyesMaskWord> planes(EYES_MASK_TOTAL_WORDS);
+    camera_fb_t fb = {};
+    fb.width = EYES_IMG_WIDTH;
+    fb.height = EYES_IMG_HEIGHT;
+    fb.len = n * 2;
+    fb.format = EYES_YUV422 ? PIXFORMAT_YUV422 : PIXFORMAT_RGB565;
+    eyes_set_coarse_to_fine(true);
+    for (int f = 0; f < opt.frames; f++) {
+        fb.buf = frames[f % frames.size()].data();
+        uint64_t t0 = bench_now_ns();
+        eyes_classify_frame(fb.buf, planes.data(), EYES_IMG_WIDTH, EYES_IMG_HEIGHT);
+        uint64_t t1 = bench_now_ns();
+        eyes_process_frame(&fb);
+        uint64_t t2 = bench_now_ns();
+        classify->add(t1 - t0);
+        frame->add(t2 - t1);
+    }
+}
+
+int main(int argc, char** argv) {
+    FormatBenchOptions opt;
+    if (!parse_args(argc, argv, &opt)) return 2;
+
+    MockFrameListSource source(EYES_IMG_WIDTH, EYES_IMG_HEIGHT, true);
+    const char* input_name = opt.scene_name;
+    if (!opt.recording.empty()) {
+        RecordingReader reader;
+        if (!reader.open(opt.recording) || reader.width() != EYES_IMG_WIDTH || reader.height() != EYES_IMG_HEIGHT) {
+            fprintf(stderr, "format_bench: %s is not a %dx%d recording\n", opt.recording.c_str(), EYES_IMG_WIDTH,
+                    EYES_IMG_HEIGHT);
+            return 1;
+        }
+        for (size_t i = 0; i < reader.frame_count(); i++) {
+            const uint8_t* px = reader.pixels(i);
+            source.add_frame(std::vector<uint8_t>(px, px + source.frame_bytes()));
+        }
+        input_name = "recording";
+    }
+    for (const std::string& path : opt.inputs) {
+        if (mock_load_rgb565_file(path, &source) == 0) {
+            fprintf(stderr, "format_bench: no %dx%d frames in %s\n", EYES_IMG_WIDTH, EYES_IMG_HEIGHT, path.c_str());
+            return 1;
+        }
+        input_name = "recorded input";
+    }
+    if (source.frame_count() == 0) mock_render_scene(opt.scene, 120, opt.seed, &source);
+    mock_camera_set_source(&source);
+
+    if (!eyes_init()) {
+        fprintf(stderr, "format_bench: eyes_init() failed\n");
+        return 1;
+    }
+
+    printf("format_bench: %s pipeline, %dx%d, %s, %zu distinct frames, %d timed\n\n",
+           EYES_YUV422 ? "YUV422 (UV boxes)" : "RGB565 (HSV ranges)", EYES_IMG_WIDTH, EYES_IMG_HEIGHT, input_name,
+           source.frame_count(), opt.frames);
+
+    PixelAgreement pixels[EYES_NUM_CLASSES];
+    DetectionAgreement detections[EYES_NUM_CLASSES];
+    EyesLabeler* lab = new EyesLabeler;
+    eyes_set_coarse_to_fine(false);
+    for (size_t f = 0; f < source.frame_count(); f++) {
+        const uint8_t* rgb = source.frame(f);  // eyes_snap() gets the same frame next
+        compare_pixels(rgb, pixels);
+        if (!compare_detections(rgb, lab, detections)) {
+            fprintf(stderr, "format_bench: eyes_snap() failed\n");
+            return 1;
+        }
+    }
+    delete lab;
+
+    printf("%-10s %10s %10s %10s %10s %10s %12s %12s\n", "UV vs HSV", "HSV px", "UV px", "IoU", "precision",
+           "recall", "found agree", "offset diff");
+    bool ok = true;
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        const PixelAgreement& p = pixels[c];
+        const DetectionAgreement& d = detections[c];
+        printf("%-10s %10llu %10llu %10.3f %10.3f %10.3f %11.1f%% %9.2f px\n", EYES_TARGETS[c].name,
+               (unsigned long long)p.hsv, (unsigned long long)p.uv, p.iou(), p.precision(), p.recall(),
+               d.agree_rate() * 100, d.mean_offset_diff());
+        ok &= d.agree_rate() >= FORMAT_BENCH_MIN_AGREE && d.mean_offset_diff() <= FORMAT_BENCH_MAX_OFFSET;
+    }
+    printf("(detections: HSV masks vs this build's eyes_snap(); the RGB565 build matches exactly)\n\n");
+
+    BenchSamples classify(EYES_YUV422 ? "classify: YUV422 Y/U/V LUTs" : "classify: RGB565 LUT");
+    BenchSamples frame("frame (eyes_process_frame)");
+    bench_timing(opt, source, &classify, &frame);
+    BenchSamples::print_header();
+    classify.print_row();
+    frame.print_row();
+    printf("\n");
+
+    printf("verify: detections agree with HSV on %.0f%%+ of frames, offset within %.0f px: %s\n",
+           FORMAT_BENCH_MIN_AGREE * 100, FORMAT_BENCH_MAX_OFFSET, ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
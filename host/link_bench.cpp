@@ -0,0 +1,218 @@
+/* LINK_BENCH - serial_link.h against a slow wire, on Linux
+ *
+ * Usage:
+ *   link_bench [--ms T] [--bytes-per-s B] [--fps F] [--frame-every N]
+ *              [--corrupt-every K] [--dump wire.bin]
+ *
+ * The main thread plays laptop.ino's AUTO loop: a blob record per frame at
+ * F frames/s and a full 160x120 frame every N frames through the bulk
+ * path. A second thread plays the drain task and the USB wire: it takes
+ * ring bytes at B bytes/s, flips one byte every K (0 = never) and feeds
+ * the result to link_parse_byte(), reassembling full frames the way
+ * viewer.py does. --dump writes the wire bytes for checking viewer.py.
+ *
+ * Pixel data is seeded with sync bytes and fake headers, the case that
+ * broke the old 'VIZ' resync.
+ */
+
+#include "serial_link.h"
+
+#include "bench_args.h"
+#include "bench_stats.h"
+
+#include <atomic>
+#include <vector>
+
+#define FRAME_W 160
+#define FRAME_H 120
+#define FRAME_BYTES (FRAME_W * FRAME_H * 2)
+#define BLOB_RECORD_BYTES 47  // Header + 2 blobs, as laptop.ino sends
+
+struct LinkBenchOptions {
+    int ms = 3000;
+    int bytes_per_s = 11520;  // 115200 baud, 8N1
+    int fps = 30;
+    int frame_every = 30;
+    int corrupt_every = 0;
+    const char* dump = NULL;
+};
+
+static bool parse_args(int argc, char** argv, LinkBenchOptions* opt) {
+    BenchArgs args("link_bench [--ms T] [--bytes-per-s B] [--fps F] [--frame-every N]\n"
+                   "                  [--corrupt-every K] [--dump wire.bin]");
+    args.option("--ms", &opt->ms);
+    args.option("--bytes-per-s", &opt->bytes_per_s);
+    args.option("--fps", &opt->fps);
+    args.option("--frame-every", &opt->frame_every);
+    args.option("--corrupt-every", &opt->corrupt_every);
+    args.option("--dump", &opt->dump);
+    return args.parse(argc, argv, [opt] {
+        return opt->ms > 0 && opt->bytes_per_s > 0 && opt->fps > 0 && opt->frame_every > 0 && opt->corrupt_every >= 0;
+    });
+}
+
+// Deterministic frame contents per id, so the receiver can check them
+static void make_frame(uint32_t id, uint8_t* out) {
+    uint32_t state = id * 2654435761u + 1;
+    for (int i = 0; i < FRAME_BYTES; i++) {
+        state = state * 1664525u + 1013904223u;
+        out[i] = state >> 24;
+    }
+    // Sync bytes followed by plausible headers (small length, wrong crc)
+    for (int i = 0; i + 8 < FRAME_BYTES; i += 997) {
+        const uint8_t fake[7] = {LINK_SYNC0, LINK_SYNC1, 0x10, 0x00, 0x00, 0x20, 0x00};
+        memcpy(out + i, fake, sizeof(fake));
+    }
+}
+
+struct WireResult {
+    LinkStats rx = {0};
+    uint32_t bytes = 0;
+    uint32_t frames_ok = 0;
+    uint32_t frames_bad = 0;       // Completed but not matching the source
+    uint32_t frames_dropped = 0;   // Abandoned on a missing chunk
+    uint32_t blob_records = 0;
+};
+
+// DRAIN + WIRE + RECEIVER
+static void wire_thread(const LinkBenchOptions& opt, std::atomic<bool>* stop, WireResult* res) {
+    LinkParser parser = {0};
+    static LinkMessage msg;
+    FILE* dump = opt.dump ? fopen(opt.dump, "wb") : NULL;
+
+    std::vector<uint8_t> frame, expect(FRAME_BYTES);
+    uint32_t frame_id = 0, frame_total = 0;
+    bool assembling = false;
+
+    uint32_t start = micros();
+    uint64_t sent_bytes = 0;
+    uint8_t chunk[256];
+    while (true) {
+        // Never run ahead of the wire rate
+        uint64_t allowed = (uint64_t)(micros() - start) * opt.bytes_per_s / 1000000;
+        size_t room = (size_t)min<uint64_t>(allowed - min(allowed, sent_bytes), sizeof(chunk));
+        size_t n = room ? link_tx_take(chunk, room) : 0;
+        if (n == 0) {
+            if (stop->load() && link_tx_pending() == 0) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+        sent_bytes += n;
+
+        for (size_t i = 0; i < n; i++) {
+            res->bytes++;
+            uint8_t byte = chunk[i];
+            if (opt.corrupt_every && res->bytes % opt.corrupt_every == 0) byte ^= 0x5A;
+            if (dump) fputc(byte, dump);
+            if (!link_parse_byte(&parser, byte, &msg, &res->rx)) continue;
+
+            if (msg.type == 0x10) {
+                res->blob_records++;
+            } else if (msg.type == LINK_MSG_BULK_BEGIN) {
+                if (assembling) res->frames_dropped++;
+                memcpy(&frame_id, msg.payload, 4);
+                memcpy(&frame_total, msg.payload + 4, 4);
+                frame.clear();
+                assembling = true;
+            } else if (msg.type == LINK_MSG_BULK_DATA && assembling) {
+                uint32_t id, offset;
+                memcpy(&id, msg.payload, 4);
+                memcpy(&offset, msg.payload + 4, 4);
+                if (id != frame_id || offset != frame.size()) {
+                    res->frames_dropped++;
+                    assembling = false;
+                    continue;
+                }
+                frame.insert(frame.end(), msg.payload + 8, msg.payload + msg.len);
+                if (frame.size() >= frame_total) {
+                    make_frame(frame_id, expect.data());
+                    bool same = frame_total == FRAME_BYTES && memcmp(frame.data(), expect.data(), FRAME_BYTES) == 0;
+                    (same ? res->frames_ok : res->frames_bad)++;
+                    assembling = false;
+                }
+            }
+        }
+    }
+    if (dump) fclose(dump);
+}
+
+int main(int argc, char** argv) {
+    LinkBenchOptions opt;
+    if (!parse_args(argc, argv, &opt)) return 2;
+
+    printf("link_bench: %d ms, wire %d B/s, %d fps, full frame every %d, corrupt every %d\n",
+           opt.ms, opt.bytes_per_s, opt.fps, opt.frame_every, opt.corrupt_every);
+
+    std::atomic<bool> stop(false);
+    WireResult res;
+    std::thread wire(wire_thread, std::cref(opt), &stop, &res);
+
+    // PRODUCER - laptop.ino's AUTO loop
+    static uint8_t frame_src[FRAME_BYTES], frame_copy[FRAME_BYTES];
+    uint8_t record[BLOB_RECORD_BYTES] = {0};
+    BenchSamples send("link_send + bulk pump");
+    uint32_t frames_started = 0, frames_skipped = 0;
+    uint32_t period_us = 1000000 / opt.fps;
+    uint32_t start = micros();
+    for (uint32_t frame = 0; micros() - start < (uint32_t)opt.ms * 1000; frame++) {
+        uint32_t t0 = micros();
+        if (frame % opt.frame_every == 0) make_frame(frame, frame_src);  // The camera's part
+        uint64_t ns = bench_now_ns();
+        memcpy(record, &frame, 4);
+        link_send2(0x10, record, sizeof(record), NULL, 0);
+        if (frame % opt.frame_every == 0) {
+            if (link_bulk_busy()) {
+                frames_skipped++;
+            } else {
+                memcpy(frame_copy, frame_src, FRAME_BYTES);
+                uint8_t header[9] = {0};
+                if (link_bulk_start(frame, frame_copy, FRAME_BYTES, header, sizeof(header))) frames_started++;
+            }
+        }
+        link_bulk_pump();
+        send.add(bench_now_ns() - ns);
+
+        // Keep pumping between frames like loop() does
+        while (micros() - t0 < period_us) {
+            link_bulk_pump();
+            delayMicroseconds(500);
+        }
+    }
+
+    // Let the ring empty, then stop the wire
+    uint32_t settle = millis();
+    while ((link_bulk_busy() || link_tx_pending() > 0) && millis() - settle < 60000) {
+        link_bulk_pump();
+        delay(1);
+    }
+    stop = true;
+    wire.join();
+
+    uint32_t seqs = link_stats.sent + link_stats.dropped;
+    printf("\n");
+    BenchSamples::print_header();
+    send.print_row();
+    printf("\nproducer: %u messages queued, %u dropped (ring full)\n", link_stats.sent, link_stats.dropped);
+    printf("full frames: %u started, %u skipped (previous still sending)\n", frames_started, frames_skipped);
+    printf("wire: %u bytes, %u ok, %u crc failures, %u lost by seq\n",
+           res.bytes, res.rx.rx_ok, res.rx.rx_bad_crc, res.rx.rx_lost);
+    printf("receiver: %u blob records, %u full frames intact, %u abandoned, %u corrupt\n",
+           res.blob_records, res.frames_ok, res.frames_dropped, res.frames_bad);
+
+    bool ok = true;
+    if (res.frames_bad != 0) {
+        printf("verify: a reassembled frame differs from the source: FAIL\n");
+        ok = false;
+    }
+    if (res.rx.rx_ok + res.rx.rx_lost != seqs) {
+        printf("verify: received + lost (%u) != sequence numbers used (%u): FAIL\n",
+               res.rx.rx_ok + res.rx.rx_lost, seqs);
+        ok = false;
+    }
+    if (opt.corrupt_every == 0 && (res.rx.rx_bad_crc != 0 || res.rx.rx_lost != link_stats.dropped)) {
+        printf("verify: clean wire but crc failures or losses beyond producer drops: FAIL\n");
+        ok = false;
+    }
+    if (ok) printf("verify: every sequence number received or counted lost, frames intact ok\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,323 @@
+#include "mock_camera.h"
+
+#include <Arduino.h>
+
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+// --- FRAME LIST SOURCE ---
+
+const uint8_t* MockFrameListSource::next_frame(uint32_t* timestamp_us) {
+    if (frames_.empty()) return NULL;
+    if (index_ >= frames_.size()) {
+        if (!loop_) return NULL;
+        index_ = 0;
+    }
+    if (timestamp_us) *timestamp_us = micros();
+    return frames_[index_++].data();
+}
+
+// --- SYNTHETIC SCENES ---
+
+static uint32_t mock_rand(uint32_t* state) {
+    // xorshift32, deterministic across platforms
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static uint8_t mock_jitter(uint8_t c, int amount, uint32_t* rng) {
+    int v = (int)c + (int)(mock_rand(rng) % (2 * amount + 1)) - amount;
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static void mock_put_pixel(std::vector<uint8_t>& frame, int width, int x, int y,
+                           uint8_t r, uint8_t g, uint8_t b) {
+    uint16_t p = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    size_t i = ((size_t)y * width + x) * 2;
+    frame[i] = p >> 8;      // Camera order: high byte first
+    frame[i + 1] = p & 0xFF;
+}
+
+static void mock_fill_rect(std::vector<uint8_t>& frame, int width, int height,
+                           int x0, int y0, int x1, int y1,
+                           uint8_t r, uint8_t g, uint8_t b, uint32_t* rng) {
+    for (int y = max(y0, 0); y <= min(y1, height - 1); y++) {
+        for (int x = max(x0, 0); x <= min(x1, width - 1); x++) {
+            mock_put_pixel(frame, width, x, y,
+                           mock_jitter(r, 10, rng), mock_jitter(g, 10, rng), mock_jitter(b, 10, rng));
+        }
+    }
+}
+
+bool mock_scene_from_name(const char* name, MockScene* scene) {
+    if (strcmp(name, "empty") == 0) { *scene = MOCK_SCENE_EMPTY; return true; }
+    if (strcmp(name, "pillar") == 0) { *scene = MOCK_SCENE_PILLAR; return true; }
+    if (strcmp(name, "mixed") == 0) { *scene = MOCK_SCENE_MIXED; return true; }
+    return false;
+}
+
+void mock_render_scene(MockScene scene, int frame_count, uint32_t seed, MockFrameListSource* out) {
+    int w = out->width();
+    int h = out->height();
+    uint32_t rng = seed ? seed : 1;
+
+    for (int f = 0; f < frame_count; f++) {
+        std::vector<uint8_t> frame(out->frame_bytes());
+
+        // Background: dim, low-saturation field
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                uint8_t base = 60 + (y * 40) / h;
+                mock_put_pixel(frame, w, x, y,
+                               mock_jitter(base, 12, &rng), mock_jitter(base, 12, &rng), mock_jitter(base, 12, &rng));
+            }
+        }
+
+        if (scene == MOCK_SCENE_PILLAR || scene == MOCK_SCENE_MIXED) {
+            // Pillar sweeps side to side over the sequence
+            float phase = (float)f / 60.0f * 6.2831853f;
+            int pillar_w = w / 10;
+            int cx = w / 2 + (int)(std::sin(phase) * (w / 3));
+            mock_fill_rect(frame, w, h, cx - pillar_w / 2, h / 6, cx + pillar_w / 2, h - h / 6,
+                           230, 200, 40, &rng);
+        }
+
+        if (scene == MOCK_SCENE_MIXED) {
+            int s = w / 16;
+            mock_fill_rect(frame, w, h, w / 8, h / 2, w / 8 + s, h / 2 + s, 230, 60, 170, &rng);
+            mock_fill_rect(frame, w, h, w - w / 8 - s, h / 3, w - w / 8, h / 3 + s, 230, 60, 170, &rng);
+
+            // Speckle: isolated target-colored pixels for morphology to deal with
+            for (int i = 0; i < (w * h) / 400; i++) {
+                int x = mock_rand(&rng) % w;
+                int y = mock_rand(&rng) % h;
+                if (mock_rand(&rng) & 1) mock_put_pixel(frame, w, x, y, 230, 200, 40);
+                else mock_put_pixel(frame, w, x, y, 230, 60, 170);
+            }
+        }
+
+        out->add_frame(frame);
+    }
+}
+
+// --- RAW FILES ---
+
+int mock_load_rgb565_file(const std::string& path, MockFrameListSource* out) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) return 0;
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t frame_bytes = out->frame_bytes();
+    int loaded = 0;
+    for (size_t off = 0; off + frame_bytes <= data.size(); off += frame_bytes) {
+        out->add_frame(std::vector<uint8_t>(data.begin() + off, data.begin() + off + frame_bytes));
+        loaded++;
+    }
+    return loaded;
+}
+
+// --- SENSOR FORMATS ---
+
+static uint8_t mock_clamp_byte(float v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : std::lround(v)));
+}
+
+void mock_rgb565_to_yuv422(const uint8_t* src, uint8_t* dst, int pixel_count) {
+    for (int i = 0; i + 1 < pixel_count; i += 2) {
+        float y[2], u = 0, v = 0;
+        for (int k = 0; k < 2; k++) {
+            uint16_t p = ((uint16_t)src[(i + k) * 2] << 8) | src[(i + k) * 2 + 1];
+            uint8_t r5 = (p >> 11) & 0x1F, g6 = (p >> 5) & 0x3F, b5 = p & 0x1F;
+            float r = (r5 << 3) | (r5 >> 2), g = (g6 << 2) | (g6 >> 4), b = (b5 << 3) | (b5 >> 2);
+            y[k] = 0.299f * r + 0.587f * g + 0.114f * b;
+            u += (-0.168736f * r - 0.331264f * g + 0.5f * b) / 2;
+            v += (0.5f * r - 0.418688f * g - 0.081312f * b) / 2;
+        }
+        dst[i * 2] = mock_clamp_byte(y[0]);
+        dst[i * 2 + 1] = mock_clamp_byte(u + 128);
+        dst[i * 2 + 2] = mock_clamp_byte(y[1]);
+        dst[i * 2 + 3] = mock_clamp_byte(v + 128);
+    }
+}
+
+// --- ESP_CAMERA SHIM ---
+
+// Buffer states: free for the sensor, ready in the queue, or held by a caller
+enum MockFbState { MOCK_FB_FREE, MOCK_FB_READY, MOCK_FB_HELD };
+
+static MockFrameSource* mock_source = NULL;
+static std::vector<camera_fb_t> mock_fb_pool;
+static std::vector<MockFbState> mock_fb_state;
+static camera_grab_mode_t mock_grab_mode = CAMERA_GRAB_WHEN_EMPTY;
+static pixformat_t mock_format = PIXFORMAT_RGB565;
+static std::vector<std::vector<uint8_t>> mock_fb_converted;  // Per pool entry, non-RGB565 formats
+
+static std::mutex mock_lock;                // Guards everything above and below
+static std::condition_variable mock_frame_ready;
+static std::deque<size_t> mock_ready_queue; // Oldest first
+static std::thread mock_sensor_thread;
+static std::atomic<bool> mock_sensor_running(false);
+static uint32_t mock_sensor_count = 0;
+
+static int mock_sensor_set(sensor_t*, int) { return 0; }
+
+static sensor_t mock_sensor = {
+    mock_sensor_set, mock_sensor_set, mock_sensor_set, mock_sensor_set, mock_sensor_set,
+    mock_sensor_set, mock_sensor_set, mock_sensor_set, mock_sensor_set, mock_sensor_set,
+};
+
+void mock_camera_set_source(MockFrameSource* source) {
+    mock_source = source;
+}
+
+// Fills pool entry i from the source. Caller holds mock_lock.
+static bool mock_fill_buffer(size_t i) {
+    uint32_t ts = 0;
+    const uint8_t* data = mock_source->next_frame(&ts);
+    if (!data) return false;
+
+    camera_fb_t* fb = &mock_fb_pool[i];
+    fb->width = mock_source->width();
+    fb->height = mock_source->height();
+    fb->len = fb->width * fb->height * 2;
+    fb->format = mock_format;
+    if (mock_format == PIXFORMAT_YUV422) {
+        mock_fb_converted[i].resize(fb->len);
+        mock_rgb565_to_yuv422(data, mock_fb_converted[i].data(), (int)(fb->width * fb->height));
+        fb->buf = mock_fb_converted[i].data();
+    } else {
+        fb->buf = const_cast<uint8_t*>(data);
+    }
+    fb->timestamp.tv_sec = ts / 1000000;
+    fb->timestamp.tv_usec = ts % 1000000;
+    return true;
+}
+
+static void mock_sensor_loop(uint32_t frame_period_us) {
+    auto next = std::chrono::steady_clock::now();
+    while (mock_sensor_running) {
+        next += std::chrono::microseconds(frame_period_us);
+        std::this_thread::sleep_until(next);
+
+        std::lock_guard<std::mutex> guard(mock_lock);
+        if (mock_grab_mode == CAMERA_GRAB_LATEST) {
+            // Only the newest frame is kept: recycle whatever is still queued
+            for (size_t i : mock_ready_queue) mock_fb_state[i] = MOCK_FB_FREE;
+            mock_ready_queue.clear();
+        }
+
+        size_t slot = mock_fb_pool.size();
+        for (size_t i = 0; i < mock_fb_pool.size(); i++) {
+            if (mock_fb_state[i] == MOCK_FB_FREE) { slot = i; break; }
+        }
+        if (slot == mock_fb_pool.size()) continue;  // No free buffer: frame skipped
+        if (!mock_fill_buffer(slot)) continue;
+
+        mock_fb_state[slot] = MOCK_FB_READY;
+        mock_ready_queue.push_back(slot);
+        mock_sensor_count++;
+        mock_frame_ready.notify_all();
+    }
+}
+
+void mock_camera_start_sensor(uint32_t frame_period_us) {
+    mock_camera_stop_sensor();
+    {
+        std::lock_guard<std::mutex> guard(mock_lock);
+        mock_sensor_count = 0;
+    }
+    mock_sensor_running = true;
+    mock_sensor_thread = std::thread(mock_sensor_loop, frame_period_us);
+}
+
+void mock_camera_stop_sensor() {
+    if (!mock_sensor_running) return;
+    mock_sensor_running = false;
+    mock_sensor_thread.join();
+
+    // Back to on-demand frames: queued frames go back to the pool
+    std::lock_guard<std::mutex> guard(mock_lock);
+    for (size_t i : mock_ready_queue) mock_fb_state[i] = MOCK_FB_FREE;
+    mock_ready_queue.clear();
+}
+
+uint32_t mock_camera_sensor_frames() {
+    std::lock_guard<std::mutex> guard(mock_lock);
+    return mock_sensor_count;
+}
+
+// The sensor only delivers the resolution it was configured for
+static bool mock_frame_size_matches(framesize_t size, const MockFrameSource* source) {
+    static const int dims[][2] = {{160, 120}, {320, 240}, {640, 480}};  // FRAMESIZE_QQVGA, _QVGA, _VGA
+    int i = (int)size;
+    if (i < 0 || i > (int)FRAMESIZE_VGA) return false;
+    return dims[i][0] == source->width() && dims[i][1] == source->height();
+}
+
+esp_err_t esp_camera_init(const camera_config_t* config) {
+    if (!mock_source) return ESP_FAIL;
+    std::lock_guard<std::mutex> guard(mock_lock);
+    size_t count = config->fb_count ? config->fb_count : 1;
+    if (config->pixel_format != PIXFORMAT_RGB565 && config->pixel_format != PIXFORMAT_YUV422) return ESP_FAIL;
+    if (!mock_frame_size_matches(config->frame_size, mock_source)) return ESP_FAIL;
+    mock_fb_pool.assign(count, camera_fb_t());
+    mock_fb_state.assign(count, MOCK_FB_FREE);
+    mock_fb_converted.assign(count, std::vector<uint8_t>());
+    mock_ready_queue.clear();
+    mock_grab_mode = config->grab_mode;
+    mock_format = config->pixel_format;
+    return ESP_OK;
+}
+
+esp_err_t esp_camera_deinit() {
+    mock_camera_stop_sensor();
+    std::lock_guard<std::mutex> guard(mock_lock);
+    mock_fb_pool.clear();
+    mock_fb_state.clear();
+    return ESP_OK;
+}
+
+camera_fb_t* esp_camera_fb_get() {
+    if (!mock_source) return NULL;
+    std::unique_lock<std::mutex> guard(mock_lock);
+
+    if (mock_sensor_running) {
+        if (!mock_frame_ready.wait_for(guard, std::chrono::seconds(1),
+                                       [] { return !mock_ready_queue.empty(); })) {
+            return NULL;  // Sensor timeout, like the driver's
+        }
+        size_t i = mock_ready_queue.front();
+        mock_ready_queue.pop_front();
+        mock_fb_state[i] = MOCK_FB_HELD;
+        return &mock_fb_pool[i];
+    }
+
+    for (size_t i = 0; i < mock_fb_pool.size(); i++) {
+        if (mock_fb_state[i] != MOCK_FB_FREE) continue;
+        if (!mock_fill_buffer(i)) return NULL;
+        mock_fb_state[i] = MOCK_FB_HELD;
+        return &mock_fb_pool[i];
+    }
+    return NULL; // Pool exhausted: caller is holding every buffer
+}
+
+void esp_camera_fb_return(camera_fb_t* fb) {
+    std::lock_guard<std::mutex> guard(mock_lock);
+    for (size_t i = 0; i < mock_fb_pool.size(); i++) {
+        if (&mock_fb_pool[i] == fb) mock_fb_state[i] = MOCK_FB_FREE;
+    }
+}
+
+sensor_t* esp_camera_sensor_get() {
+    return &mock_sensor;
+}
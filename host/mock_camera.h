@@ -0,0 +1,93 @@
+/* MOCK_CAMERA.H - Frame sources behind the host esp_camera shim
+ *
+ * Install a source with mock_camera_set_source(), then the unmodified
+ * eyes_init()/eyes_snap()/eyes_release() calls run against it.
+ *
+ * Frames are raw RGB565 in camera byte order (high byte first), the same
+ * layout eyes_process_frame() reads and laptop.ino sends to viewer.py.
+ * A camera configured for PIXFORMAT_YUV422 gets each frame converted by
+ * mock_rgb565_to_yuv422(), the way the sensor would deliver it.
+ *
+ * By default esp_camera_fb_get() pulls the next frame on demand. With
+ * mock_camera_start_sensor() a sensor thread delivers frames on a fixed
+ * clock instead, the way DMA fills buffers on the robot, so capture and
+ * processing can overlap (or not) like they do there.
+ *
+ * Sources:
+ *   MockFrameListSource - serves an in-memory list of frames, optionally looping
+ *   mock_render_scene() - fills a list with synthetic scenes
+ *   mock_load_rgb565_file() - fills a list from a raw dump (1+ frames per file)
+ */
+
+#ifndef MOCK_CAMERA_H
+#define MOCK_CAMERA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "esp_camera.h"
+
+class MockFrameSource {
+public:
+    virtual ~MockFrameSource() {}
+
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+
+    // Next frame in camera byte order, or NULL when the source is exhausted.
+    // The pointer must stay valid until the frame is returned.
+    virtual const uint8_t* next_frame(uint32_t* timestamp_us) = 0;
+};
+
+class MockFrameListSource : public MockFrameSource {
+public:
+    MockFrameListSource(int width, int height, bool loop = true)
+        : width_(width), height_(height), loop_(loop), index_(0) {}
+
+    int width() const override { return width_; }
+    int height() const override { return height_; }
+    const uint8_t* next_frame(uint32_t* timestamp_us) override;
+
+    void add_frame(const std::vector<uint8_t>& frame) { frames_.push_back(frame); }
+    size_t frame_count() const { return frames_.size(); }
+    const uint8_t* frame(size_t i) const { return frames_[i].data(); }
+    size_t frame_bytes() const { return (size_t)width_ * height_ * 2; }
+    void rewind() { index_ = 0; }
+
+private:
+    int width_, height_;
+    bool loop_;
+    size_t index_;
+    std::vector<std::vector<uint8_t>> frames_;
+};
+
+// SYNTHETIC SCENES
+typedef enum {
+    MOCK_SCENE_EMPTY,   // Low-saturation noise only (scan mode)
+    MOCK_SCENE_PILLAR,  // Yellow pillar drifting across the frame
+    MOCK_SCENE_MIXED,   // Pillar plus two pink obstacles and speckle
+} MockScene;
+
+bool mock_scene_from_name(const char* name, MockScene* scene);
+void mock_render_scene(MockScene scene, int frame_count, uint32_t seed, MockFrameListSource* out);
+
+// Loads every whole frame in a raw RGB565 dump. Returns frames loaded.
+int mock_load_rgb565_file(const std::string& path, MockFrameListSource* out);
+
+// SENSOR FORMATS - YUV422 as the sensor sends it: Y0 U Y1 V per pixel pair,
+// BT.601 full range, chroma averaged over the pair. pixel_count is even.
+void mock_rgb565_to_yuv422(const uint8_t* src, uint8_t* dst, int pixel_count);
+
+// CAMERA HOOKUP
+void mock_camera_set_source(MockFrameSource* source);
+
+// SENSOR THREAD - frames arrive every frame_period_us whether or not anyone
+// is waiting. esp_camera_fb_get() blocks until one is ready (NULL after 1 s).
+// CAMERA_GRAB_WHEN_EMPTY queues frames and skips sensor frames while every
+// buffer is full; CAMERA_GRAB_LATEST keeps only the newest ready frame.
+void mock_camera_start_sensor(uint32_t frame_period_us);
+void mock_camera_stop_sensor();
+uint32_t mock_camera_sensor_frames();  // Frames the sensor put into a buffer
+
+#endif // MOCK_CAMERA_H
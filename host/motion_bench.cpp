@@ -0,0 +1,146 @@
+/* MOTION_BENCH - Pablo_main/motor_control.h's motion profile on a simulated clock
+ *
+ * Usage:
+ *   motion_bench [--seed S]
+ *
+ * Plays captureMode()'s pattern: a driveControl() call on every vision
+ * frame (at 10, 30 and 60 fps) following one command script (straight,
+ * turn, spin, stop), while the drive task steps driveUpdateAt() every
+ * 10 ms give or take 3 ms of jitter. For each frame rate: time to 90% of
+ * the first target, the old rampUp(0,40,2)'s time for the same ramp,
+ * peak acceleration and jerk, overshoot and servo writes, next to the
+ * old driveControl()'s (both servos on every call) and a write per side
+ * per drive step.
+ */
+
+#include <Arduino.h>  // Sketch headers get it from the .ino build
+#include "bench_args.h"
+#include "motor_control.h"
+#include "schedule.h"
+
+#include <random>
+#include <vector>
+
+#define MOTION_BENCH_SECONDS 3
+#define MOTION_BENCH_START_US 1000000  // Simulated clock at t = 0
+#define MOTION_BENCH_UPDATE_US DRIVE_PERIOD_US
+#define MOTION_BENCH_JITTER_US 3000
+
+struct MotionCommand {
+    uint32_t from_us;
+    int left, right;
+};
+
+// Straight, turn, spin, stop
+static const MotionCommand MOTION_SCRIPT[] = {
+    {0, 40, 40}, {1000000, 40, 10}, {1600000, -20, 20}, {2200000, 0, 0},
+};
+
+struct MotionRun {
+    int fps;
+    double rise_ms = -1;      // Left side to 90% of the first target
+    double old_rise_ms;       // rampUp(0,40,2) at this frame rate
+    double peak_accel = 0;
+    double peak_jerk = 0;
+    double overshoot = 0;     // Past any target, speed units
+    uint32_t writes = 0;
+    uint32_t old_writes = 0;
+    uint32_t steps = 0;       // driveUpdateAt() calls
+};
+
+static const MotionCommand& command_at(uint32_t t) {
+    const int n = sizeof(MOTION_SCRIPT) / sizeof(MOTION_SCRIPT[0]);
+    int i = n - 1;
+    while (i > 0 && MOTION_SCRIPT[i].from_us > t) i--;
+    return MOTION_SCRIPT[i];
+}
+
+static void run(int fps, uint32_t seed, MotionRun* r) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> jitter(-MOTION_BENCH_JITTER_US, MOTION_BENCH_JITTER_US);
+    driveHalt();
+    driveLastUs = MOTION_BENCH_START_US;
+    uint32_t writes0 = leftDrive.writes() + rightDrive.writes();
+    r->fps = fps;
+    r->old_rise_ms = 40 / 2 * 1000.0 / fps;  // 2 units per call, one call per frame
+
+    const uint32_t frame_us = 1000000 / fps;
+    const uint32_t end = MOTION_BENCH_SECONDS * 1000000;
+    uint32_t next_frame = 0, next_update = MOTION_BENCH_UPDATE_US;
+    float last_speed[2] = {0, 0}, last_accel[2] = {0, 0};
+    uint32_t last_t = 0;
+    while (next_frame < end || next_update < end) {
+        if (next_frame <= next_update) {
+            const MotionCommand& c = command_at(next_frame);
+            driveControl(c.left, c.right);
+            r->old_writes += 2;
+            next_frame += frame_us;
+            continue;
+        }
+
+        uint32_t t = next_update;
+        driveUpdateAt(MOTION_BENCH_START_US + t);
+        r->steps++;
+        const MotionCommand& c = command_at(t);
+        const DriveAxis* axes[2] = {&leftAxis, &rightAxis};
+        const int targets[2] = {c.left, c.right};
+        double dt = (t - last_t) * 1e-6;
+        for (int s = 0; s < 2; s++) {
+            float speed = axes[s]->speed;
+            double accel = (speed - last_speed[s]) / dt;
+            r->peak_accel = max(r->peak_accel, fabs(accel));
+            r->peak_jerk = max(r->peak_jerk, fabs(axes[s]->accel - last_accel[s]) / dt);
+            // Moving away from the target it is heading for, beyond it
+            double past = targets[s] >= last_speed[s] ? speed - targets[s] : targets[s] - speed;
+            r->overshoot = max(r->overshoot, past);
+            last_speed[s] = speed;
+            last_accel[s] = axes[s]->accel;
+        }
+        if (r->rise_ms < 0 && leftAxis.speed >= 0.9f * MOTION_SCRIPT[0].left) r->rise_ms = t / 1000.0;
+        last_t = t;
+        next_update += MOTION_BENCH_UPDATE_US + jitter(rng);
+    }
+    r->writes = leftDrive.writes() + rightDrive.writes() - writes0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t seed = 1;
+    BenchArgs args("motion_bench [--seed S]");
+    args.option("--seed", &seed);
+    if (!args.parse(argc, argv)) return 2;
+
+    leftDrive.attach(4);
+    rightDrive.attach(5);
+    printf("motion_bench: %d s script, drive step %d +- %d us, max accel %.0f /s, max jerk %.0f /s^2\n\n",
+           MOTION_BENCH_SECONDS, MOTION_BENCH_UPDATE_US, MOTION_BENCH_JITTER_US, DRIVE_MAX_ACCEL, DRIVE_MAX_JERK);
+
+    const int rates[] = {10, 30, 60};
+    std::vector<MotionRun> runs(3);
+    for (int i = 0; i < 3; i++) run(rates[i], seed, &runs[i]);
+
+    printf("%-12s %10s %10s %10s %10s %10s %10s %10s %10s\n", "vision fps", "rise ms", "rampUp ms", "accel", "jerk",
+           "overshoot", "writes", "old writes", "per step");
+    for (const MotionRun& r : runs) {
+        printf("%-12d %10.0f %10.0f %10.0f %10.0f %10.2f %10u %10u %10u\n", r.fps, r.rise_ms, r.old_rise_ms,
+               r.peak_accel, r.peak_jerk, r.overshoot, r.writes, r.old_writes, r.steps * 2);
+    }
+    printf("\n");
+
+    double rise_min = runs[0].rise_ms, rise_max = runs[0].rise_ms;
+    bool limits = true, smooth = true, fewer = true;
+    for (const MotionRun& r : runs) {
+        rise_min = min(rise_min, r.rise_ms);
+        rise_max = max(rise_max, r.rise_ms);
+        limits &= r.rise_ms >= 0 && r.peak_accel <= DRIVE_MAX_ACCEL * 1.001 && r.overshoot <= 0.001;
+        smooth &= r.peak_jerk <= DRIVE_MAX_JERK * 1.001;
+        fewer &= r.writes < r.steps;
+    }
+    bool same = rise_max - rise_min <= (MOTION_BENCH_UPDATE_US + MOTION_BENCH_JITTER_US) / 1000.0;
+    printf("verify: ramp time independent of vision rate (spread %.0f ms, one drive step allowed): %s\n",
+           rise_max - rise_min, same ? "ok" : "FAIL");
+    printf("verify: acceleration within DRIVE_MAX_ACCEL, no overshoot: %s\n", limits ? "ok" : "FAIL");
+    printf("verify: peak jerk <= DRIVE_MAX_JERK, through the last step onto each target: %s\n",
+           smooth ? "ok" : "FAIL");
+    printf("verify: servos written on pulse changes only (under half the drive steps): %s\n", fewer ? "ok" : "FAIL");
+    return same && limits && smooth && fewer ? 0 : 1;
+}
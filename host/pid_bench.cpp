@@ -0,0 +1,131 @@
+/* PID_BENCH - Pablo_main/pid.h's pillar alignment on a simulated turn
+ *
+ * Usage:
+ *   pid_bench [--fps F] [--offset PX] [--seed S]
+ *
+ * The pillar starts PX pixels off center. The camera delivers a frame
+ * every 1/F s (give or take 20%), each one showing the offset at its
+ * capture time. findPillar() feeds every frame to pillarPID(); the old
+ * pillarPID() took a second capture of its own, so it only got every
+ * other frame. Both drive the turn through motor_control.h's profile
+ * (driveUpdateAt() every 10 ms), and the pillar moves across the image
+ * as the robot turns.
+ *
+ * Reported per path: control updates per second, time from the pillar
+ * first reaching center to the stop command, time until the offset stays
+ * within DEADZONE, overshoot past center and the turn output's peak. The
+ * check is the one-frame path updating twice as often and reacting
+ * within a frame, with the output inside PILLAR_MAX_TURN.
+ */
+
+#include <Arduino.h>  // Sketch headers get it from the .ino build
+#include "bench_args.h"
+#include "motor_control.h"
+#include "pid.h"
+#include "schedule.h"
+
+#include <random>
+
+#define PID_BENCH_SECONDS 4
+#define PID_BENCH_UPDATE_US DRIVE_PERIOD_US
+#define PID_BENCH_PX_PER_UNIT 8.0  // Image drift, px/s per unit of turn speed
+#define PID_BENCH_HOLD_US 500000   // Settled = within DEADZONE this long
+
+struct PidBenchOptions {
+    int fps = 20;
+    int offset = 120;
+    uint32_t seed = 1;
+};
+
+struct PidRun {
+    const char* name;
+    int frames_per_update;
+    uint32_t updates = 0;
+    double settle_ms = -1;
+    double react_ms = -1;  // First time centered -> first stop command
+    double overshoot = 0;  // Pixels past center, on the far side
+    int peak_turn = 0;
+};
+
+static void run(const PidBenchOptions& opt, PidRun* r) {
+    std::mt19937 rng(opt.seed);
+    const uint32_t frame_us = 1000000 / opt.fps;
+    std::uniform_int_distribution<int> jitter(-(int)frame_us / 5, (int)frame_us / 5);
+
+    driveHalt();
+    pillarPid.reset();
+    driveLastUs = 0;
+    double offset = opt.offset;
+    const double side = offset > 0 ? 1 : -1;
+    uint32_t next_frame = frame_us, next_update = PID_BENCH_UPDATE_US, in_since = 0;
+    uint32_t frame = 0, t = 0, first_in = 0;
+    bool inside = false;
+    const uint32_t end = PID_BENCH_SECONDS * 1000000;
+
+    while (t < end) {
+        uint32_t next = min(next_frame, next_update);
+        // Turning right (left side faster) moves the pillar left in the image
+        double turn = (leftAxis.speed - rightAxis.speed) / 2;
+        offset -= PID_BENCH_PX_PER_UNIT * turn * (next - t) * 1e-6;
+        t = next;
+
+        r->overshoot = max(r->overshoot, -side * offset);
+        bool now_inside = labs(lround(offset)) <= DEADZONE;  // As pillarPID() sees it
+        if (now_inside && !inside) in_since = t;
+        if (now_inside && first_in == 0) first_in = t;
+        inside = now_inside;
+        if (r->settle_ms < 0 && inside && t - in_since >= PID_BENCH_HOLD_US) r->settle_ms = in_since / 1000.0;
+
+        if (next_update <= next_frame) {
+            driveUpdateAt(t);
+            next_update += PID_BENCH_UPDATE_US;
+        } else {
+            if (++frame % r->frames_per_update == 0) {
+                bool turning = pillarPID((int16_t)lround(offset), t);
+                if (!turning && r->react_ms < 0) r->react_ms = (t - first_in) / 1000.0;
+                r->updates++;
+                r->peak_turn = max(r->peak_turn, (int)fabs(leftAxis.target));
+            }
+            next_frame += frame_us + jitter(rng);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    PidBenchOptions opt;
+    BenchArgs args("pid_bench [--fps F] [--offset PX] [--seed S]");
+    args.option("--fps", &opt.fps);
+    args.option("--offset", &opt.offset);
+    args.option("--seed", &opt.seed);
+    if (!args.parse(argc, argv)) return 2;
+    if (opt.fps <= 0) {
+        fprintf(stderr, "pid_bench: --fps must be positive\n");
+        return 2;
+    }
+
+    leftDrive.attach(4);
+    rightDrive.attach(5);
+    printf("pid_bench: %d px start, camera %d fps, kp %.2f ki %.2f kd %.3f, max turn %d\n\n", opt.offset, opt.fps,
+           PILLAR_KP, PILLAR_KI, PILLAR_KD, PILLAR_MAX_TURN);
+
+    PidRun runs[2] = {{"two frames", 2}, {"one frame", 1}};
+    for (PidRun& r : runs) run(opt, &r);
+
+    printf("%-12s %10s %10s %10s %10s %10s\n", "path", "updates/s", "react ms", "settle ms", "overshoot",
+           "peak turn");
+    for (const PidRun& r : runs) {
+        printf("%-12s %10.1f %10.0f %10.0f %10.1f %10d\n", r.name, (double)r.updates / PID_BENCH_SECONDS, r.react_ms,
+               r.settle_ms, r.overshoot, r.peak_turn);
+    }
+    printf("\n");
+
+    const PidRun &old_run = runs[0], &new_run = runs[1];
+    bool rate = new_run.updates >= 2 * old_run.updates - 1;
+    // Frames run up to 20% long
+    bool react = new_run.react_ms >= 0 && new_run.react_ms <= 1.2 * 1000.0 / opt.fps && new_run.settle_ms >= 0;
+    bool clamped = new_run.peak_turn <= PILLAR_MAX_TURN && old_run.peak_turn <= PILLAR_MAX_TURN;
+    printf("verify: one frame per update, twice the update rate: %s\n", rate ? "ok" : "FAIL");
+    printf("verify: stops within a frame of reaching center, and stays there: %s\n", react ? "ok" : "FAIL");
+    printf("verify: turn output within PILLAR_MAX_TURN: %s\n", clamped ? "ok" : "FAIL");
+    return rate && react && clamped ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/* RES_BENCH - eyes.h per-stage cost and reach at QQVGA, QVGA and VGA
+ *
+ * Usage:
+ *   res_bench [--frames N] [--scene empty|pillar|mixed] [--seed S]
+ *
+ * Each frame size is its own eyes.h build (EYES_FRAMESIZE, see
+ * res_bench_size.cpp), run over the same synthetic scene rendered at that
+ * size. Reported per size:
+ *   stages      mean us of the coarse pass, classify, close, label and
+ *               blob queries on full frames, and the whole eyes_snap()
+ *               (coarse-to-fine on), with the cost relative to QQVGA
+ *   memory      eyes.h working memory (arena) and one RGB565 frame
+ *   range       narrowest lone pillar found at every position against the
+ *               coarse grid, in QQVGA pixels; half the width is twice the
+ *               distance
+ *   yellow      frames with a yellow detection; on the empty scene these
+ *               are false finds, which more pixels make more likely
+ *   large blob  area and offset_x of a frame-high pillar over columns
+ *               15/32..25/32 (96000 pixels at VGA), found / exact
+ * The checks are every size finding the pillar on every frame of the
+ * pillar and mixed scenes, at the same offset as QQVGA (scaled to QQVGA
+ * pixels, within 2 px), and no larger size seeing less far than a smaller
+ * one, and the large blob's area and offset being exact at every size.
+ */
+
+#include <Arduino.h>  // Before res_bench.h: the shim's min/max
+
+#include "bench_args.h"
+#include "res_bench.h"
+
+#include <cmath>
+#include <string>
+
+#define RES_BENCH_MAX_OFFSET 2.0  // QQVGA px a larger size's yellow offset may differ by (QQVGA rounds to whole px)
+
+void res_bench_render_pillar(int width, int height, double center_x, double width_px, uint32_t seed,
+                             std::vector<uint8_t>* frame) {
+    uint32_t rng = seed ? seed : 1;
+    double x0 = center_x - width_px / 2, x1 = center_x + width_px / 2;
+    double y0 = height / 2.0 - 2 * width_px, y1 = height / 2.0 + 2 * width_px;
+    frame->assign((size_t)width * height * 2, 0);
+    for (int y = 0; y < height; y++) {
+        double cover_y = std::max(0.0, std::min(y + 1.0, y1) - std::max((double)y, y0));
+        for (int x = 0; x < width; x++) {
+            double cover = cover_y * std::max(0.0, std::min(x + 1.0, x1) - std::max((double)x, x0));
+            int base = 60 + (y * 40) / height;  // mock_render_scene()'s background
+            int rgb[3] = {230, 200, 40};
+            uint16_t pixel = 0;
+            for (int k = 0; k < 3; k++) {
+                rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+                int bg = constrain(base + (int)(rng % 25) - 12, 0, 255);
+                int v = (int)lround(bg + (rgb[k] - bg) * cover);
+                pixel = (pixel << (k == 1 ? 6 : 5)) | (v >> (k == 1 ? 2 : 3));
+            }
+            (*frame)[(y * width + x) * 2] = pixel >> 8;
+            (*frame)[(y * width + x) * 2 + 1] = pixel & 0xFF;
+        }
+    }
+}
+
+static bool parse_args(int argc, char** argv, ResBenchOptions* opt) {
+    BenchArgs args("res_bench [--frames N] [--scene empty|pillar|mixed] [--seed S]");
+    args.option("--frames", &opt->frames);
+    args.option("--scene", [opt](const char* v) { return mock_scene_from_name(v, &opt->scene); });
+    args.option("--seed", &opt->seed);
+    return args.parse(argc, argv, [opt] { return opt->frames > 0; });
+}
+
+int main(int argc, char** argv) {
+    ResBenchOptions opt;
+    if (!parse_args(argc, argv, &opt)) return 2;
+
+    ResBenchResult runs[3];
+    res_bench_run_qqvga(opt, &runs[0]);
+    res_bench_run_qvga(opt, &runs[1]);
+    res_bench_run_vga(opt, &runs[2]);
+    for (const ResBenchResult& r : runs) {
+        if (!r.ok) {
+            fprintf(stderr, "res_bench: %s run failed\n", r.name);
+            return 1;
+        }
+    }
+
+    printf("\nres_bench: %d frames per size\n\n", opt.frames);
+    printf("%-22s", "mean us (x QQVGA)");
+    for (const ResBenchResult& r : runs) printf(" %19s", (r.name + std::string(" ") + std::to_string(r.width) + "x" +
+                                                          std::to_string(r.height)).c_str());
+    printf("\n");
+    for (int s = 0; s < RES_BENCH_STAGES; s++) {
+        printf("%-22s", runs[0].stages[s].name().c_str());
+        for (const ResBenchResult& r : runs) {
+            double base = runs[0].stages[s].mean_us();
+            printf(" %10.1f (%5.1fx)", r.stages[s].mean_us(), base > 0 ? r.stages[s].mean_us() / base : 0);
+        }
+        printf("\n");
+    }
+    printf("%-22s", "pixels");
+    for (const ResBenchResult& r : runs) printf(" %10d (%5.1fx)", r.width * r.height,
+                                                (double)r.width * r.height / (runs[0].width * runs[0].height));
+    printf("\n%-22s", "working memory, bytes");
+    for (const ResBenchResult& r : runs) printf(" %19zu", r.working_bytes);
+    printf("\n%-22s", "frame buffer, bytes");
+    for (const ResBenchResult& r : runs) printf(" %19d", r.width * r.height * 2);
+    printf("\n%-22s", "narrowest pillar, px");
+    for (const ResBenchResult& r : runs) printf(" %19.2f", r.narrowest);
+    printf("\n%-22s", "relative range");
+    for (const ResBenchResult& r : runs) printf(" %18.1fx", r.narrowest > 0 ? runs[0].narrowest / r.narrowest : 0);
+    printf("\n%-22s", "large blob area");
+    bool large = true;
+    for (const ResBenchResult& r : runs) {
+        printf(" %19s", (std::to_string(r.large_area) + " / " + std::to_string(r.large_expected)).c_str());
+        large &= r.large_area == r.large_expected && r.large_offset == r.large_expected_offset;
+    }
+    printf("\n%-22s", "large blob offset");
+    for (const ResBenchResult& r : runs) {
+        printf(" %19s", (std::to_string(r.large_offset) + " / " + std::to_string(r.large_expected_offset)).c_str());
+    }
+    printf("\n");
+
+    // The pillar and mixed scenes have the pillar in every frame, the empty
+    // scene never
+    bool pillar = opt.scene != MOCK_SCENE_EMPTY;
+    bool agree = true, reach = true;
+    double worst = 0;
+    printf("%-22s", pillar ? "frames with yellow" : "yellow (false) finds");
+    for (int i = 0; i < 3; i++) {
+        const std::vector<float>& a = runs[0].yellow_offset;
+        const std::vector<float>& b = runs[i].yellow_offset;
+        int found = 0;
+        for (size_t f = 0; f < b.size(); f++) {
+            found += !std::isnan(b[f]);
+            if (pillar && f < a.size() && !std::isnan(a[f]) && !std::isnan(b[f])) {
+                worst = std::max(worst, (double)fabsf(a[f] - b[f]));
+            }
+        }
+        printf(" %19d", found);
+        agree &= !pillar || found == opt.frames;
+        if (i > 0) {
+            double prev = runs[i - 1].narrowest;
+            reach &= runs[i].narrowest > 0 && (prev == 0 || runs[i].narrowest <= prev);
+        }
+    }
+    printf("\n(pillar widths in QQVGA pixels; range is inverse to the narrowest width found)\n\n");
+    agree &= worst <= RES_BENCH_MAX_OFFSET;
+    if (pillar) {
+        printf("verify: every size finds the pillar on every frame, offset within %.0f px of QQVGA (worst %.2f): %s\n",
+               RES_BENCH_MAX_OFFSET, worst, agree ? "ok" : "FAIL");
+    }
+    printf("verify: a larger frame sees at least as narrow a pillar: %s\n", reach ? "ok" : "FAIL");
+    printf("verify: a frame-high pillar reports its whole area and centroid at every size: %s\n",
+           large ? "ok" : "FAIL");
+    return agree && reach && large ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+/* RES_BENCH.H - One eyes.h build per frame size, for res_bench
+ *
+ * res_bench_size.cpp is compiled once per EYES_FRAMESIZE, each time with
+ * its own EYES_NAMESPACE, and exports res_bench_run_<size>().
+ * res_bench.cpp runs them all and prints the table.
+ */
+
+#ifndef RES_BENCH_H
+#define RES_BENCH_H
+
+#include "bench_stats.h"
+#include "mock_camera.h"
+
+#include <vector>
+
+enum {
+    RES_BENCH_COARSE,
+    RES_BENCH_CLASSIFY,
+    RES_BENCH_CLOSE,
+    RES_BENCH_LABEL,
+    RES_BENCH_QUERY,
+    RES_BENCH_FRAME,
+    RES_BENCH_STAGES
+};
+
+struct ResBenchOptions {
+    int frames = 500;
+    MockScene scene = MOCK_SCENE_MIXED;
+    uint32_t seed = 1;
+};
+
+struct ResBenchResult {
+    const char* name = "";
+    int width = 0, height = 0;
+    size_t working_bytes = 0;            // eyes.h arena: stream rings + labeler
+    std::vector<BenchSamples> stages;    // RES_BENCH_* order
+    std::vector<float> yellow_offset;    // Per frame, in QQVGA pixels; NAN when not found
+    double narrowest = 0;                // Narrowest pillar found, QQVGA pixels (0 = none)
+    uint32_t large_area = 0;             // Frame-high pillar over columns 15/32..25/32: area found
+    uint32_t large_expected = 0;         // and its pixel count
+    int large_offset = 0;                // offset_x found
+    int large_expected_offset = 0;       // and its centroid's
+    bool ok = false;                     // eyes_init() and every capture worked
+};
+
+// Pillar widths tried for the range check, in QQVGA pixels, narrowest first
+static const double RES_BENCH_PILLAR_WIDTHS[] = {0.5, 0.75, 1, 1.5, 2, 3, 4, 6};
+
+// A lone yellow pillar centered on column center_x (fractional), width_px
+// wide and four times as tall, on the synthetic scenes' background. Edge
+// pixels blend by coverage, as the sensor averages them.
+void res_bench_render_pillar(int width, int height, double center_x, double width_px, uint32_t seed,
+                             std::vector<uint8_t>* frame);
+
+void res_bench_run_qqvga(const ResBenchOptions& opt, ResBenchResult* out);
+void res_bench_run_qvga(const ResBenchOptions& opt, ResBenchResult* out);
+void res_bench_run_vga(const ResBenchOptions& opt, ResBenchResult* out);
+
+#endif // RES_BENCH_H
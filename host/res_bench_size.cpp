@@ -0,0 +1,142 @@
+/* RES_BENCH_SIZE - res_bench's per-frame-size half (see res_bench.h)
+ *
+ * Built with EYES_FRAMESIZE, RES_BENCH_SIZE (qqvga, qvga, vga) and
+ * EYES_NAMESPACE (res_bench_<size>) set: eyes.h's inline functions differ
+ * per size, so each size keeps its own names, tables and state.
+ */
+
+#include "eyes.h"
+#include "res_bench.h"
+
+#include <cmath>
+
+#define RES_BENCH_CAT2(a, b) a##b
+#define RES_BENCH_CAT(a, b) RES_BENCH_CAT2(a, b)
+
+using namespace EYES_NAMESPACE;
+
+static void label_planes(const EyesMaskWord* planes, EyesLabeler* lab) {
+    int row_words = EYES_NUM_CLASSES * eyes_mask_words(EYES_IMG_WIDTH);
+    eyes_labeler_reset(lab, EYES_IMG_WIDTH);
+    for (int y = 0; y < EYES_IMG_HEIGHT; y++) eyes_labeler_push_row(lab, planes + y * row_words);
+    eyes_labeler_finish(lab);
+}
+
+// Stages one at a time on the full frame, as eyes_bench times them, then
+// the whole eyes_snap()
+static bool bench_stages(const ResBenchOptions& opt, ResBenchResult* out) {
+    const int w = EYES_IMG_WIDTH, h = EYES_IMG_HEIGHT;
+    std::vector<EyesMaskWord> masks(EYES_MASK_TOTAL_WORDS), temp(EYES_MASK_TOTAL_WORDS);
+    std::vector<EyesTileMask> tiles(EYES_TILE_GRID_ROWS);
+    EyesLabeler* lab = new EyesLabeler;
+    EyesBlobInfo blobs[EYES_CANDIDATE_BLOBS];
+    bool ok = true;
+
+    for (int f = 0; f < opt.frames; f++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) {
+            ok = false;
+            break;
+        }
+        uint64_t t0 = bench_now_ns();
+        eyes_coarse_tiles(fb->buf, w, h, w * 2, tiles.data());
+        uint64_t t1 = bench_now_ns();
+        eyes_classify_frame(fb->buf, masks.data(), w, h);
+        uint64_t t2 = bench_now_ns();
+        eyes_packed_close(masks.data(), temp.data(), w, h, EYES_CLOSE_KERNEL);
+        uint64_t t3 = bench_now_ns();
+        label_planes(masks.data(), lab);
+        uint64_t t4 = bench_now_ns();
+        for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+            eyes_find_top_n_blobs(lab, c, blobs, EYES_CANDIDATE_BLOBS, EYES_TARGETS[c].min_area);
+        }
+        uint64_t t5 = bench_now_ns();
+        esp_camera_fb_return(fb);
+
+        out->stages[RES_BENCH_COARSE].add(t1 - t0);
+        out->stages[RES_BENCH_CLASSIFY].add(t2 - t1);
+        out->stages[RES_BENCH_CLOSE].add(t3 - t2);
+        out->stages[RES_BENCH_LABEL].add(t4 - t3);
+        out->stages[RES_BENCH_QUERY].add(t5 - t4);
+    }
+    delete lab;
+    return ok;
+}
+
+static bool bench_frames(const ResBenchOptions& opt, ResBenchResult* out) {
+    for (int f = 0; f < opt.frames; f++) {
+        uint64_t t0 = bench_now_ns();
+        eyes_snap();
+        out->stages[RES_BENCH_FRAME].add(bench_now_ns() - t0);
+        if (!eyes_get_framebuffer()) return false;
+        out->yellow_offset.push_back(eyes_get_yellow_found() ? (float)eyes_get_yellow_offset_x() / EYES_PX_SCALE
+                                                              : NAN);
+        eyes_release();
+    }
+    return true;
+}
+
+// Narrowest pillar found wherever it sits against the coarse sample grid
+static double narrowest_pillar(uint32_t seed) {
+    const int positions = 8;
+    for (double width : RES_BENCH_PILLAR_WIDTHS) {
+        MockFrameListSource source(EYES_IMG_WIDTH, EYES_IMG_HEIGHT, false);
+        for (int p = 0; p < positions; p++) {
+            // p/8 of a coarse step off center: every phase of the sample grid
+            double center = EYES_IMG_WIDTH / 2 + (double)p * EYES_COARSE_STEP / positions;
+            std::vector<uint8_t> frame;
+            res_bench_render_pillar(EYES_IMG_WIDTH, EYES_IMG_HEIGHT, center, width * EYES_PX_SCALE, seed + p, &frame);
+            source.add_frame(frame);
+        }
+        mock_camera_set_source(&source);
+        int found = 0;
+        for (int p = 0; p < positions; p++) {
+            eyes_snap();
+            found += eyes_get_yellow_found();
+            eyes_release();
+        }
+        if (found == positions) return width;
+    }
+    return 0;
+}
+
+// A pillar as high as the frame and 5/16 of it wide, right of center: at
+// VGA 96000 pixels, more than a 16-bit area holds
+static void large_blob(uint32_t seed, ResBenchResult* out) {
+    const int x0 = EYES_IMG_WIDTH * 15 / 32, x1 = EYES_IMG_WIDTH * 25 / 32;
+    MockFrameListSource source(EYES_IMG_WIDTH, EYES_IMG_HEIGHT, false);
+    std::vector<uint8_t> frame;
+    res_bench_render_pillar(EYES_IMG_WIDTH, EYES_IMG_HEIGHT, (x0 + x1) / 2.0, x1 - x0, seed, &frame);
+    source.add_frame(frame);
+    mock_camera_set_source(&source);
+    eyes_snap();
+    out->large_area = eyes_get_yellow_area();
+    out->large_offset = eyes_get_yellow_offset_x();
+    eyes_release();
+    out->large_expected = (uint32_t)(x1 - x0) * EYES_IMG_HEIGHT;
+    out->large_expected_offset = (x0 + x1 - 1) / 2 - EYES_IMG_WIDTH / 2;
+}
+
+void RES_BENCH_CAT(res_bench_run_, RES_BENCH_SIZE)(const ResBenchOptions& opt, ResBenchResult* out) {
+    static const char* const names[RES_BENCH_STAGES] = {"coarse pass", "classify", "close", "label",
+                                                         "blob queries", "frame (eyes_snap)"};
+    out->name = EYES_FRAMESIZE == EYES_QQVGA ? "QQVGA" : EYES_FRAMESIZE == EYES_QVGA ? "QVGA" : "VGA";
+    out->width = EYES_IMG_WIDTH;
+    out->height = EYES_IMG_HEIGHT;
+    out->working_bytes = EYES_ARENA_SIZE;
+    out->stages.clear();
+    for (const char* name : names) out->stages.emplace_back(name);
+
+    MockFrameListSource source(EYES_IMG_WIDTH, EYES_IMG_HEIGHT, true);
+    mock_render_scene(opt.scene, 120, opt.seed, &source);
+    mock_camera_set_source(&source);
+    if (!eyes_init()) return;
+
+    out->ok = bench_stages(opt, out);
+    source.rewind();
+    out->ok = out->ok && bench_frames(opt, out);
+    out->narrowest = narrowest_pillar(opt.seed);
+    large_blob(opt.seed, out);
+    esp_camera_deinit();
+    mock_camera_set_source(NULL);
+}
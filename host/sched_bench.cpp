@@ -0,0 +1,212 @@
+/* SCHED_BENCH - Input latency under Pablo_main/scheduler.h vs the old loop()
+ *
+ * Usage:
+ *   sched_bench [--ms T] [--frame-us F] [--seed S]
+ *
+ * Replays the same random IR codes and line crossings through three
+ * loops, each for T ms, and measures event -> handler latency:
+ *   serial loop      the old loop(): vision, then line, then IR, each
+ *                    vision call blocking for a frame (F us, eyes_snap())
+ *   sched, sync      scheduler.h tasks, vision still blocking
+ *   sched, async     scheduler.h tasks, vision only picking up results
+ *                    (a few us, eyes_latest() with the vision task)
+ * Task periods and budgets come from Pablo_main/schedule.h, the header
+ * Pablo_main.ino registers its tasks with. Each IR code is handled as
+ * Delivery Start, by the sketch's own lineSearch() (on and off the line in
+ * turn), so a handler that blocks shows up as an IR overrun. Other work is
+ * simulated by spinning on micros(), so the host's timer resolution does
+ * not matter.
+ */
+
+#include <Arduino.h>  // Sketch headers get it from the .ino build
+
+#include "auto_routines.h"
+#include "scheduler.h"
+#include "schedule.h"
+
+#include "bench_args.h"
+#include "bench_stats.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#define SCHED_BENCH_ASYNC_US 40      // eyes_latest() + decision, async
+#define SCHED_BENCH_IR_US 30         // Decode + dispatch
+#define SCHED_BENCH_LINE_US 5        // digitalRead + compare
+#define SCHED_BENCH_DRIVE_US 10      // Motion profile step
+#define SCHED_BENCH_CONTROL_US 300   // Tracker prediction + steering + LED ring
+#define SCHED_BENCH_JITTER_US 1000   // Host scheduling noise allowed by the check
+
+struct SchedBenchOptions {
+    int ms = 2000;
+    int frame_us = 33333;  // 30 fps sensor
+    uint32_t seed = 1;
+};
+
+static bool parse_args(int argc, char** argv, SchedBenchOptions* opt) {
+    BenchArgs args("sched_bench [--ms T] [--frame-us F] [--seed S]");
+    args.option("--ms", &opt->ms);
+    args.option("--frame-us", &opt->frame_us);
+    args.option("--seed", &opt->seed);
+    return args.parse(argc, argv, [opt] { return opt->ms > 0 && opt->frame_us > 0; });
+}
+
+static void spin_us(uint32_t us) {
+    uint32_t t0 = micros();
+    while (micros() - t0 < us) {
+    }
+}
+
+// An input that changes at preset times (us from the start of a run); a
+// handler polling it sees each change once
+struct InputEvents {
+    std::vector<uint32_t> at;
+    size_t next = 0;
+    BenchSamples latency;
+
+    explicit InputEvents(const char* name) : latency(name) {}
+
+    // Events seen by this poll
+    int poll(uint32_t now) {
+        int seen = 0;
+        for (; next < at.size() && at[next] <= now; next++, seen++) {
+            latency.add((uint64_t)(now - at[next]) * 1000);
+        }
+        return seen;
+    }
+};
+
+static std::vector<uint32_t> make_events(std::mt19937* rng, uint32_t span_us, uint32_t min_gap, uint32_t max_gap) {
+    std::uniform_int_distribution<uint32_t> gap(min_gap, max_gap);
+    std::vector<uint32_t> at;
+    for (uint32_t t = gap(*rng); t < span_us; t += gap(*rng)) at.push_back(t);
+    return at;
+}
+
+// One run's state, reached from the task functions
+static InputEvents* bench_ir = NULL;
+static InputEvents* bench_line = NULL;
+static uint32_t bench_start = 0;
+static uint32_t bench_vision_us = 0;
+static bool bench_on_line = false;
+
+static void vision_task() { spin_us(bench_vision_us); }
+
+static void ir_task() {
+    for (int n = bench_ir->poll(micros() - bench_start); n > 0; n--) {
+        lineSearch(bench_on_line);  // Delivery Start
+        bench_on_line = !bench_on_line;
+    }
+    spin_us(SCHED_BENCH_IR_US);
+}
+
+static void drive_task() { spin_us(SCHED_BENCH_DRIVE_US); }
+static void control_task() { spin_us(SCHED_BENCH_CONTROL_US); }
+
+static void line_task() {
+    bench_line->poll(micros() - bench_start);
+    spin_us(SCHED_BENCH_LINE_US);
+}
+
+struct LoopRun {
+    InputEvents ir{"ir"};
+    InputEvents line{"line"};
+    uint32_t vision_runs = 0;
+    SchedTask tasks[5];
+};
+
+static void run_loop(const SchedBenchOptions& opt, bool scheduled, uint32_t vision_us, LoopRun* run) {
+    std::mt19937 rng(opt.seed);
+    uint32_t span = (uint32_t)opt.ms * 1000;
+    run->ir.at = make_events(&rng, span, 50000, 150000);     // A button press every 50-150 ms
+    run->line.at = make_events(&rng, span, 20000, 80000);
+    bench_ir = &run->ir;
+    bench_line = &run->line;
+    bench_vision_us = vision_us;
+
+    sched_count = 0;
+    if (scheduled) {
+        sched_add("ir", ir_task, IR_PERIOD_US, IR_BUDGET_US);
+        sched_add("line", line_task, LINE_PERIOD_US, LINE_BUDGET_US);
+        sched_add("drive", drive_task, DRIVE_PERIOD_US, DRIVE_BUDGET_US);
+        sched_add("control", control_task, CONTROL_PERIOD_US, CONTROL_BUDGET_US);
+        sched_add("vision", vision_task, VISION_PERIOD_US, VISION_BUDGET_US);
+    }
+
+    bench_start = micros();
+    while (micros() - bench_start < span) {
+        if (scheduled) {
+            sched_run();
+        } else {
+            vision_task();
+            run->vision_runs++;
+            line_task();
+            ir_task();
+        }
+    }
+    if (scheduled) {
+        for (int i = 0; i < 5; i++) run->tasks[i] = *sched_get_task(i);
+        run->vision_runs = run->tasks[4].runs;
+    }
+}
+
+int main(int argc, char** argv) {
+    SchedBenchOptions opt;
+    if (!parse_args(argc, argv, &opt)) return 2;
+
+    printf("sched_bench: %d ms per loop, blocking frame %d us, async pick-up %d us\n\n",
+           opt.ms, opt.frame_us, SCHED_BENCH_ASYNC_US);
+
+    LoopRun serial, sched_sync, sched_async;
+    run_loop(opt, false, opt.frame_us, &serial);
+    run_loop(opt, true, opt.frame_us, &sched_sync);
+    run_loop(opt, true, SCHED_BENCH_ASYNC_US, &sched_async);
+
+    struct Row { const char* name; const LoopRun* run; };
+    const Row rows[] = {{"serial loop", &serial}, {"sched, sync vision", &sched_sync},
+                        {"sched, async vision", &sched_async}};
+
+    printf("%-28s %10s %10s %10s %10s %10s\n", "latency (us)", "events", "mean", "p50", "p99", "max");
+    for (const Row& r : rows) {
+        for (const InputEvents* in : {&r.run->ir, &r.run->line}) {
+            std::string name = std::string(r.name) + ": " + in->latency.name();
+            printf("%-28s %10zu %10.0f %10.0f %10.0f %10.0f\n", name.c_str(), in->latency.count(),
+                   in->latency.mean_us(), in->latency.percentile_us(50), in->latency.percentile_us(99),
+                   in->latency.percentile_us(100));
+        }
+    }
+
+    printf("\n%-28s %10s %10s %10s %10s %10s\n", "scheduler tasks", "runs", "mean us", "max us", "overruns", "late");
+    for (const Row& r : rows) {
+        if (r.run == &serial) continue;
+        for (const SchedTask& t : r.run->tasks) {
+            std::string name = std::string(r.name) + ": " + t.name;
+            printf("%-28s %10u %10.1f %10u %10u %10u\n", name.c_str(), t.runs,
+                   t.runs ? (double)t.total_us / t.runs : 0.0, t.max_run_us, t.overruns, t.late);
+        }
+    }
+    printf("vision runs/s: serial %.1f, sched sync %.1f, sched async %.1f\n\n",
+           serial.vision_runs * 1000.0 / opt.ms, sched_sync.vision_runs * 1000.0 / opt.ms,
+           sched_async.vision_runs * 1000.0 / opt.ms);
+
+    // Worst case for an input: its own period, then every other task
+    // running to its budget before it gets the CPU
+    const uint32_t budgets = IR_BUDGET_US + LINE_BUDGET_US + DRIVE_BUDGET_US + CONTROL_BUDGET_US + VISION_BUDGET_US;
+    const InputEvents* inputs[] = {&sched_async.ir, &sched_async.line};
+    const uint32_t periods[] = {IR_PERIOD_US, LINE_PERIOD_US};
+    bool ok = true;
+    for (int i = 0; i < 2; i++) {
+        uint32_t bound = periods[i] + budgets;
+        double worst = inputs[i]->latency.percentile_us(100);
+        bool within = inputs[i]->latency.count() > 0 && worst <= bound + SCHED_BENCH_JITTER_US;
+        printf("verify: %s latency %.0f us within period + budgets (%u us): %s\n", inputs[i]->latency.name().c_str(),
+               worst, bound, within ? "ok" : "FAIL");
+        ok &= within;
+    }
+    bool clean = true;
+    for (const SchedTask& t : sched_async.tasks) clean &= t.overruns == 0;
+    printf("verify: no task over budget with async vision (IR: %u overruns on %zu Delivery Starts): %s\n",
+           sched_async.tasks[0].overruns, sched_async.ir.latency.count(), clean ? "ok" : "FAIL");
+    return ok && clean ? 0 : 1;
+}
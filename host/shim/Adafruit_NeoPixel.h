@@ -0,0 +1,33 @@
+/* ADAFRUIT_NEOPIXEL.H (HOST SHIM) - LED ring that keeps its colors and
+ * counts show() calls */
+
+#ifndef HOST_ADAFRUIT_NEOPIXEL_H
+#define HOST_ADAFRUIT_NEOPIXEL_H
+
+#include <cstdint>
+#include <vector>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+public:
+    Adafruit_NeoPixel(uint16_t n, int16_t, uint16_t = NEO_GRB + NEO_KHZ800) : colors_(n, 0) {}
+
+    void begin() {}
+    void clear() { colors_.assign(colors_.size(), 0); }
+    void show() { shows_++; }
+    void setPixelColor(uint16_t i, uint32_t c) {
+        if (i < colors_.size()) colors_[i] = c;
+    }
+    uint32_t getPixelColor(uint16_t i) const { return i < colors_.size() ? colors_[i] : 0; }
+    uint32_t shows() const { return shows_; }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+
+private:
+    std::vector<uint32_t> colors_;
+    uint32_t shows_ = 0;
+};
+
+#endif // HOST_ADAFRUIT_NEOPIXEL_H
@@ -0,0 +1,139 @@
+/* ARDUINO.H (HOST SHIM) - Just enough of the Arduino core to build the
+ * robot headers on Linux.
+ *
+ * Clock: millis()/micros() come from std::chrono::steady_clock, measured
+ * from the first call. Serial prints to stderr so benchmark tables on
+ * stdout stay clean.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using std::min;
+using std::max;
+using std::abs;
+
+#define HIGH 1
+#define LOW  0
+#define INPUT  0
+#define OUTPUT 1
+#define LED_BUILTIN 21
+#define IRAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// CLOCK
+inline std::chrono::steady_clock::time_point host_clock_origin() {
+    static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    return origin;
+}
+
+inline uint32_t micros() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - host_clock_origin()).count();
+}
+
+inline uint32_t millis() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - host_clock_origin()).count();
+}
+
+inline void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// GPIO (no-ops)
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return 0; }
+
+// SERIAL
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    int available() { return 0; }
+    int read() { return -1; }
+    int availableForWrite() { return 4096; }
+    void flush() { fflush(stderr); }
+
+    size_t write(uint8_t c) { return fwrite(&c, 1, 1, stderr); }
+    size_t write(const uint8_t* buf, size_t len) { return fwrite(buf, 1, len, stderr); }
+
+    void print(const char* s) { fputs(s, stderr); }
+    void print(int v) { fprintf(stderr, "%d", v); }
+    void print(unsigned int v) { fprintf(stderr, "%u", v); }
+    void print(long v) { fprintf(stderr, "%ld", v); }
+    void print(unsigned long v) { fprintf(stderr, "%lu", v); }
+    void print(double v, int digits = 2) { fprintf(stderr, "%.*f", digits, v); }
+
+    void println() { fputc('\n', stderr); }
+    template <typename T> void println(T v) { print(v); println(); }
+    void println(double v, int digits) { print(v, digits); println(); }
+
+    int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vfprintf(stderr, fmt, args);
+        va_end(args);
+        return n;
+    }
+};
+
+inline HostSerial Serial;
+
+// ESP (heap/PSRAM reporting, cycle counter)
+// getCycleCount() reads the TSC on x86 (steady_clock nanoseconds elsewhere);
+// getCpuFreqMHz() is its rate, measured once at startup against steady_clock.
+inline uint32_t host_cycle_count() {
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__builtin_ia32_rdtsc();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline uint32_t host_cycle_mhz() {
+#if defined(__x86_64__) || defined(__i386__)
+    auto t0 = std::chrono::steady_clock::now();
+    uint32_t c0 = host_cycle_count();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    uint32_t c1 = host_cycle_count();
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    return (uint32_t)((c1 - c0) / us + 0.5);
+#else
+    return 1000;
+#endif
+}
+
+inline const uint32_t host_cpu_mhz = host_cycle_mhz();
+
+class HostEsp {
+public:
+    uint32_t getCycleCount() { return host_cycle_count(); }
+    uint32_t getCpuFreqMHz() { return host_cpu_mhz; }
+    uint32_t getHeapSize() { return 512 * 1024; }
+    uint32_t getFreeHeap() { return 512 * 1024; }
+    uint32_t getPsramSize() { return 8 * 1024 * 1024; }
+    uint32_t getFreePsram() { return 8 * 1024 * 1024; }
+};
+
+inline HostEsp ESP;
+
+inline bool psramFound() { return true; }
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,32 @@
+/* ESP32SERVO.H (HOST SHIM) - Servo that remembers its pulse and counts writes */
+
+#ifndef HOST_ESP32SERVO_H
+#define HOST_ESP32SERVO_H
+
+#include <cstdint>
+
+class Servo {
+public:
+    int attach(int pin) {
+        pin_ = pin;
+        return 1;
+    }
+    void detach() { pin_ = -1; }
+    bool attached() const { return pin_ >= 0; }
+
+    // Ignored while detached, as on the ESP32
+    void writeMicroseconds(int us) {
+        if (!attached()) return;
+        us_ = us;
+        writes_++;
+    }
+    int readMicroseconds() const { return us_; }
+    uint32_t writes() const { return writes_; }
+
+private:
+    int pin_ = -1;
+    int us_ = 1500;
+    uint32_t writes_ = 0;
+};
+
+#endif // HOST_ESP32SERVO_H
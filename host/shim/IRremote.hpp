@@ -0,0 +1,29 @@
+/* IRREMOTE.HPP (HOST SHIM) - The IRremote types the robot headers use; the
+ * receiver never has a code (benches feed codes in themselves) */
+
+#ifndef HOST_IRREMOTE_HPP
+#define HOST_IRREMOTE_HPP
+
+#include <cstdint>
+
+typedef uint32_t IRRawDataType;
+
+#define ENABLE_LED_FEEDBACK true
+
+struct IRData {
+    IRRawDataType decodedRawData = 0;
+};
+
+class HostIrReceiver {
+public:
+    void begin(uint8_t, bool) {}
+    bool decode() { return false; }
+    void resume() {}
+    void registerReceiveCompleteCallback(void (*)()) {}
+
+    IRData decodedIRData;
+};
+
+inline HostIrReceiver IrReceiver;
+
+#endif // HOST_IRREMOTE_HPP
@@ -0,0 +1,96 @@
+/* ESP_CAMERA.H (HOST SHIM) - Mock of the esp32-camera driver API.
+ *
+ * esp_camera_fb_get() hands out frames pulled from whatever
+ * MockFrameSource was installed with mock_camera_set_source() (see
+ * mock_camera.h). Buffers come from a pool of config.fb_count entries, just
+ * like the real driver, so forgetting esp_camera_fb_return() runs the pool
+ * dry the same way it would on the robot.
+ */
+
+#ifndef HOST_ESP_CAMERA_H
+#define HOST_ESP_CAMERA_H
+
+#include <cstddef>
+#include <cstdint>
+
+typedef int esp_err_t;
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+typedef enum { LEDC_CHANNEL_0 = 0 } ledc_channel_t;
+typedef enum { LEDC_TIMER_0 = 0 } ledc_timer_t;
+
+typedef enum {
+    PIXFORMAT_RGB565,
+    PIXFORMAT_YUV422,
+    PIXFORMAT_GRAYSCALE,
+    PIXFORMAT_JPEG,
+} pixformat_t;
+
+typedef enum {
+    FRAMESIZE_QQVGA,  // 160x120
+    FRAMESIZE_QVGA,   // 320x240
+    FRAMESIZE_VGA,    // 640x480
+} framesize_t;
+
+typedef enum {
+    CAMERA_GRAB_WHEN_EMPTY,
+    CAMERA_GRAB_LATEST,
+} camera_grab_mode_t;
+
+typedef enum {
+    CAMERA_FB_IN_PSRAM,
+    CAMERA_FB_IN_DRAM,
+} camera_fb_location_t;
+
+struct timeval_host {
+    long tv_sec;
+    long tv_usec;
+};
+
+typedef struct {
+    uint8_t* buf;
+    size_t len;
+    size_t width;
+    size_t height;
+    pixformat_t format;
+    struct timeval_host timestamp;
+} camera_fb_t;
+
+typedef struct {
+    int pin_pwdn, pin_reset, pin_xclk;
+    int pin_sscb_sda, pin_sscb_scl;
+    int pin_d7, pin_d6, pin_d5, pin_d4, pin_d3, pin_d2, pin_d1, pin_d0;
+    int pin_vsync, pin_href, pin_pclk;
+    int xclk_freq_hz;
+    ledc_timer_t ledc_timer;
+    ledc_channel_t ledc_channel;
+    pixformat_t pixel_format;
+    framesize_t frame_size;
+    int jpeg_quality;
+    size_t fb_count;
+    camera_fb_location_t fb_location;
+    camera_grab_mode_t grab_mode;
+} camera_config_t;
+
+typedef struct sensor sensor_t;
+struct sensor {
+    int (*set_brightness)(sensor_t*, int);
+    int (*set_contrast)(sensor_t*, int);
+    int (*set_saturation)(sensor_t*, int);
+    int (*set_exposure_ctrl)(sensor_t*, int);
+    int (*set_aec_value)(sensor_t*, int);
+    int (*set_aec2)(sensor_t*, int);
+    int (*set_gain_ctrl)(sensor_t*, int);
+    int (*set_agc_gain)(sensor_t*, int);
+    int (*set_whitebal)(sensor_t*, int);
+    int (*set_awb_gain)(sensor_t*, int);
+};
+
+esp_err_t esp_camera_init(const camera_config_t* config);
+esp_err_t esp_camera_deinit();
+camera_fb_t* esp_camera_fb_get();
+void esp_camera_fb_return(camera_fb_t* fb);
+sensor_t* esp_camera_sensor_get();
+
+#endif // HOST_ESP_CAMERA_H
@@ -0,0 +1,30 @@
+/* FREERTOS.H (HOST SHIM) - Base FreeRTOS types for the host build.
+ *
+ * Ticks are milliseconds (configTICK_RATE_HZ = 1000, as on the ESP32
+ * Arduino core). Tasks are std::threads, semaphores are a mutex plus a
+ * condition variable; see task.h and semphr.h.
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  0
+#define pdPASS  1
+
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define configMAX_PRIORITIES 25  // ESP-IDF's value; priorities are ignored here
+#define portYIELD_FROM_ISR(...) do {} while (0)
+
+#endif // HOST_FREERTOS_H
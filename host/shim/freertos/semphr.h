@@ -0,0 +1,68 @@
+/* SEMPHR.H (HOST SHIM) - FreeRTOS mutexes and binary semaphores.
+ *
+ * Both are a count guarded by a std::mutex: a mutex starts at 1, a binary
+ * semaphore at 0, and neither counts above 1.
+ */
+
+#ifndef HOST_FREERTOS_SEMPHR_H
+#define HOST_FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+struct HostSemaphore {
+    std::mutex lock;
+    std::condition_variable cv;
+    int count;
+};
+
+typedef HostSemaphore* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    SemaphoreHandle_t s = new HostSemaphore;
+    s->count = 1;
+    return s;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() {
+    SemaphoreHandle_t s = new HostSemaphore;
+    s->count = 0;
+    return s;
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t s) {
+    delete s;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+    std::unique_lock<std::mutex> guard(s->lock);
+    if (ticks == portMAX_DELAY) {
+        s->cv.wait(guard, [s] { return s->count > 0; });
+    } else if (!s->cv.wait_for(guard, std::chrono::milliseconds(ticks), [s] { return s->count > 0; })) {
+        return pdFALSE;
+    }
+    s->count--;
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    {
+        std::lock_guard<std::mutex> guard(s->lock);
+        if (s->count >= 1) return pdFALSE;
+        s->count++;
+    }
+    s->cv.notify_one();
+    return pdTRUE;
+}
+
+// "Interrupts" are host threads, so this is an ordinary give
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t* woken) {
+    BaseType_t given = xSemaphoreGive(s);
+    if (woken) *woken = given;
+    return given;
+}
+
+#endif // HOST_FREERTOS_SEMPHR_H
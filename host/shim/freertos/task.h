@@ -0,0 +1,41 @@
+/* TASK.H (HOST SHIM) - FreeRTOS tasks as detached std::threads.
+ *
+ * Core affinity and priority are accepted and ignored; the host scheduler
+ * puts threads on whatever cores are free, which is what the pinned ESP32
+ * task gets anyway. vTaskDelete(NULL) returns here instead of never
+ * returning, so task functions must end right after calling it.
+ */
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+#include <chrono>
+#include <thread>
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_bytes,
+                                          void* arg, UBaseType_t priority, TaskHandle_t* handle,
+                                          BaseType_t core) {
+    (void)name; (void)stack_bytes; (void)priority; (void)core;
+    static uintptr_t next_handle = 1;  // Opaque, only compared against NULL
+    std::thread(fn, arg).detach();
+    if (handle) *handle = (TaskHandle_t)next_handle++;
+    return pdPASS;
+}
+
+inline void vTaskDelete(TaskHandle_t) {}
+
+inline void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+inline TickType_t xTaskGetTickCount() {
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // HOST_FREERTOS_TASK_H
@@ -0,0 +1,158 @@
+/* TRACK_BENCH - Pablo_main/tracker.h against the raw offset on a simulated turn
+ *
+ * Usage:
+ *   track_bench [--latency-ms L] [--seed S]
+ *
+ * The robot turns back and forth (20 units, 3 s period) while the pillar
+ * drifts slowly, and the real image drift per unit of turn is 15% off
+ * the QQVGA value TRACK_PX_PER_TURN was tuned to. Offsets, drift and
+ * noise are in EYES_FRAMESIZE pixels; track_bench_qvga is the same bench
+ * at QVGA, where they are twice as large. Frames are captured at F fps, and each result
+ * reaches loop() L ms after its capture; a share of frames miss the
+ * pillar. Every 20 ms (CONTROL_PERIOD_US, Pablo_main/schedule.h) the control
+ * tick reads two estimates of where the pillar is now:
+ *   raw      the last frame's offset, as captureMode() used it; a frame
+ *            that missed means no target (the scan branch)
+ *   tracker  track_predict(), valid until TRACK_TIMEOUT_US without one
+ *
+ * Reported per frame rate and miss rate: RMS error against the true
+ * offset while each has a target, and the share of ticks with none. The
+ * check is the tracker closer than raw and losing the target less often.
+ */
+
+#include <Arduino.h>  // Sketch headers get it from the .ino build
+#include "bench_args.h"
+#include "schedule.h"
+#include "tracker.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#define TRACK_BENCH_SECONDS 20
+#define TRACK_BENCH_START_US 1000000  // Simulated clock at t = 0
+#define TRACK_BENCH_CONTROL_US CONTROL_PERIOD_US
+#define TRACK_BENCH_TURN 20.0         // Turn speed amplitude
+#define TRACK_BENCH_TURN_PERIOD_S 3.0
+#define TRACK_BENCH_PX_PER_TURN 4.0   // What TRACK_PX_PER_TURN was tuned to, QQVGA px
+#define TRACK_BENCH_PX_ERROR 1.15     // True drift / TRACK_BENCH_PX_PER_TURN
+
+struct TrackBenchOptions {
+    int latency_ms = 60;
+    uint32_t seed = 1;
+};
+
+struct TrackRun {
+    int fps;
+    double miss;
+    double raw_sq = 0, track_sq = 0;
+    uint32_t raw_n = 0, track_n = 0;
+    uint32_t ticks = 0;
+
+    double raw_rms() const { return raw_n ? sqrt(raw_sq / raw_n) : 0; }
+    double track_rms() const { return track_n ? sqrt(track_sq / track_n) : 0; }
+    double raw_lost() const { return 1.0 - (double)raw_n / ticks; }
+    double track_lost() const { return 1.0 - (double)track_n / ticks; }
+};
+
+struct PendingFrame {
+    uint32_t capture_us, ready_us;
+    bool found;
+    int16_t offset;
+};
+
+static double turn_at(double t_s) {
+    return TRACK_BENCH_TURN * sin(2 * M_PI * t_s / TRACK_BENCH_TURN_PERIOD_S);
+}
+
+static void run(const TrackBenchOptions& opt, TrackRun* r) {
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<double> coin(0, 1);
+    std::normal_distribution<double> noise(0, 2.0 * EYES_PX_SCALE);  // Centroid noise, px
+
+    track_reset();
+    track_ego_count = 0;
+    const uint32_t frame_us = 1000000 / r->fps;
+    const uint32_t latency_us = opt.latency_ms * 1000;
+    double ego = 0;
+    std::vector<PendingFrame> pending;
+    bool raw_found = false;
+    double raw_offset = 0;
+    uint32_t next_frame = 0, next_control = 0;
+
+    for (uint32_t t = 0; t < TRACK_BENCH_SECONDS * 1000000u; t += 1000) {
+        double t_s = t * 1e-6;
+        double turn = turn_at(t_s);
+        ego += TRACK_BENCH_PX_ERROR * TRACK_BENCH_PX_PER_TURN * EYES_PX_SCALE * turn * 1e-3;
+        double world = (30 + 15 * sin(2 * M_PI * t_s / 7.0)) * EYES_PX_SCALE;
+        double truth = world - ego;
+        uint32_t now = TRACK_BENCH_START_US + t;
+
+        if (t >= next_frame) {
+            bool found = coin(rng) >= r->miss;
+            pending.push_back({now, now + latency_us, found, (int16_t)lround(truth + noise(rng))});
+            next_frame += frame_us;
+        }
+        while (!pending.empty() && pending.front().ready_us <= now) {
+            const PendingFrame& f = pending.front();
+            raw_found = f.found;
+            raw_offset = f.offset;
+            if (f.found) track_measure(f.offset, f.capture_us);
+            pending.erase(pending.begin());
+        }
+        if (t >= next_control) {
+            track_turn(now, turn);
+            r->ticks++;
+            if (raw_found) {
+                r->raw_sq += (raw_offset - truth) * (raw_offset - truth);
+                r->raw_n++;
+            }
+            if (track_valid(now)) {
+                double e = track_predict(now) - truth;
+                r->track_sq += e * e;
+                r->track_n++;
+            }
+            next_control += TRACK_BENCH_CONTROL_US;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    TrackBenchOptions opt;
+    BenchArgs args("track_bench [--latency-ms L] [--seed S]");
+    args.option("--latency-ms", &opt.latency_ms);
+    args.option("--seed", &opt.seed);
+    if (!args.parse(argc, argv)) return 2;
+    if (opt.latency_ms < 0) {
+        fprintf(stderr, "track_bench: --latency-ms must not be negative\n");
+        return 2;
+    }
+
+    printf("track_bench: %dx%d, %d s, frame latency %d ms, control every %d ms, turn +-%.0f, drift model off by %.0f%%\n\n",
+           EYES_IMG_WIDTH, EYES_IMG_HEIGHT, TRACK_BENCH_SECONDS, opt.latency_ms, TRACK_BENCH_CONTROL_US / 1000, TRACK_BENCH_TURN,
+           (TRACK_BENCH_PX_ERROR - 1) * 100);
+
+    std::vector<TrackRun> runs;
+    for (int fps : {30, 15, 8}) {
+        for (double miss : {0.0, 0.3}) {
+            TrackRun r;
+            r.fps = fps;
+            r.miss = miss;
+            run(opt, &r);
+            runs.push_back(r);
+        }
+    }
+
+    printf("%-6s %6s %10s %10s %10s %10s\n", "fps", "miss", "raw px", "track px", "raw lost", "track lost");
+    bool closer = true, kept = true;
+    for (const TrackRun& r : runs) {
+        printf("%-6d %5.0f%% %10.1f %10.1f %9.1f%% %9.1f%%\n", r.fps, r.miss * 100, r.raw_rms(), r.track_rms(),
+               r.raw_lost() * 100, r.track_lost() * 100);
+        closer &= r.track_rms() < r.raw_rms();
+        kept &= r.track_lost() <= r.raw_lost();
+    }
+    printf("\n");
+    printf("verify: tracker closer to the true offset than the raw frame: %s\n", closer ? "ok" : "FAIL");
+    printf("verify: tracker loses the target no more often than raw: %s\n", kept ? "ok" : "FAIL");
+    return closer && kept ? 0 : 1;
+}
@@ -1,10 +1,25 @@
-/* 
+/*
  * This file just sends the results to the laptop for visualization.
  *
- * Commands:
- * - SNAP: Capture and send one processed frame
- * - AUTO: Start continuous mode (2 FPS for easy viewing)
- * - STOP: Stop continuous mode
+ * Everything goes over serial_link.h frames (sync, type, seq, len, crc),
+ * queued without blocking and drained in the background.
+ *
+ * Commands (host -> ESP32, message type):
+ * - CMD_SNAP: Capture one frame, send its blob record and the full frame
+ * - CMD_AUTO: Stream blob records at the camera's rate, plus a full frame
+ *             every full_frame_interval_ms (optional u32 payload, default
+ *             FULL_FRAME_INTERVAL_MS, 0 = never)
+ * - CMD_STOP: Stop continuous mode
+ * - CMD_FORMAT: Full frame format (u8 payload, FRAME_RAW / FRAME_RGB565 /
+ *               FRAME_MASKS), FRAME_RGB565 by default
+ *
+ * Messages (ESP32 -> host, little-endian, packed):
+ * - LINK_MSG_TEXT: status and detection summaries
+ * - MSG_BLOBS: BlobRecordHeader + blob_count x BlobRecord (see send_blob_record)
+ * - LINK_MSG_BULK_BEGIN / BULK_DATA: a full frame, header FrameHeader,
+ *   then the frame in its format (see send_full_frame and frame_codec.h)
+ * Both headers carry the frame size (EYES_FRAMESIZE in eyes.h), so
+ * viewer.py follows whatever size this is built for.
  *
  * Detection Results (from eyes.h):
  * - Yellow: 0 (not found) or 1 (found) + offset from center
@@ -14,90 +29,141 @@
 
  /*
  * How to use this file:
- * 1. Upload this file to the ESP32 include eyes.h
- * 2. Open Viewer.py to see output 
+ * 1. Upload this file to the ESP32 include eyes.h, serial_link.h and frame_codec.h
+ * 2. Open Viewer.py to see output
  */
 #include <Arduino.h>
 #include "eyes.h"
-
-// SEND FRAME TO LAPTOP
-void send_visualization_frame() {
-    // Send header
-    const char hdr[3] = {'V', 'I', 'Z'};
-    Serial.write((const uint8_t*)hdr, 3);
-
-    struct __attribute__((packed)) {
-        uint16_t width, height;
-
-        // Yellow blob (1 max)
-        uint8_t yellow_on_screen;
-        int16_t yellow_pixels_from_center;
-        int16_t yellow_centroid_x, yellow_centroid_y;
-        uint16_t yellow_area;
-
-        // Pink blobs (2 max)
-        uint8_t num_pink_detected;
-        uint8_t pink0_on_screen;
-        int16_t pink0_pixels_from_center;
-        int16_t pink0_centroid_x, pink0_centroid_y;
-        uint16_t pink0_area;
-
-        uint8_t pink1_on_screen;
-        int16_t pink1_pixels_from_center;
-        int16_t pink1_centroid_x, pink1_centroid_y;
-        uint16_t pink1_area;
-
-        uint32_t frame_num;
-        uint32_t process_ms;
-        uint8_t padding[20];
-    } metadata = {0};
-
-    metadata.width = EYES_IMG_WIDTH;
-    metadata.height = EYES_IMG_HEIGHT;
-
-    // Yellow blob
-    metadata.yellow_on_screen = eyes_get_yellow_found();
-    metadata.yellow_pixels_from_center = eyes_get_yellow_offset_x();
-    metadata.yellow_centroid_x = eyes_get_yellow_offset_x() + (EYES_IMG_WIDTH / 2);
-    metadata.yellow_centroid_y = 0;
-    metadata.yellow_area = eyes_get_yellow_area();
-
-    // Pink blobs
-    metadata.num_pink_detected = eyes_get_pink_count();
-
-    if (eyes_get_pink_count() >= 1) {
-        metadata.pink0_on_screen = 1;
-        metadata.pink0_pixels_from_center = eyes_get_pink_offset_x(0);
-        metadata.pink0_centroid_x = eyes_get_pink_offset_x(0) + (EYES_IMG_WIDTH / 2);
-        metadata.pink0_centroid_y = 0;
-        metadata.pink0_area = eyes_get_pink_area(0);
-    }
-
-    if (eyes_get_pink_count() >= 2) {
-        metadata.pink1_on_screen = 1;
-        metadata.pink1_pixels_from_center = eyes_get_pink_offset_x(1);
-        metadata.pink1_centroid_x = eyes_get_pink_offset_x(1) + (EYES_IMG_WIDTH / 2);
-        metadata.pink1_centroid_y = 0;
-        metadata.pink1_area = eyes_get_pink_area(1);
+#include "serial_link.h"
+#include "frame_codec.h"
+
+#if EYES_YUV422
+#error "Frames go to viewer.py as RGB565: build with EYES_YUV422 0"
+#endif
+
+// MESSAGE TYPES (application range of serial_link.h)
+#define MSG_BLOBS 0x10
+#define CMD_SNAP  0x20
+#define CMD_AUTO  0x21
+#define CMD_STOP  0x22
+#define CMD_FORMAT 0x23
+
+// BLOB RECORD - one per processed frame, no pixels (~20 bytes + 17 per blob)
+struct __attribute__((packed)) BlobRecordHeader {
+    uint32_t frame_num;
+    uint32_t timestamp_us;                // Sensor timestamp of the frame
+    uint16_t width, height;
+    uint16_t stage_us[EYES_NUM_STAGES];   // Capture, coarse, detect, report
+    uint8_t blob_count;
+};
+
+struct __attribute__((packed)) BlobRecord {
+    uint8_t target;                       // Index into EYES_TARGETS
+    int16_t centroid_x, centroid_y;
+    int16_t x_min, y_min, x_max, y_max;
+    uint32_t area;
+};
+
+// Queues the blob record of the current frame. False if the link dropped it.
+bool send_blob_record() {
+    BlobRecordHeader header;
+    header.frame_num = eyes_get_frame_number();
+    header.timestamp_us = eyes_get_frame_timestamp_us();
+    header.width = EYES_IMG_WIDTH;
+    header.height = EYES_IMG_HEIGHT;
+    for (int i = 0; i < EYES_NUM_STAGES; i++) header.stage_us[i] = eyes_get_stage_us(i);
+    header.blob_count = 0;
+
+    BlobRecord blobs[EYES_NUM_CLASSES * EYES_MAX_DETECTIONS];
+    for (int c = 0; c < EYES_NUM_CLASSES; c++) {
+        for (int i = 0; i < eyes_get_count(c); i++) {
+            const EyesDetection* d = eyes_get_detection(c, i);
+            BlobRecord& b = blobs[header.blob_count++];
+            b.target = c;
+            b.centroid_x = d->offset_x + (EYES_IMG_WIDTH / 2);
+            b.centroid_y = d->centroid_y;
+            b.x_min = d->x_min;
+            b.y_min = d->y_min;
+            b.x_max = d->x_max;
+            b.y_max = d->y_max;
+            b.area = d->area;
+        }
     }
 
-    metadata.frame_num = eyes_get_frame_number();
-    metadata.process_ms = eyes_get_process_time_ms();
-
-    Serial.write((uint8_t*)&metadata, sizeof(metadata));
+    return link_send2(MSG_BLOBS, &header, sizeof(header), blobs, header.blob_count * sizeof(BlobRecord));
+}
 
-    // Send RAW frame (if available)
+// FULL FRAME - encoded out of the camera buffer so the frame can be
+// released while the link streams it over the next loops
+#define FRAME_RAW    0   // RGB565, camera byte order
+#define FRAME_RGB565 1   // frame_codec.h RGB565 stream, delta against ref_frame
+#define FRAME_MASKS  2   // frame_codec.h bit planes of the closed class masks, [y][class][word]
+#define FRAME_NO_REF 0xFFFFFFFF
+#define FRAME_KEY_INTERVAL 8  // Every Nth RGB565 frame sent without a reference
+#define FRAME_BYTES (EYES_IMG_WIDTH * EYES_IMG_HEIGHT * 2)
+
+struct __attribute__((packed)) FrameHeader {
+    uint32_t frame_num;                   // Matches the blob record of the same frame
+    uint16_t width, height;
+    uint8_t format;                       // FRAME_*
+    uint32_t ref_frame;                   // Frame a delta was taken against, or FRAME_NO_REF
+};
+
+static uint8_t frame_format = FRAME_RGB565;
+static uint8_t* frame_out = NULL;         // Encoded frame being sent (PSRAM)
+static uint8_t* frame_ref = NULL;         // Last RGB565 frame sent, for deltas (PSRAM)
+static uint32_t frame_ref_num = FRAME_NO_REF;
+static int frames_since_key = 0;
+static EyesMaskWord* mask_planes = NULL;
+static EyesMaskWord* mask_temp = NULL;
+
+// Starts sending the current frame. False if one is still on its way.
+bool send_full_frame() {
     camera_fb_t* fb = eyes_get_framebuffer();
-    if (fb != NULL) {
-        Serial.write(fb->buf, EYES_IMG_WIDTH * EYES_IMG_HEIGHT * 2);
+    if (fb == NULL || frame_out == NULL || link_bulk_busy()) return false;
+
+    FrameHeader header = {eyes_get_frame_number(), EYES_IMG_WIDTH, EYES_IMG_HEIGHT, FRAME_RAW, FRAME_NO_REF};
+    size_t bytes = 0;
+
+    if (frame_format == FRAME_MASKS) {
+        // Masks compress so well that deltas do not pay off
+        eyes_classify_frame(fb->buf, mask_planes, EYES_IMG_WIDTH, EYES_IMG_HEIGHT);
+        eyes_packed_close(mask_planes, mask_temp, EYES_IMG_WIDTH, EYES_IMG_HEIGHT, EYES_CLOSE_KERNEL);
+        bytes = codec_encode_bits(mask_planes, NULL, EYES_MASK_TOTAL_WORDS, frame_out, FRAME_BYTES);
+        if (bytes == 0) return false;
+        header.format = FRAME_MASKS;
+    } else {
+        bool delta = frame_ref_num != FRAME_NO_REF && frames_since_key < FRAME_KEY_INTERVAL;
+        if (frame_format == FRAME_RGB565) {
+            bytes = codec_encode_rgb565(fb->buf, delta ? frame_ref : NULL, EYES_IMG_WIDTH * EYES_IMG_HEIGHT,
+                                        frame_out, FRAME_BYTES);
+        }
+        if (bytes > 0) {
+            header.format = FRAME_RGB565;
+            if (delta) header.ref_frame = frame_ref_num;
+        } else {
+            // Raw requested, or the encoding came out larger than raw
+            memcpy(frame_out, fb->buf, FRAME_BYTES);
+            bytes = FRAME_BYTES;
+            delta = false;
+        }
+        if (!link_bulk_start(header.frame_num, frame_out, bytes, &header, sizeof(header))) return false;
+
+        // Every RGB frame sent can be the next reference
+        memcpy(frame_ref, fb->buf, FRAME_BYTES);
+        frame_ref_num = header.frame_num;
+        frames_since_key = delta ? frames_since_key + 1 : 1;
+        return true;
     }
 
-    Serial.flush();
-    Serial.println();
+    return link_bulk_start(header.frame_num, frame_out, bytes, &header, sizeof(header));
 }
 
 // MAIN
+#define FULL_FRAME_INTERVAL_MS 10000  // Default full frame period in AUTO mode
+
 bool auto_mode = false;
+uint32_t full_frame_interval_ms = FULL_FRAME_INTERVAL_MS;
 
 void setup() {
     Serial.begin(115200);
@@ -127,79 +193,98 @@ void setup() {
         while(1) { delay(1000); }
     }
 
-    Serial.println("\nCommands:");
-    Serial.println("  SNAP - Capture one frame");
-    Serial.println("  AUTO - Start continuous mode (2 FPS)");
-    Serial.println("  STOP - Stop continuous mode");
-    Serial.println("\nReady. Waiting for commands...\n");
+    frame_out = (uint8_t*)ps_malloc(FRAME_BYTES);
+    frame_ref = (uint8_t*)ps_malloc(FRAME_BYTES);
+    mask_planes = (EyesMaskWord*)ps_malloc(EYES_MASK_TOTAL_WORDS * sizeof(EyesMaskWord));
+    mask_temp = (EyesMaskWord*)ps_malloc(EYES_MASK_TOTAL_WORDS * sizeof(EyesMaskWord));
+    if (!frame_out || !frame_ref || !mask_planes || !mask_temp) {
+        frame_out = NULL;
+        Serial.println("WARNING: No PSRAM for frame copies, full frames disabled");
+    }
+
+    // From here on all output goes through the link
+    if (!link_begin()) {
+        Serial.println("FATAL: Serial link task failed to start!");
+        while(1) { delay(1000); }
+    }
+
+    link_printf("Commands: SNAP, AUTO [full frame ms], STOP, FORMAT raw/rgb565/masks (framed, see viewer.py)");
+    link_printf("Ready. Waiting for commands...");
 }
 
-void loop() {
-    static String line;
-    while (Serial.available()) {
-        char c = (char)Serial.read();
-        if (c == '\n' || c == '\r') {
-            if (line.equalsIgnoreCase("SNAP")) {
-                Serial.println("SNAP command received");
-
-                eyes_snap();
-
-                if (eyes_get_framebuffer() != NULL) {
-                    send_visualization_frame();
-
-                    // Print detection summary
-                    Serial.printf("Frame %d | Process=%dms\n", eyes_get_frame_number(), eyes_get_process_time_ms());
-
-                    if (eyes_get_yellow_found()) {
-                        Serial.printf("  Yellow: FOUND | offset=%d px (area=%d)\n",
-                                     eyes_get_yellow_offset_x(), eyes_get_yellow_area());
-                    } else {
-                        Serial.println("  Yellow: NOT FOUND");
-                    }
-
-                    Serial.printf("  Pink: %d blob(s) detected\n", eyes_get_pink_count());
-                    for (int i = 0; i < eyes_get_pink_count(); i++) {
-                        Serial.printf("    Pink[%d]: offset=%d px (area=%d)\n",
-                                     i, eyes_get_pink_offset_x(i), eyes_get_pink_area(i));
-                    }
-
-                    // Release frame buffer
-                    eyes_release();
-                } else {
-                    Serial.println("ERROR: Failed to capture frame");
-                }
-            }
-            else if (line.equalsIgnoreCase("AUTO")) {
-                auto_mode = true;
-                Serial.println("AUTO mode started (2 FPS)");
+void handle_command(const LinkMessage& cmd) {
+    if (cmd.type == CMD_SNAP) {
+        eyes_snap();
+
+        if (eyes_get_framebuffer() != NULL) {
+            send_blob_record();
+            if (!send_full_frame()) link_printf("Full frame skipped: previous one still sending");
+
+            // Print detection summary
+            link_printf("Frame %u | Process=%ums", eyes_get_frame_number(), eyes_get_process_time_ms());
+
+            if (eyes_get_yellow_found()) {
+                link_printf("  Yellow: FOUND | offset=%d px (area=%u)",
+                            eyes_get_yellow_offset_x(), (unsigned)eyes_get_yellow_area());
+            } else {
+                link_printf("  Yellow: NOT FOUND");
             }
-            else if (line.equalsIgnoreCase("STOP")) {
-                auto_mode = false;
-                Serial.println("AUTO mode stopped");
+
+            link_printf("  Pink: %d blob(s) detected", eyes_get_pink_count());
+            for (int i = 0; i < eyes_get_pink_count(); i++) {
+                link_printf("    Pink[%d]: offset=%d px (area=%u)",
+                            i, eyes_get_pink_offset_x(i), (unsigned)eyes_get_pink_area(i));
             }
-            line = "";
-        } else if (line.length() < 64) {
-            line += c;
+
+            // Release frame buffer
+            eyes_release();
+        } else {
+            link_printf("ERROR: Failed to capture frame");
         }
     }
+    else if (cmd.type == CMD_AUTO) {
+        auto_mode = true;
+        full_frame_interval_ms = FULL_FRAME_INTERVAL_MS;
+        if (cmd.len >= 4) memcpy(&full_frame_interval_ms, cmd.payload, 4);
+        link_printf("AUTO mode started (blob stream, full frame every %u ms)", full_frame_interval_ms);
+    }
+    else if (cmd.type == CMD_STOP) {
+        auto_mode = false;
+        link_printf("AUTO mode stopped (sent %u, dropped %u)", link_stats.sent, link_stats.dropped);
+    }
+    else if (cmd.type == CMD_FORMAT && cmd.len >= 1 && cmd.payload[0] <= FRAME_MASKS) {
+        frame_format = cmd.payload[0];
+        frame_ref_num = FRAME_NO_REF;  // Next RGB565 frame is a key frame
+        link_printf("Full frame format %u", frame_format);
+    }
+}
 
-    if (auto_mode) {
-        static uint32_t last_frame = 0;
-        if (millis() - last_frame > 500) {
-            last_frame = millis();
+void loop() {
+    static LinkMessage cmd;
+    while (link_receive(&cmd)) {
+        handle_command(cmd);
+    }
 
-            digitalWrite(LED_BUILTIN, LOW);
+    if (auto_mode) {
+        static uint32_t last_full_frame = 0;
+        bool full_frame = full_frame_interval_ms > 0 &&
+                          (last_full_frame == 0 || millis() - last_full_frame >= full_frame_interval_ms);
 
-            eyes_snap();
+        digitalWrite(LED_BUILTIN, LOW);
 
-            if (eyes_get_framebuffer() != NULL) {
-                send_visualization_frame();
-                eyes_release();
-            }
+        eyes_snap();
 
-            digitalWrite(LED_BUILTIN, HIGH);
+        if (eyes_get_framebuffer() != NULL) {
+            send_blob_record();
+            if (full_frame && send_full_frame()) last_full_frame = millis();
+            eyes_release();
         }
+
+        digitalWrite(LED_BUILTIN, HIGH);
+    } else {
+        delay(10);
     }
 
-    delay(10);
+    // Queue the next chunks of a full frame, if one is on its way
+    link_bulk_pump();
 }
@@ -0,0 +1,298 @@
+/* SERIAL_LINK.H - Framed, non-blocking serial transport for ESP32S3
+ *
+ * link_begin() to start the background TX drain task
+ * link_send(type, payload, len) to queue one message (never blocks)
+ * link_printf(...) to queue a text message
+ * link_receive(&msg) to poll for a complete message from the host
+ * link_bulk_start() / link_bulk_pump() to stream a large buffer in chunks
+ *
+ * Wire format, both directions (little-endian):
+ *   0xA5 0x5A | type u8 | seq u16 | len u16 | payload[len] | crc u16
+ * crc is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over type..payload.
+ * seq counts every message the sender tried to send, so a gap on the
+ * receiving side means messages were dropped (TX ring full), and a bad
+ * crc means a corrupted or false frame start. link_parse_byte() keeps no
+ * copy of the bytes it consumed, so it drops the whole frame and hunts for
+ * the next sync after it (a real frame inside those bytes is lost too);
+ * viewer.py, which buffers its input, skips one byte and rescans.
+ *
+ * link_send() copies the frame into a TX ring and returns; a FreeRTOS task
+ * moves ring bytes to Serial only as fast as Serial.availableForWrite()
+ * allows, so a slow or absent host costs dropped messages, not a stalled
+ * loop. Single producer: call link_send()/link_printf() from one task.
+ *
+ * Lives next to eyes.h; copy both into the sketch folder that uses them.
+ * Every function and global is inline, as in eyes.h, so any number of
+ * .cpp files may include it and they share one TX ring and parser.
+ */
+
+#ifndef SERIAL_LINK_H
+#define SERIAL_LINK_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// CONFIGURATION
+#define LINK_SYNC0 0xA5
+#define LINK_SYNC1 0x5A
+#define LINK_HEADER_BYTES 7        // Sync, type, seq, len
+#define LINK_OVERHEAD (LINK_HEADER_BYTES + 2)
+#define LINK_TX_SIZE 8192          // TX ring bytes
+#define LINK_MAX_RX_PAYLOAD 1040   // Largest message link_receive() accepts
+#define LINK_BULK_CHUNK 1024       // Bulk data bytes per message
+#define LINK_BULK_RESERVE 512      // Ring space bulk chunks leave for other messages
+#define LINK_TASK_CORE 0
+#define LINK_TASK_PRIORITY 1
+#define LINK_TASK_STACK 2048       // Bytes
+
+// MESSAGE TYPES - 0x01-0x0F are the link's own; applications use the rest
+#define LINK_MSG_TEXT       0x01   // UTF-8 text, no terminator
+#define LINK_MSG_BULK_BEGIN 0x02   // id u32, total u32, then an application header
+#define LINK_MSG_BULK_DATA  0x03   // id u32, offset u32, then data
+
+typedef struct {
+    uint8_t type;
+    uint16_t seq;
+    uint16_t len;
+    uint8_t payload[LINK_MAX_RX_PAYLOAD];
+} LinkMessage;
+
+typedef struct {
+    uint32_t sent;         // Messages queued
+    uint32_t dropped;      // Messages that did not fit in the ring
+    uint32_t rx_ok;        // Messages received with a good crc
+    uint32_t rx_bad_crc;   // Frame starts that failed the crc
+    uint32_t rx_lost;      // Gaps in the received sequence numbers
+} LinkStats;
+
+// CRC-16/CCITT-FALSE, nibble table
+inline uint16_t link_crc16(uint16_t crc, const uint8_t* data, size_t len) {
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+// TX RING - single producer (link_send), single consumer (drain task).
+// head is only written by the producer, tail only by the consumer.
+inline uint8_t link_tx_ring[LINK_TX_SIZE];
+inline volatile uint32_t link_tx_head = 0;  // Total bytes written
+inline volatile uint32_t link_tx_tail = 0;  // Total bytes drained
+inline uint16_t link_tx_seq = 0;
+inline LinkStats link_stats = {0};
+
+inline size_t link_tx_free() {
+    return LINK_TX_SIZE - (link_tx_head - link_tx_tail);
+}
+
+inline size_t link_tx_pending() {
+    return link_tx_head - link_tx_tail;
+}
+
+inline void link_ring_put(uint32_t* head, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        link_tx_ring[(*head + i) % LINK_TX_SIZE] = data[i];
+    }
+    *head += len;
+}
+
+// Queues one message built from two payload pieces (either may be empty).
+// False if the ring is full: the message is dropped, its seq still used.
+inline bool link_send2(uint8_t type, const void* a, size_t a_len, const void* b, size_t b_len) {
+    uint16_t seq = link_tx_seq++;
+    size_t len = a_len + b_len;
+    if (len > 0xFFFF || link_tx_free() < len + LINK_OVERHEAD) {
+        link_stats.dropped++;
+        return false;
+    }
+
+    uint8_t header[LINK_HEADER_BYTES] = {
+        LINK_SYNC0, LINK_SYNC1, type,
+        (uint8_t)(seq & 0xFF), (uint8_t)(seq >> 8),
+        (uint8_t)(len & 0xFF), (uint8_t)(len >> 8),
+    };
+    uint16_t crc = link_crc16(0xFFFF, header + 2, LINK_HEADER_BYTES - 2);
+    crc = link_crc16(crc, (const uint8_t*)a, a_len);
+    crc = link_crc16(crc, (const uint8_t*)b, b_len);
+    uint8_t trailer[2] = {(uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8)};
+
+    uint32_t head = link_tx_head;
+    link_ring_put(&head, header, sizeof(header));
+    link_ring_put(&head, (const uint8_t*)a, a_len);
+    link_ring_put(&head, (const uint8_t*)b, b_len);
+    link_ring_put(&head, trailer, sizeof(trailer));
+    __sync_synchronize();  // Bytes visible before the drain task sees the new head
+    link_tx_head = head;
+
+    link_stats.sent++;
+    return true;
+}
+
+inline bool link_send(uint8_t type, const void* payload, size_t len) {
+    return link_send2(type, payload, len, NULL, 0);
+}
+
+inline bool link_printf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+inline bool link_printf(const char* fmt, ...) {
+    char text[192];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    if (n < 0) return false;
+    return link_send(LINK_MSG_TEXT, text, min(n, (int)sizeof(text) - 1));
+}
+
+// Consumer side: copies up to max queued bytes out of the ring
+inline size_t link_tx_take(uint8_t* out, size_t max) {
+    uint32_t tail = link_tx_tail;
+    size_t n = min((size_t)(link_tx_head - tail), max);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = link_tx_ring[(tail + i) % LINK_TX_SIZE];
+    }
+    __sync_synchronize();  // Reads done before the producer may reuse the space
+    link_tx_tail = tail + n;
+    return n;
+}
+
+// DRAIN TASK - writes only what Serial can take without blocking
+inline void link_drain_task(void* arg) {
+    uint8_t chunk[256];
+    while (true) {
+        int room = Serial.availableForWrite();
+        size_t n = 0;
+        if (room > 0) n = link_tx_take(chunk, min((size_t)room, sizeof(chunk)));
+        if (n > 0) {
+            Serial.write(chunk, n);
+        } else {
+            vTaskDelay(1);
+        }
+    }
+}
+
+inline bool link_begin() {
+    return xTaskCreatePinnedToCore(link_drain_task, "link_tx", LINK_TASK_STACK, NULL,
+                                   LINK_TASK_PRIORITY, NULL, LINK_TASK_CORE) == pdPASS;
+}
+
+// RX PARSER - one byte at a time; true when msg holds a complete message.
+// On a crc failure (or a len over LINK_MAX_RX_PAYLOAD) the frame is
+// dropped and the parser hunts for sync from the next byte on.
+typedef struct {
+    uint8_t state;        // 0-1 sync, 2-6 header, 7 payload, 8-9 crc
+    uint16_t got;         // Payload bytes so far
+    uint16_t crc;         // Received crc
+    bool have_seq;
+    uint16_t next_seq;
+} LinkParser;
+
+inline LinkParser link_rx_parser = {0};
+
+inline bool link_parse_byte(LinkParser* p, uint8_t byte, LinkMessage* msg, LinkStats* stats) {
+    switch (p->state) {
+        case 0:
+            if (byte == LINK_SYNC0) p->state = 1;
+            return false;
+        case 1:
+            p->state = (byte == LINK_SYNC1) ? 2 : (byte == LINK_SYNC0 ? 1 : 0);
+            return false;
+        case 2: msg->type = byte; p->state = 3; return false;
+        case 3: msg->seq = byte; p->state = 4; return false;
+        case 4: msg->seq |= (uint16_t)byte << 8; p->state = 5; return false;
+        case 5: msg->len = byte; p->state = 6; return false;
+        case 6:
+            msg->len |= (uint16_t)byte << 8;
+            p->got = 0;
+            if (msg->len > LINK_MAX_RX_PAYLOAD) {
+                stats->rx_bad_crc++;  // Cannot be one of ours
+                p->state = 0;
+            } else {
+                p->state = msg->len ? 7 : 8;
+            }
+            return false;
+        case 7:
+            msg->payload[p->got++] = byte;
+            if (p->got == msg->len) p->state = 8;
+            return false;
+        case 8: p->crc = byte; p->state = 9; return false;
+        case 9: {
+            p->crc |= (uint16_t)byte << 8;
+            p->state = 0;
+
+            uint8_t header[5] = {msg->type, (uint8_t)(msg->seq & 0xFF), (uint8_t)(msg->seq >> 8),
+                                 (uint8_t)(msg->len & 0xFF), (uint8_t)(msg->len >> 8)};
+            uint16_t crc = link_crc16(0xFFFF, header, sizeof(header));
+            crc = link_crc16(crc, msg->payload, msg->len);
+            if (crc != p->crc) {
+                stats->rx_bad_crc++;
+                return false;
+            }
+
+            if (p->have_seq && msg->seq != p->next_seq) {
+                stats->rx_lost += (uint16_t)(msg->seq - p->next_seq);
+            }
+            p->have_seq = true;
+            p->next_seq = msg->seq + 1;
+            stats->rx_ok++;
+            return true;
+        }
+    }
+    p->state = 0;
+    return false;
+}
+
+// Reads whatever Serial has; true once a whole message is in msg
+inline bool link_receive(LinkMessage* msg) {
+    while (Serial.available() > 0) {
+        if (link_parse_byte(&link_rx_parser, (uint8_t)Serial.read(), msg, &link_stats)) return true;
+    }
+    return false;
+}
+
+// BULK TRANSFER - streams a caller-owned buffer as BULK_DATA chunks, a few
+// per call, leaving LINK_BULK_RESERVE bytes of ring for other messages.
+// The buffer must stay untouched until link_bulk_busy() is false.
+typedef struct {
+    const uint8_t* data;
+    uint32_t total;
+    uint32_t offset;
+    uint32_t id;
+    bool busy;
+} LinkBulk;
+
+inline LinkBulk link_bulk = {NULL, 0, 0, 0, false};
+
+inline bool link_bulk_busy() {
+    return link_bulk.busy;
+}
+
+// Announces the transfer with BULK_BEGIN (id, total, then header bytes).
+// False if a transfer is still running or the announcement was dropped.
+inline bool link_bulk_start(uint32_t id, const uint8_t* data, uint32_t total, const void* header, size_t header_len) {
+    if (link_bulk.busy) return false;
+    uint32_t prefix[2] = {id, total};
+    if (!link_send2(LINK_MSG_BULK_BEGIN, prefix, sizeof(prefix), header, header_len)) return false;
+    link_bulk = {data, total, 0, id, total > 0};
+    return true;
+}
+
+// Queues as many chunks as fit; call every loop
+inline void link_bulk_pump() {
+    while (link_bulk.busy) {
+        uint32_t n = min((uint32_t)LINK_BULK_CHUNK, link_bulk.total - link_bulk.offset);
+        if (link_tx_free() < n + 8 + LINK_OVERHEAD + LINK_BULK_RESERVE) return;
+
+        uint32_t prefix[2] = {link_bulk.id, link_bulk.offset};
+        link_send2(LINK_MSG_BULK_DATA, prefix, sizeof(prefix), link_bulk.data + link_bulk.offset, n);
+        link_bulk.offset += n;
+        if (link_bulk.offset >= link_bulk.total) link_bulk.busy = false;
+    }
+}
+
+#endif // SERIAL_LINK_H
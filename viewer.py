@@ -4,23 +4,200 @@ Camera viewer for ESP32. Shows what the robot sees.
 Usage:
   1. Upload laptop.ino to ESP32
   2. python viewer.py
-  3. Press SPACE to snap, A for auto, Q to quit
+  3. Press SPACE to snap, A for auto, F for frame format, R to record, Q to quit
+
+Everything is framed as in serial_link.h (sync, type, seq, len, crc16).
+AUTO streams blob records for every processed frame plus an occasional
+full frame sent in chunks, either raw, compressed
+(frame_codec.h, lossless) or as the closed class masks only. Blob boxes are drawn over the last full frame,
+and the plot below tracks each blob's offset from center. Frames the
+ESP32 had to drop show up as gaps in seq and are counted, never parsed.
+
+R records every full RGB frame that arrives, with the robot's detections
+for it, to a .eyrec file that host/eyes_replay runs back through the
+pipeline (format in host/eyes_recording.h).
+
+The frame size comes from the blob record and full frame headers, so any
+EYES_FRAMESIZE build works: the image is scaled to fit the window.
 
 Install: pip install pyserial numpy pillow
 """
 
 import serial
 import struct
+import binascii
+import time
 import numpy as np
 import tkinter as tk
+from collections import deque
 from PIL import Image, ImageTk, ImageDraw
 
 # Config - change COM port if needed
 PORT = "COM10"
 BAUD = 115200
-WIDTH = 160
-HEIGHT = 120
-SCALE = 4
+VIEW_WIDTH = 640                          # Image area in the window; frames scale to fit
+VIEW_HEIGHT = 480
+
+# Link framing, see serial_link.h
+SYNC = b'\xa5\x5a'
+LINK_HEADER = struct.Struct('<2sBHH')     # sync, type, seq, len
+LINK_MAX_PAYLOAD = 1040                   # LINK_MAX_RX_PAYLOAD
+LINK_MSG_TEXT = 0x01
+LINK_MSG_BULK_BEGIN = 0x02
+LINK_MSG_BULK_DATA = 0x03
+BULK_BEGIN = struct.Struct('<II')         # id, total
+BULK_DATA = struct.Struct('<II')          # id, offset
+
+# Message types, see laptop.ino
+MSG_BLOBS = 0x10
+CMD_SNAP = 0x20
+CMD_AUTO = 0x21
+CMD_STOP = 0x22
+CMD_FORMAT = 0x23
+FULL_FRAME_MS = 10000                     # Full frame period requested in AUTO
+
+# Full frame header, see send_full_frame() in laptop.ino
+FRAME_HEADER = struct.Struct('<IHHBI')    # frame, w, h, format, ref_frame
+FRAME_RAW, FRAME_RGB565, FRAME_MASKS = 0, 1, 2
+FRAME_FORMATS = ("raw", "rgb565", "masks")
+FRAME_NO_REF = 0xFFFFFFFF
+
+# Recording (.eyrec), see host/eyes_recording.h
+RECORD_HEADER = struct.Struct('<4sHHHHBBBBIIII32x')  # magic, version, header_bytes, w, h, format,
+                                                     # classes, max_detections, stages, frames,
+                                                     # record_bytes, result_offset, pixel_offset
+RECORD_VERSION = 2                        # EYES_RECORD_VERSION
+RECORD_FRAME = struct.Struct('<IIB3x')    # frame, timestamp_us, has_result
+RECORD_DETECTION = struct.Struct('<hhIhhhh')  # offset_x, centroid_y, area, x_min, x_max, y_min, y_max
+MAX_DETECTIONS = 2                        # EYES_MAX_DETECTIONS
+
+# Blob record, see send_blob_record() in laptop.ino
+BLOB_HEADER = struct.Struct('<IIHH4HB')   # frame, timestamp_us, w, h, stage_us[4], blob_count
+BLOB_ENTRY = struct.Struct('<BhhhhhhI')   # target, cx, cy, x_min, y_min, x_max, y_max, area
+STAGES = ("capture", "coarse", "detect", "report")
+TARGETS = (("Yellow", 'yellow'), ("Pink", 'magenta'))  # EYES_TARGETS order
+PLOT_HEIGHT = 120
+PLOT_HISTORY = 300  # Blob records kept for the plot
+
+class Recorder:
+    """Appends full frames and their blob records to a .eyrec file."""
+
+    def __init__(self, path, w, h):
+        align = lambda n: (n + 7) // 8 * 8
+        self.w, self.h = w, h
+        self.result_size = (len(TARGETS) * (1 + MAX_DETECTIONS * RECORD_DETECTION.size)
+                            + 4 + 4 + 2 * len(STAGES))
+        self.pixel_offset = align(RECORD_FRAME.size + self.result_size)
+        self.record_bytes = align(self.pixel_offset + w * h * 2)
+        self.frames = 0
+        self.file = open(path, 'wb')
+        self.file.write(self.header())
+
+    def header(self):
+        return RECORD_HEADER.pack(b'EYRC', RECORD_VERSION, RECORD_HEADER.size, self.w, self.h, 0, len(TARGETS),
+                                  MAX_DETECTIONS, len(STAGES), self.frames, self.record_bytes,
+                                  RECORD_FRAME.size, self.pixel_offset)
+
+    def add(self, frame, pixel_bytes, rec):
+        """rec is the blob record of the same frame, or None."""
+        record = bytearray(self.record_bytes)
+        RECORD_FRAME.pack_into(record, 0, frame, rec['timestamp_us'] if rec else 0, rec is not None)
+        if rec is not None:
+            result = bytearray()
+            per_target = [[b for b in rec['blobs'] if b[0] == t][:MAX_DETECTIONS] for t in range(len(TARGETS))]
+            result += bytes(len(blobs) for blobs in per_target)
+            for blobs in per_target:
+                for t, cx, cy, x0, y0, x1, y1, area in blobs:
+                    result += RECORD_DETECTION.pack(cx - self.w // 2, cy, area, x0, x1, y0, y1)
+                result += bytes(RECORD_DETECTION.size * (MAX_DETECTIONS - len(blobs)))
+            result += struct.pack('<Ihh', 0, 0, self.w - 1)   # process_time_ms unknown, full frame
+            result += struct.pack(f'<{len(STAGES)}H', *rec['stage_us'])
+            record[RECORD_FRAME.size:RECORD_FRAME.size + len(result)] = result
+        record[self.pixel_offset:self.pixel_offset + len(pixel_bytes)] = pixel_bytes
+        self.file.write(record)
+        self.frames += 1
+
+    def close(self):
+        self.file.seek(0)
+        self.file.write(self.header())
+        self.file.close()
+
+
+def decode_rgb565(data, ref, count):
+    """frame_codec.h RGB565 stream to count pixels (camera byte order), or None."""
+    out = [0] * count
+    table = [0] * 64
+    left = 0
+    n = i = 0
+    try:
+        while i < count:
+            tag = data[n]
+            n += 1
+            if tag == 0xFF:
+                left = (data[n] << 8) | data[n + 1]
+                n += 2
+                run = 1
+            elif tag & 0xE0 == 0xC0:
+                b = data[n]
+                n += 1
+                dr = ((tag >> 1) & 0x0F) - 8
+                dg = (((tag & 1) << 4) | (b >> 4)) - 16
+                db = (b & 0x0F) - 8
+                left = ((((left >> 11) + dr) & 0x1F) << 11 |
+                        ((((left >> 5) & 0x3F) + dg) & 0x3F) << 5 |
+                        (((left & 0x1F) + db) & 0x1F))
+                run = 1
+            elif tag & 0xC0 == 0x80:
+                left = table[tag & 0x3F]
+                run = 1
+            elif tag & 0xE0 == 0xE0:
+                return None
+            elif tag & 0xC0 == 0x40:
+                run = (tag & 0x3F) + 1
+                if ref is None or i + run > count:
+                    return None
+                out[i:i + run] = ref[i:i + run]
+                i += run
+                left = out[i - 1]
+                table[((left >> 11) * 3 + ((left >> 5) & 0x3F) * 5 + (left & 0x1F) * 7) & 63] = left
+                continue
+            else:
+                run = (tag & 0x3F) + 1
+            if i + run > count:
+                return None
+            out[i:i + run] = [left] * run
+            i += run
+            table[((left >> 11) * 3 + ((left >> 5) & 0x3F) * 5 + (left & 0x1F) * 7) & 63] = left
+    except IndexError:
+        return None
+    return out if n == len(data) else None
+
+
+def decode_bits(data, count):
+    """frame_codec.h bit planes (no reference) to count uint32 words, or None."""
+    bits = np.zeros(count * 32, dtype=np.uint8)
+    pos = bit = n = 0
+    while n < len(data):
+        run = shift = 0
+        while True:
+            if n >= len(data):
+                return None
+            b = data[n]
+            n += 1
+            run |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                break
+        if pos + run > len(bits):
+            return None
+        if bit:
+            bits[pos:pos + run] = 1
+        pos += run
+        bit ^= 1
+    if pos != len(bits):
+        return None
+    return np.packbits(bits, bitorder='little').view('<u4')
+
 
 class Viewer:
     def __init__(self):
@@ -33,7 +210,7 @@ class Viewer:
         main_frame.pack()
 
         # Canvas for camera image
-        self.canvas = tk.Canvas(main_frame, width=WIDTH*SCALE, height=HEIGHT*SCALE, bg='gray20')
+        self.canvas = tk.Canvas(main_frame, width=VIEW_WIDTH, height=VIEW_HEIGHT, bg='gray20')
         self.canvas.pack(side=tk.LEFT)
 
         # Stats panel on the right
@@ -42,6 +219,11 @@ class Viewer:
                               width=20, height=15, padx=10, pady=10)
         self.stats.pack(side=tk.LEFT, fill=tk.Y)
 
+        # Offset history plot under the image
+        self.plot = tk.Canvas(self.root, width=VIEW_WIDTH, height=PLOT_HEIGHT, bg='gray10',
+                              highlightthickness=0)
+        self.plot.pack(anchor='w')
+
         # Controls label at bottom
         self.label = tk.Label(self.root, text="Connecting...", fg='gray', bg='black', font=('Consolas', 9))
         self.label.pack()
@@ -59,26 +241,72 @@ class Viewer:
 
         self.auto = False
         self.buffer = b''
+        self.tx_seq = 0
+        self.rx_seq = None              # Next expected seq from the ESP32
+        self.dropped = 0                # Messages lost to seq gaps
+        self.bad_crc = 0                # Frame starts that failed the crc
+        self.bulk = None                # Full frame being assembled
+        self.ref = None                 # (frame, pixels) of the last RGB frame, for deltas
+        self.format = FRAME_RGB565
+        self.recorder = None
+        self.record_path = None         # Recording requested; the recorder opens on the first frame
+        self.recent_blobs = {}          # frame -> blob record, for recording
+        self.last_blobs = None
+        self.frame_dirty = False
         self.frame_count = 0
+        self.frame_img = None           # Last full frame, rotated, unscaled
+        self.blob_times = deque(maxlen=60)
+        self.history = deque(maxlen=PLOT_HISTORY)  # (frame, [(target, offset)])
 
         self.root.bind('<space>', lambda e: self.snap())
         self.root.bind('a', self.toggle_auto)
+        self.root.bind('f', self.next_format)
+        self.root.bind('r', self.toggle_record)
         self.root.bind('q', lambda e: self.root.quit())
 
-        self.label.config(text="SPACE=snap  A=auto  Q=quit")
+        self.label.config(text="SPACE=snap  A=auto  F=format  R=record  Q=quit")
         self.update()
         self.root.mainloop()
+        if self.recorder:
+            self.recorder.close()
         if self.ser:
             self.ser.close()
 
+    def send(self, msg_type, payload=b''):
+        """Frames one command like link_send() in serial_link.h."""
+        body = struct.pack('<BHH', msg_type, self.tx_seq, len(payload)) + payload
+        crc = binascii.crc_hqx(body, 0xFFFF)
+        self.ser.write(SYNC + body + struct.pack('<H', crc))
+        self.tx_seq = (self.tx_seq + 1) & 0xFFFF
+
     def snap(self):
-        self.ser.write(b"SNAP\n")
+        self.send(CMD_SNAP)
 
     def toggle_auto(self, e):
         self.auto = not self.auto
-        self.ser.write(b"AUTO\n" if self.auto else b"STOP\n")
+        if self.auto:
+            self.send(CMD_AUTO, struct.pack('<I', FULL_FRAME_MS))
+        else:
+            self.send(CMD_STOP)
         self.label.config(text=f"Auto: {'ON' if self.auto else 'OFF'}  |  SPACE=snap  Q=quit")
 
+    def next_format(self, e):
+        self.format = (self.format + 1) % len(FRAME_FORMATS)
+        self.send(CMD_FORMAT, bytes([self.format]))
+        self.label.config(text=f"Format: {FRAME_FORMATS[self.format]}  |  SPACE=snap  A=auto  Q=quit")
+
+    def toggle_record(self, e):
+        if self.record_path:
+            frames = self.recorder.frames if self.recorder else 0
+            if self.recorder:
+                self.recorder.close()
+            self.label.config(text=f"Recorded {frames} frames  |  SPACE=snap  A=auto  Q=quit")
+            self.recorder = None
+            self.record_path = None
+        else:
+            self.record_path = time.strftime("run_%Y%m%d_%H%M%S.eyrec")
+            self.label.config(text=f"Recording to {self.record_path}  |  R=stop")
+
     def update(self):
         if not self.ser:
             return
@@ -88,117 +316,241 @@ class Viewer:
         if waiting:
             self.buffer += self.ser.read(waiting)
 
-        # Look for VIZ header
-        idx = self.buffer.find(b'VIZ')
-        if idx >= 0:
-            data_after_viz = len(self.buffer) - idx - 3
-            if data_after_viz >= 60 + WIDTH * HEIGHT * 2:
-                start = idx + 3
-                meta = self.buffer[start:start+60]
-                img_bytes = self.buffer[start+60:start+60+WIDTH*HEIGHT*2]
-                self.buffer = self.buffer[start+60+WIDTH*HEIGHT*2:]
-
-                self.frame_count += 1
-
-                # Parse metadata
-                try:
-                    m = struct.unpack('<HH BhhhH BBhhhH BhhhH II 20x', meta)
-                    yellow_found = m[2]
-                    yellow_offset = m[3]
-                    yellow_x = m[4]
-                    yellow_area = m[6]
-                    pink_count = m[7]
-                    pink0_offset = m[9]
-                    pink0_x = m[10]
-                    pink0_area = m[12]
-                    pink1_offset = m[14]
-                    pink1_x = m[15]
-                    pink1_area = m[17]
-                    process_ms = m[19]
-                except:
-                    self.root.after(30, self.update)
-                    return
-
-                # Convert RGB565 to RGB
-                raw = np.frombuffer(img_bytes, dtype=np.uint8)
-                swapped = np.empty_like(raw)
-                swapped[0::2] = raw[1::2]
-                swapped[1::2] = raw[0::2]
-                pixels = np.frombuffer(swapped.tobytes(), dtype=np.uint16).reshape((HEIGHT, WIDTH))
-
-                r = (((pixels >> 11) & 0x1F) << 3).astype(np.uint8)
-                g = (((pixels >> 5) & 0x3F) << 2).astype(np.uint8)
-                b = ((pixels & 0x1F) << 3).astype(np.uint8)
-
-                img = Image.fromarray(np.stack([r, g, b], axis=-1))
-                img = img.transpose(Image.ROTATE_180)
-                img = img.resize((WIDTH*SCALE, HEIGHT*SCALE), Image.NEAREST)
-
-                draw = ImageDraw.Draw(img)
-
-                # Flip offsets and positions for 180 rotation
-                yellow_offset = -yellow_offset
-                yellow_x = WIDTH - yellow_x
-                pink0_offset = -pink0_offset
-                pink0_x = WIDTH - pink0_x
-                pink1_offset = -pink1_offset
-                pink1_x = WIDTH - pink1_x
-
-                # Center line (green)
-                cx = WIDTH*SCALE // 2
-                draw.line([(cx, 0), (cx, HEIGHT*SCALE)], fill='green', width=2)
-
-                # Yellow cross at top
-                if yellow_found:
-                    x = yellow_x * SCALE
-                    y = 30  # near top
-                    size = 15
-                    draw.line([(x-size, y), (x+size, y)], fill='yellow', width=3)
-                    draw.line([(x, y-size), (x, y+size)], fill='yellow', width=3)
-
-                # Pink crosses at top
-                if pink_count >= 1:
-                    x = pink0_x * SCALE
-                    y = 30
-                    size = 15
-                    draw.line([(x-size, y), (x+size, y)], fill='magenta', width=3)
-                    draw.line([(x, y-size), (x, y+size)], fill='magenta', width=3)
-                if pink_count >= 2:
-                    x = pink1_x * SCALE
-                    y = 30
-                    size = 15
-                    draw.line([(x-size, y), (x+size, y)], fill='magenta', width=3)
-                    draw.line([(x, y-size), (x, y+size)], fill='magenta', width=3)
-
-                self.photo = ImageTk.PhotoImage(img)
-                self.canvas.delete("all")
-                self.canvas.create_image(0, 0, anchor='nw', image=self.photo)
-
-                # Update stats
-                stats_text = f"Frame: {self.frame_count}\n"
-                stats_text += f"Process: {process_ms}ms\n"
-                stats_text += f"\n--- YELLOW ---\n"
-                if yellow_found:
-                    direction = "CENTER" if yellow_offset == 0 else ("RIGHT" if yellow_offset > 0 else "LEFT")
-                    stats_text += f"Found: YES\n"
-                    stats_text += f"Offset: {yellow_offset:+d}px\n"
-                    stats_text += f"Dir: {direction}\n"
-                    stats_text += f"Area: {yellow_area}px\n"
-                else:
-                    stats_text += f"Found: NO\n"
-
-                stats_text += f"\n--- PINK ---\n"
-                stats_text += f"Count: {pink_count}\n"
-                if pink_count >= 1:
-                    stats_text += f"[0] {pink0_offset:+d}px\n"
-                    stats_text += f"    Area: {pink0_area}px\n"
-                if pink_count >= 2:
-                    stats_text += f"[1] {pink1_offset:+d}px\n"
-                    stats_text += f"    Area: {pink1_area}px\n"
-
-                self.stats.config(text=stats_text)
+        latest_blobs = None
+        while True:
+            msg = self.next_message()
+            if msg is None:
+                break
+            msg_type, payload = msg
+            if msg_type == LINK_MSG_TEXT:
+                print(payload.decode('utf-8', 'replace'))
+            elif msg_type == MSG_BLOBS:
+                rec = self.parse_blobs(payload)
+                if rec is not None:
+                    latest_blobs = rec
+                    self.recent_blobs[rec['frame']] = rec
+                    if len(self.recent_blobs) > PLOT_HISTORY:
+                        self.recent_blobs.pop(next(iter(self.recent_blobs)))
+                    self.add_history(rec)
+            elif msg_type == LINK_MSG_BULK_BEGIN:
+                self.begin_full_frame(payload)
+            elif msg_type == LINK_MSG_BULK_DATA:
+                self.add_full_frame_chunk(payload)
+
+        if latest_blobs is not None:
+            self.last_blobs = latest_blobs
+        if (latest_blobs is not None or self.frame_dirty) and self.last_blobs is not None:
+            self.show_blobs(self.last_blobs)
+            self.draw_plot()
+            self.frame_dirty = False
 
         self.root.after(30, self.update)
 
+    def next_message(self):
+        """Pops the next framed message off the buffer as (type, payload), or None.
+
+        A frame start whose crc fails (sync bytes inside a payload, or line
+        noise) costs one byte: skip it and rescan. Bytes outside frames are
+        boot text printed before link_begin(), passed through to the console.
+        """
+        while True:
+            idx = self.buffer.find(SYNC)
+            if idx < 0:
+                keep = 1 if self.buffer.endswith(SYNC[:1]) else 0
+                self.print_raw(self.buffer[:len(self.buffer) - keep])
+                self.buffer = self.buffer[len(self.buffer) - keep:]
+                return None
+            self.print_raw(self.buffer[:idx])
+            self.buffer = self.buffer[idx:]
+
+            if len(self.buffer) < LINK_HEADER.size:
+                return None
+            _, msg_type, seq, length = LINK_HEADER.unpack_from(self.buffer)
+            end = LINK_HEADER.size + length + 2
+            if length > LINK_MAX_PAYLOAD:
+                self.buffer = self.buffer[1:]
+                continue
+            if len(self.buffer) < end:
+                return None
+            crc, = struct.unpack_from('<H', self.buffer, end - 2)
+            if binascii.crc_hqx(self.buffer[2:end - 2], 0xFFFF) != crc:
+                self.bad_crc += 1
+                self.buffer = self.buffer[1:]
+                continue
+
+            payload = self.buffer[LINK_HEADER.size:end - 2]
+            self.buffer = self.buffer[end:]
+            if self.rx_seq is not None and seq != self.rx_seq:
+                self.dropped += (seq - self.rx_seq) & 0xFFFF
+            self.rx_seq = (seq + 1) & 0xFFFF
+            return msg_type, payload
+
+    def print_raw(self, data):
+        if data:
+            print(data.decode('utf-8', 'replace'), end='')
+
+    def parse_blobs(self, payload):
+        if len(payload) < BLOB_HEADER.size:
+            return None
+        frame, timestamp_us, w, h, *rest = BLOB_HEADER.unpack_from(payload)
+        stage_us, count = rest[:4], rest[4]
+        if len(payload) != BLOB_HEADER.size + count * BLOB_ENTRY.size:
+            return None
+        blobs = [BLOB_ENTRY.unpack_from(payload, BLOB_HEADER.size + i * BLOB_ENTRY.size)
+                 for i in range(count)]
+        return {'frame': frame, 'timestamp_us': timestamp_us, 'width': w, 'height': h,
+                'stage_us': stage_us, 'blobs': blobs}
+
+    def begin_full_frame(self, payload):
+        if len(payload) < BULK_BEGIN.size + FRAME_HEADER.size:
+            return
+        bulk_id, total = BULK_BEGIN.unpack_from(payload)
+        frame, w, h, fmt, ref = FRAME_HEADER.unpack_from(payload, BULK_BEGIN.size)
+        self.bulk = {'id': bulk_id, 'total': total, 'frame': frame, 'width': w, 'height': h,
+                     'format': fmt, 'ref': ref, 'data': bytearray()}
+
+    def add_full_frame_chunk(self, payload):
+        bulk = self.bulk
+        if bulk is None or len(payload) < BULK_DATA.size:
+            return
+        bulk_id, offset = BULK_DATA.unpack_from(payload)
+        # A missing chunk (or a lost BEGIN) would shear the image: drop the frame
+        if bulk_id != bulk['id'] or offset != len(bulk['data']):
+            self.bulk = None
+            return
+        bulk['data'] += payload[BULK_DATA.size:]
+        if len(bulk['data']) >= bulk['total']:
+            self.bulk = None
+            self.decode_full_frame(bulk)
+
+    def decode_full_frame(self, bulk):
+        w, h, fmt, data = bulk['width'], bulk['height'], bulk['format'], bytes(bulk['data'])
+        if fmt == FRAME_MASKS:
+            words = decode_bits(data, h * len(TARGETS) * ((w + 31) // 32))
+            if words is not None:
+                self.show_masks(words, w, h)
+            return
+
+        if fmt == FRAME_RAW and len(data) == w * h * 2:
+            pixels = np.frombuffer(data, dtype='>u2').tolist()
+        elif fmt == FRAME_RGB565:
+            ref = None
+            if bulk['ref'] != FRAME_NO_REF:
+                # Delta against a frame we never got: wait for the next key frame
+                if self.ref is None or self.ref[0] != bulk['ref']:
+                    return
+                ref = self.ref[1]
+            pixels = decode_rgb565(data, ref, w * h)
+            if pixels is None:
+                return
+        else:
+            return
+        self.ref = (bulk['frame'], pixels)
+        if self.record_path and self.recorder is None:
+            self.recorder = Recorder(self.record_path, w, h)  # Sized by the first frame
+        if self.recorder and (w, h) == (self.recorder.w, self.recorder.h):
+            self.recorder.add(bulk['frame'], np.array(pixels, dtype='>u2').tobytes(),
+                              self.recent_blobs.get(bulk['frame']))
+        self.show_full_frame(np.array(pixels, dtype=np.uint16), w, h)
+
+    def show_masks(self, words, w, h):
+        """Closed class masks, [y][class][word], each class in its target color."""
+        self.frame_count += 1
+        planes = np.unpackbits(words.view(np.uint8), bitorder='little')
+        planes = planes.reshape((h, len(TARGETS), -1))[:, :, :w]
+        img = Image.new('RGB', (w, h), (0, 0, 0))
+        for t, (_, color) in enumerate(TARGETS):
+            layer = Image.fromarray(planes[:, t, :] * 255)
+            img.paste(Image.new('RGB', (w, h), color), (0, 0), layer)
+        self.frame_img = img.transpose(Image.ROTATE_180)
+        self.frame_dirty = True
+
+    def show_full_frame(self, pixels, w, h):
+        self.frame_count += 1
+
+        # Convert RGB565 to RGB
+        pixels = pixels.reshape((h, w))
+
+        r = (((pixels >> 11) & 0x1F) << 3).astype(np.uint8)
+        g = (((pixels >> 5) & 0x3F) << 2).astype(np.uint8)
+        b = ((pixels & 0x1F) << 3).astype(np.uint8)
+
+        img = Image.fromarray(np.stack([r, g, b], axis=-1))
+        self.frame_img = img.transpose(Image.ROTATE_180)
+        self.frame_dirty = True
+
+    def add_history(self, rec):
+        half_width = rec['width'] / 2
+        # Offsets flipped like the image (rotated 180), as a share of half the width
+        offsets = [(b[0], -(b[1] - half_width) / half_width) for b in rec['blobs']]
+        self.history.append((rec['frame'], offsets))
+        self.blob_times.append(rec['timestamp_us'])
+
+    def show_blobs(self, rec):
+        w, h = rec['width'], rec['height']
+        if self.frame_img is not None and self.frame_img.size == (w, h):
+            img = self.frame_img.copy()
+        else:
+            img = Image.new('RGB', (w, h), (40, 40, 40))
+        scale = max(1, min(VIEW_WIDTH // w, VIEW_HEIGHT // h))
+        img = img.resize((w * scale, h * scale), Image.NEAREST)
+        draw = ImageDraw.Draw(img)
+
+        cx = w * scale // 2
+        draw.line([(cx, 0), (cx, h * scale)], fill='green', width=2)
+
+        # Boxes and centroids, flipped for the 180 rotation
+        for target, bx, by, x0, y0, x1, y1, area in rec['blobs']:
+            color = TARGETS[target][1] if target < len(TARGETS) else 'cyan'
+            fx0, fx1 = w - 1 - x1, w - 1 - x0
+            fy0, fy1 = h - 1 - y1, h - 1 - y0
+            draw.rectangle([fx0 * scale, fy0 * scale, (fx1 + 1) * scale - 1, (fy1 + 1) * scale - 1],
+                           outline=color, width=2)
+            px, py = (w - 1 - bx) * scale, (h - 1 - by) * scale
+            draw.line([(px - 8, py), (px + 8, py)], fill=color, width=2)
+            draw.line([(px, py - 8), (px, py + 8)], fill=color, width=2)
+
+        self.photo = ImageTk.PhotoImage(img)
+        self.canvas.delete("all")
+        self.canvas.create_image(0, 0, anchor='nw', image=self.photo)
+
+        # Stream rate from sensor timestamps (wraps every ~71 minutes)
+        fps = 0.0
+        if len(self.blob_times) >= 2:
+            span = (self.blob_times[-1] - self.blob_times[0]) & 0xFFFFFFFF
+            if span:
+                fps = (len(self.blob_times) - 1) * 1e6 / span
+
+        stats_text = f"Frame: {rec['frame']}\n"
+        stats_text += f"Stream: {fps:.1f} fps\n"
+        stats_text += f"Dropped: {self.dropped}  CRC: {self.bad_crc}\n"
+        for name, us in zip(STAGES, rec['stage_us']):
+            stats_text += f"{name:>8}: {us}us\n"
+        for t, (name, _) in enumerate(TARGETS):
+            blobs = [b for b in rec['blobs'] if b[0] == t]
+            stats_text += f"\n--- {name.upper()} ---\n"
+            stats_text += f"Count: {len(blobs)}\n"
+            for i, b in enumerate(blobs):
+                stats_text += f"[{i}] {-(b[1] - w // 2):+d}px  {b[7]}px\n"
+        self.stats.config(text=stats_text)
+
+    def draw_plot(self):
+        """Offset from center per target over the last PLOT_HISTORY blob records."""
+        self.plot.delete("all")
+        pw = VIEW_WIDTH
+        mid = PLOT_HEIGHT // 2
+        self.plot.create_line(0, mid, pw, mid, fill='green')
+        if len(self.history) < 2:
+            return
+        step = pw / (PLOT_HISTORY - 1)
+        for t, (_, color) in enumerate(TARGETS):
+            for i, (_, offsets) in enumerate(self.history):
+                for target, off in offsets:
+                    if target != t:
+                        continue
+                    x = i * step
+                    y = mid - off * (mid - 4)
+                    self.plot.create_rectangle(x - 1, y - 1, x + 1, y + 1, outline=color, fill=color)
+
 if __name__ == "__main__":
     Viewer()